@@ -0,0 +1,60 @@
+#pragma once
+#ifndef AUDIO_BLOCK_H
+#define AUDIO_BLOCK_H /**< & */
+
+#include <stddef.h>
+
+namespace bkshepherd {
+
+/** Largest block size the pedals support, sizes the scratch buffers used by the effects */
+constexpr size_t kMaxAudioBlockSize = 256;
+
+/** Block kernels shared by the effects.
+ *
+ *  These are simple branch-free loops over restrict pointers so the compiler can
+ *  vectorize them (SSE / AVX in the host build) or pipeline them on the Cortex-M7's
+ *  FPU.  Input and output buffers must not overlap.
+ */
+
+/** out[i] = in[i] */
+inline void CopyBlock(float* __restrict out, const float* __restrict in, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = in[i];
+    }
+}
+
+/** out[i] = value */
+inline void FillBlock(float* __restrict out, float value, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = value;
+    }
+}
+
+/** out[i] = in[i] * gain[i] */
+inline void MultiplyBlock(float* __restrict out,
+                          const float* __restrict in,
+                          const float* __restrict gain,
+                          size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = in[i] * gain[i];
+    }
+}
+
+/** gain[i] = dry[i] + wet[i] * gain[i], with dry = 1 - wet.
+ *  Turns an effect gain curve into a dry / wet crossfaded gain curve.
+ */
+inline void CrossfadeGainBlock(float* __restrict gain, const float* __restrict wet, size_t size)
+{
+    for(size_t i = 0; i < size; i++)
+    {
+        gain[i] = (1.0f - wet[i]) + wet[i] * gain[i];
+    }
+}
+} // namespace bkshepherd
+#endif
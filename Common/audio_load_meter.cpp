@@ -0,0 +1,39 @@
+#include "audio_load_meter.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+void AudioLoadMeter::Init(float callbackRate)
+{
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    tickFrequency_ = 1000000000.0f;
+#else
+    // Enable the DWT cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    tickFrequency_ = (float)System::GetSysClkFreq();
+#endif
+
+    budgetTicks_ = (uint32_t)(tickFrequency_ / callbackRate);
+    if(budgetTicks_ == 0)
+        budgetTicks_ = 1;
+
+    Reset();
+}
+
+void AudioLoadMeter::Reset()
+{
+    minTicks_       = UINT32_MAX;
+    maxTicks_       = 0;
+    totalTicks_     = 0;
+    blockCount_     = 0;
+    deadlineMisses_ = 0;
+    recentTicks_    = 0.0f;
+
+    for(size_t i = 0; i < kNumHistogramBins; i++)
+    {
+        histogram_[i] = 0;
+    }
+}
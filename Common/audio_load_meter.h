@@ -0,0 +1,115 @@
+#pragma once
+#ifndef AUDIO_LOAD_METER_H
+#define AUDIO_LOAD_METER_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "daisy_seed.h"
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+#include <chrono>
+#endif
+
+namespace bkshepherd {
+
+/**
+   @brief Measures how long each audio callback takes compared to its deadline.
+
+   Call OnBlockStart() first thing in the AudioCallback and OnBlockEnd() last.  On the
+   Daisy Seed the time is read from the DWT cycle counter, in the host build from a
+   monotonic clock in nanoseconds.  Statistics are written from the audio callback and
+   read from the main loop, they are only meant for display.
+*/
+class AudioLoadMeter
+{
+  public:
+    /** Histogram bins are 10% of the block budget wide, the last bin holds every block over 100% */
+    static constexpr size_t kNumHistogramBins = 11;
+
+    AudioLoadMeter() {}
+    ~AudioLoadMeter() {}
+
+    /** Initialize the meter and start the cycle counter.
+    \param callbackRate Rate in Hz the audio callback is called at, see AudioCallbackRate()
+    */
+    void Init(float callbackRate);
+
+    /** Call at the start of the audio callback */
+    inline void OnBlockStart() { blockStartTicks_ = ReadTicks(); }
+
+    /** Call at the end of the audio callback */
+    inline void OnBlockEnd()
+    {
+        const uint32_t ticks = ReadTicks() - blockStartTicks_;
+
+        if(ticks < minTicks_)
+            minTicks_ = ticks;
+        if(ticks > maxTicks_)
+            maxTicks_ = ticks;
+        totalTicks_ += ticks;
+        blockCount_++;
+        recentTicks_ += ((float)ticks - recentTicks_) * (1.0f / 64.0f);
+
+        if(ticks > budgetTicks_)
+            deadlineMisses_++;
+
+        size_t bin = (size_t)((uint64_t)ticks * (kNumHistogramBins - 1) / budgetTicks_);
+        histogram_[bin < kNumHistogramBins ? bin : kNumHistogramBins - 1]++;
+    }
+
+    /** Clears all the statistics */
+    void Reset();
+
+    /** Returns the number of ticks available per block */
+    uint32_t BudgetTicks() const { return budgetTicks_; }
+
+    /** Returns the tick frequency in Hz (cpu clock on the Daisy Seed, 1 GHz on the host) */
+    float TickFrequency() const { return tickFrequency_; }
+
+    uint32_t MinTicks() const { return blockCount_ > 0 ? minTicks_ : 0; }
+    uint32_t MaxTicks() const { return maxTicks_; }
+    float    AvgTicks() const { return blockCount_ > 0 ? (float)totalTicks_ / blockCount_ : 0.0f; }
+
+    /** Returns the average over roughly the last 64 blocks, follows changes in the load */
+    float RecentTicks() const { return recentTicks_; }
+
+    /** Loads are the fraction of the block budget used, 1.0 means the deadline was just met */
+    float MinLoad() const { return (float)MinTicks() / budgetTicks_; }
+    float AvgLoad() const { return AvgTicks() / budgetTicks_; }
+    float MaxLoad() const { return (float)MaxTicks() / budgetTicks_; }
+
+    uint32_t BlockCount() const { return blockCount_; }
+    uint32_t DeadlineMisses() const { return deadlineMisses_; }
+
+    /** Returns the number of blocks that fell into a histogram bin */
+    uint32_t HistogramBin(size_t bin) const
+    {
+        return bin < kNumHistogramBins ? histogram_[bin] : 0;
+    }
+
+    /** Returns the current tick count, for timing parts of the callback */
+    static inline uint32_t ReadTicks()
+    {
+#ifdef GUITAR_PEDAL_HOST_RENDER
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+#else
+        return DWT->CYCCNT;
+#endif
+    }
+
+  private:
+    float    tickFrequency_   = 1.0f;
+    uint32_t budgetTicks_     = 1;
+    uint32_t blockStartTicks_ = 0;
+    uint32_t minTicks_        = UINT32_MAX;
+    uint32_t maxTicks_        = 0;
+    uint64_t totalTicks_      = 0;
+    uint32_t blockCount_      = 0;
+    uint32_t deadlineMisses_  = 0;
+    float    recentTicks_     = 0.0f;
+    uint32_t histogram_[kNumHistogramBins];
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,65 @@
+#include "block_delay.h"
+
+using namespace bkshepherd;
+
+void BlockDelay::Init(float sampleRate, float* const* buffers, size_t numChannels, size_t length)
+{
+    sampleRate_  = sampleRate;
+    numChannels_ = numChannels < kMaxChannels ? numChannels : kMaxChannels;
+    mask_        = length - 1;
+    write_       = 0;
+    for(size_t ch = 0; ch < numChannels_; ch++)
+    {
+        buffers_[ch] = buffers[ch];
+        FillBlock(buffers_[ch], 0.0f, length);
+    }
+
+    feedback_ = 0.0f;
+    mix_      = 0.5f;
+    delay_.Init(1.0f);
+    SetTime(0.3f);
+}
+
+void BlockDelay::SetTime(float seconds, size_t rampSamples)
+{
+    // At least one sample, and room for the sample after the read position
+    float samples = seconds * sampleRate_;
+    samples       = samples < 1.0f ? 1.0f : samples;
+    samples       = samples > (float)(mask_ - 1) ? (float)(mask_ - 1) : samples;
+    delay_.SetTarget(samples, rampSamples);
+}
+
+void BlockDelay::SetFeedback(float feedback)
+{
+    feedback_ = feedback < 0.0f ? 0.0f : (feedback > 0.95f ? 0.95f : feedback);
+}
+
+void BlockDelay::ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size)
+{
+    float delay[kMaxAudioBlockSize];
+    delay_.Process(delay, size);
+
+    numChannels = numChannels < numChannels_ ? numChannels : numChannels_;
+    for(size_t ch = 0; ch < numChannels; ch++)
+    {
+        float* __restrict       line   = buffers_[ch];
+        const float* __restrict input  = in[ch];
+        float* __restrict       output = out[ch];
+        size_t                  write  = write_;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            // x[n - delay] lies between the samples floor(delay) and floor(delay) + 1 back
+            const size_t whole = (size_t)delay[i];
+            const float  frac  = delay[i] - (float)whole;
+            const float  newer = line[(write - whole) & mask_];
+            const float  older = line[(write - whole - 1) & mask_];
+            const float  wet   = newer + (older - newer) * frac;
+
+            line[write & mask_] = input[i] + wet * feedback_;
+            output[i]           = input[i] + wet * mix_;
+            write++;
+        }
+    }
+    write_ = (write_ + size) & mask_;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#ifndef BLOCK_DELAY_H
+#define BLOCK_DELAY_H /**< & */
+
+#include <stddef.h>
+#include "audio_block.h"
+#include "effect_block.h"
+#include "linear_ramp.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Feedback delay with a buffer per channel handed in by the program.
+
+   The delay lines are plain float arrays the program allocates statically, on the
+   Daisy Seed in SDRAM, so long delays don't use up internal RAM.  Delay time changes
+   glide, reading between samples, which bends the pitch like a tape delay instead of
+   clicking.  The dry signal passes at unity and the repeats are mixed on top.
+*/
+class BlockDelay : public EffectBlock
+{
+  public:
+    static constexpr size_t kMaxChannels = 2;
+
+    BlockDelay() {}
+    ~BlockDelay() {}
+
+    /** Initialize the delay
+    \param sampleRate Audio sample rate in Hz
+    \param buffers One buffer per channel, length floats each
+    \param numChannels Number of buffers, up to kMaxChannels
+    \param length Buffer length in samples, a power of two
+    */
+    void Init(float sampleRate, float* const* buffers, size_t numChannels, size_t length);
+
+    /** Sets the delay time, limited to the buffer length
+    \param seconds Delay time
+    \param rampSamples Number of samples to glide to the new time over
+    */
+    void SetTime(float seconds, size_t rampSamples = 0);
+
+    /** Sets how much of the output is fed back, 0.0 to 0.95 */
+    void SetFeedback(float feedback);
+
+    /** Sets the level of the repeats, 0.0 to 1.0 */
+    void SetMix(float mix) { mix_ = mix < 0.0f ? 0.0f : (mix > 1.0f ? 1.0f : mix); }
+
+    void ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size) override;
+
+    const char* Name() const override { return "Delay"; }
+
+  private:
+    float*     buffers_[kMaxChannels] = {};
+    size_t     numChannels_           = 0;
+    size_t     mask_                  = 0;
+    size_t     write_                 = 0;
+    float      sampleRate_            = 48000.0f;
+    float      feedback_              = 0.0f;
+    float      mix_                   = 0.5f;
+    LinearRamp delay_;
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,57 @@
+#include "block_overdrive.h"
+
+using namespace bkshepherd;
+
+// Rational approximation of tanh, hard limited at +-3, as used by daisysp::SoftClip
+static inline float SoftClip(float x)
+{
+    if(x < -3.0f)
+        return -1.0f;
+    if(x > 3.0f)
+        return 1.0f;
+    return x * (27.0f + x * x) / (27.0f + 9.0f * x * x);
+}
+
+void BlockOverdrive::Init()
+{
+    drive_ = -1.0f;
+    SetDrive(0.5f);
+}
+
+void BlockOverdrive::SetDrive(float drive, size_t rampSamples)
+{
+    drive = drive < 0.0f ? 0.0f : (drive > 1.0f ? 1.0f : drive);
+    if(drive == drive_)
+        return;
+    drive_ = drive;
+
+    // daisysp::Overdrive::SetDrive
+    const float d  = 2.0f * drive;
+    const float d2 = d * d;
+    const float preA = d * 0.5f;
+    const float preB = d2 * d2 * d * 24.0f;
+    const float pre  = preA + (preB - preA) * d2;
+
+    const float squashed = d * (2.0f - d);
+    const float post     = 1.0f / SoftClip(0.33f + squashed * (pre - 0.33f));
+
+    preGain_.SetTarget(pre, rampSamples);
+    postGain_.SetTarget(post, rampSamples);
+}
+
+void BlockOverdrive::ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size)
+{
+    float pre[kMaxAudioBlockSize], post[kMaxAudioBlockSize];
+    preGain_.Process(pre, size);
+    postGain_.Process(post, size);
+
+    for(size_t ch = 0; ch < numChannels; ch++)
+    {
+        const float* __restrict input  = in[ch];
+        float* __restrict       output = out[ch];
+        for(size_t i = 0; i < size; i++)
+        {
+            output[i] = SoftClip(input[i] * pre[i]) * post[i];
+        }
+    }
+}
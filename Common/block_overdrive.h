@@ -0,0 +1,43 @@
+#pragma once
+#ifndef BLOCK_OVERDRIVE_H
+#define BLOCK_OVERDRIVE_H /**< & */
+
+#include <stddef.h>
+#include "audio_block.h"
+#include "effect_block.h"
+#include "linear_ramp.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Soft clipping overdrive that works on whole blocks.
+
+   Same drive curve and rational soft clipper as daisysp::Overdrive, with the gains
+   worked out once when the drive changes and ramped across blocks, so the per-sample
+   loop is a multiply, the clipper and another multiply.
+*/
+class BlockOverdrive : public EffectBlock
+{
+  public:
+    BlockOverdrive() {}
+    ~BlockOverdrive() {}
+
+    void Init();
+
+    /** Sets the amount of drive
+    \param drive 0.0 to 1.0
+    \param rampSamples Number of samples to glide to the new gain over, avoids zipper noise
+    */
+    void SetDrive(float drive, size_t rampSamples = 0);
+
+    void ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size) override;
+
+    const char* Name() const override { return "Overdrive"; }
+
+  private:
+    LinearRamp preGain_;
+    LinearRamp postGain_;
+    float      drive_ = -1.0f;
+};
+} // namespace bkshepherd
+#endif
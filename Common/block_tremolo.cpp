@@ -0,0 +1,141 @@
+#include "block_tremolo.h"
+
+using namespace daisysp;
+using namespace bkshepherd;
+
+// Phase errors are pulled in over this many seconds when following a clock.
+static const float kSyncTime = 0.1f;
+
+// The LFO tables are read every this many samples, about 3kHz at 48kHz
+static const size_t kLfoDecimation = 16;
+
+// Harmonic mode crossover frequency until SetCrossover() is called
+static const float kDefaultCrossover = 800.0f;
+
+void BlockTremolo::Init(float sample_rate)
+{
+    lfo_.Init(sample_rate, kLfoDecimation);
+    crossover_.Init(sample_rate, kDefaultCrossover);
+    SetDepth(1.0f);
+    SetFreq(1.0f);
+}
+
+void BlockTremolo::SetDepth(float depth, size_t rampSamples)
+{
+    halfDepth_.SetTarget(fclamp(depth, 0.0f, 1.0f) * 0.5f, rampSamples);
+}
+
+void BlockTremolo::SyncPhase(float freq, float phase)
+{
+    // Shortest way round to the target phase, -0.5 to 0.5 cycles
+    float error = phase - lfo_.Phase();
+    error -= floorf(error + 0.5f);
+
+    lfo_.SetFreq(fmaxf(freq + error / kSyncTime, 0.0f));
+}
+
+void BlockTremolo::ProcessGain(float* gain, size_t size, float* antiGain)
+{
+    float lfo[kMaxAudioBlockSize];
+    lfo_.ProcessBlock(lfo, size);
+    ProcessDepth(size);
+    ApplyDepth(lfo, gain, antiGain, size);
+
+    // Keep Level() right when the caller switches back to Process()
+    if(size > 0)
+        lastGain_ = gain[size - 1];
+}
+
+void BlockTremolo::ProcessDepth(size_t size)
+{
+    depthRamped_ = halfDepth_.IsRamping();
+    if(depthRamped_)
+        halfDepth_.Process(depthCurve_, size);
+}
+
+void BlockTremolo::ApplyDepth(const float* lfo, float* gain, float* antiGain, size_t size) const
+{
+    if(!depthRamped_)
+    {
+        const float halfDepth = halfDepth_.Value();
+        const float dc_os     = 1.0f - halfDepth;
+        for(size_t i = 0; i < size; i++)
+        {
+            gain[i] = dc_os + lfo[i] * halfDepth;
+        }
+
+        if(antiGain)
+        {
+            const float centre = 2.0f * dc_os;
+            for(size_t i = 0; i < size; i++)
+            {
+                antiGain[i] = centre - gain[i];
+            }
+        }
+        return;
+    }
+
+    const float* halfDepth = depthCurve_;
+    for(size_t i = 0; i < size; i++)
+    {
+        gain[i] = (1.0f - halfDepth[i]) + lfo[i] * halfDepth[i];
+    }
+
+    if(antiGain)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            antiGain[i] = 2.0f * (1.0f - halfDepth[i]) - gain[i];
+        }
+    }
+}
+
+float BlockTremolo::Process(const float* const* in, float** out, size_t numChannels, size_t size)
+{
+    if(size == 0)
+        return 1.0f - halfDepth_.Value();
+
+    const bool harmonic = mode_ == MODE_HARMONIC;
+    const bool offset   = numChannels > 1 && stereoPhase_ != 0.0f;
+
+    float lfo[kMaxAudioBlockSize];
+    float rightLfo[kMaxAudioBlockSize];
+    lfo_.ProcessBlock(lfo, size, offset ? rightLfo : nullptr, stereoPhase_);
+    ProcessDepth(size);
+    ApplyDepth(lfo, gain_, harmonic ? antiGain_ : nullptr, size);
+    if(offset)
+        ApplyDepth(rightLfo, rightGain_, harmonic ? rightAntiGain_ : nullptr, size);
+
+    for(size_t ch = 0; ch < numChannels; ch++)
+    {
+        const bool   right = offset && ch > 0;
+        const float* gain  = right ? rightGain_ : gain_;
+        if(harmonic)
+        {
+            ProcessHarmonic(ch, in[ch], out[ch], gain, right ? rightAntiGain_ : antiGain_, size);
+        }
+        else
+        {
+            MultiplyBlock(out[ch], in[ch], gain, size);
+        }
+    }
+
+    lastGain_ = gain_[size - 1];
+    return lastGain_;
+}
+
+void BlockTremolo::ProcessHarmonic(size_t       channel,
+                                   const float* in,
+                                   float*       out,
+                                   const float* gain,
+                                   const float* antiGain,
+                                   size_t       size)
+{
+    float low[kMaxAudioBlockSize];
+    float high[kMaxAudioBlockSize];
+    crossover_.Process(channel, in, low, high, size);
+    for(size_t i = 0; i < size; i++)
+    {
+        out[i] = low[i] * gain[i] + high[i] * antiGain[i];
+    }
+}
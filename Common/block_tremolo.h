@@ -0,0 +1,144 @@
+#pragma once
+#ifndef BLOCK_TREMOLO_H
+#define BLOCK_TREMOLO_H /**< & */
+
+#include <stddef.h>
+#include "daisysp.h"
+#include "audio_block.h"
+#include "crossover.h"
+#include "effect_block.h"
+#include "linear_ramp.h"
+#include "wavetable_lfo.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Tremolo that works on whole blocks instead of one sample at a time.
+
+   The LFO gain curve for the block is generated once into a contiguous buffer and then
+   applied to every channel with MultiplyBlock, so a stereo pedal runs one oscillator
+   instead of two and the per-sample work left in the callback is a branch-free multiply.
+   The gain curve matches daisysp::Tremolo: 1 - depth / 2 + lfo * depth / 2, with depth
+   changes optionally ramped across blocks.  The LFO is a WavetableLfo read every 16
+   samples, with band-limited tables so the square and saw waves don't click.
+
+   In harmonic mode each channel is split by a Linkwitz-Riley crossover and the two bands
+   are modulated in anti-phase: the low band follows the gain curve and the high band
+   gets the same curve mirrored around its centre, so the level stays steady while the
+   tone swings between bass and treble.
+
+   With more than one channel the right channel can run the LFO at a phase offset from
+   the left, 90 degrees for a wide stereo image or 180 degrees for ping-pong.  There is
+   still only one LFO: the offset curve is read from the same tables at the same control
+   points.
+*/
+class BlockTremolo : public EffectBlock
+{
+  public:
+    enum Mode
+    {
+        MODE_SIMPLE,
+        MODE_HARMONIC,
+    };
+
+    BlockTremolo() {}
+    ~BlockTremolo() {}
+
+    /** Initialize the tremolo
+    \param sample_rate Audio sample rate in Hz
+    */
+    void Init(float sample_rate);
+
+    /** Sets the LFO frequency in Hz */
+    void SetFreq(float freq) { lfo_.SetFreq(freq); }
+
+    /** Sets the tremolo mode, one of the Mode values */
+    void SetMode(int mode) { mode_ = mode; }
+
+    /** Sets the harmonic mode crossover frequency in Hz, filter coefficients are only
+     ** recalculated when it changes */
+    void SetCrossover(float freq) { crossover_.SetFreq(freq); }
+
+    /** Sets the LFO waveform, one of the daisysp::Oscillator waveforms */
+    void SetWaveform(int waveform) { lfo_.SetWaveform(waveform); }
+
+    /** Sets the LFO phase of the right channel relative to the left
+    \param offset 0.0 for mono, 0.25 (90 degrees) for wide, 0.5 (180 degrees) for ping-pong
+    */
+    void SetStereoPhase(float offset) { stereoPhase_ = offset - floorf(offset); }
+
+    /** Sets the depth of the effect
+    \param depth 0.0 to 1.0
+    \param rampSamples Number of samples to glide to the new depth over, avoids zipper noise
+    */
+    void SetDepth(float depth, size_t rampSamples = 0);
+
+    /** Pulls the LFO towards an external phase, for following a clock.  Call before
+     ** processing every block that should follow it.  Phase errors are corrected by
+     ** briefly running the LFO faster or slower, so the gain curve never jumps.
+    \param freq LFO frequency in Hz
+    \param phase Phase the LFO should be at right now, 0.0 to 1.0
+    */
+    void SyncPhase(float freq, float phase);
+
+    /** Starts the LFO cycle over from a phase straight away, for starting on a beat
+    \param phase 0.0 to 1.0
+    */
+    void ResetPhase(float phase) { lfo_.Reset(phase); }
+
+    /** Returns the LFO phase at the start of the next block, 0.0 to 1.0 */
+    float Phase() const { return lfo_.Phase(); }
+
+    /** Generates the gain curve for the next block, Level() returns its last value like
+     ** after Process().
+    \param gain Buffer receiving size gain values
+    \param size Number of samples in the block
+    \param antiGain Optional buffer receiving the gain curve in anti-phase, mirrored
+                    around the centre of the curve
+    */
+    void ProcessGain(float* gain, size_t size, float* antiGain = nullptr);
+
+    /** Generates the gain curve and applies it to every channel.
+    \param in Input channels
+    \param out Output channels
+    \param numChannels Number of channels
+    \param size Number of samples per channel, up to kMaxAudioBlockSize
+    \return The gain of the last sample, handy for driving an LED
+    */
+    float Process(const float* const* in, float** out, size_t numChannels, size_t size);
+
+    void ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size) override
+    {
+        Process(in, out, numChannels, size);
+    }
+
+    /** Returns the gain of the last sample processed */
+    float Level() const override { return lastGain_; }
+
+    const char* Name() const override { return "Tremolo"; }
+
+  private:
+    void ProcessDepth(size_t size);
+    void ApplyDepth(const float* lfo, float* gain, float* antiGain, size_t size) const;
+    void ProcessHarmonic(size_t       channel,
+                         const float* in,
+                         float*       out,
+                         const float* gain,
+                         const float* antiGain,
+                         size_t       size);
+
+    WavetableLfo           lfo_;
+    LinkwitzRileyCrossover crossover_;
+    int                    mode_        = MODE_SIMPLE;
+    float                  stereoPhase_ = 0.0f;
+    float                  lastGain_    = 1.0f;
+    LinearRamp             halfDepth_;
+    bool                   depthRamped_ = false; /**< depthCurve_ holds the last block's depth */
+    float                  depthCurve_[kMaxAudioBlockSize];
+    float                  gain_[kMaxAudioBlockSize];
+    float                  antiGain_[kMaxAudioBlockSize];
+    float                  rightGain_[kMaxAudioBlockSize];
+    float                  rightAntiGain_[kMaxAudioBlockSize];
+};
+} // namespace bkshepherd
+#endif
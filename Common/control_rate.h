@@ -0,0 +1,76 @@
+#pragma once
+#ifndef CONTROL_RATE_H
+#define CONTROL_RATE_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace bkshepherd {
+
+/**
+   @brief Decides which audio blocks read the controls, so knob handling runs at a fixed
+   control rate no matter what SetAudioBlockSize is set to.
+
+   Call Tick() once per audio callback.  Blocks longer than the control interval update
+   the controls every block.
+*/
+class ControlRateScheduler
+{
+  public:
+    ControlRateScheduler() {}
+    ~ControlRateScheduler() {}
+
+    /** Initialize the scheduler
+    \param sampleRate Audio sample rate in Hz
+    \param controlRate Rate in Hz the controls should be read at
+    */
+    void Init(float sampleRate, float controlRate)
+    {
+        sampleRate_         = sampleRate;
+        intervalSamples_    = (int32_t)(sampleRate / controlRate + 0.5f);
+        intervalSamples_    = intervalSamples_ > 0 ? intervalSamples_ : 1;
+        samplesUntilUpdate_ = 0;
+        rampSamples_        = (size_t)intervalSamples_;
+    }
+
+    /** Advances by one block.
+    \param blockSize Number of samples in this block
+    \return true if the controls should be updated at the start of this block
+    */
+    bool Tick(size_t blockSize)
+    {
+        const bool due = samplesUntilUpdate_ <= 0;
+        if(due)
+        {
+            samplesUntilUpdate_ += intervalSamples_;
+            if(samplesUntilUpdate_ < (int32_t)blockSize)
+                samplesUntilUpdate_ = (int32_t)blockSize;
+
+            // The next update happens at the first block boundary after the interval.
+            rampSamples_ = ((samplesUntilUpdate_ + blockSize - 1) / blockSize) * blockSize;
+        }
+        samplesUntilUpdate_ -= (int32_t)blockSize;
+        return due;
+    }
+
+    /** Returns the number of samples until the next control update, the length to ramp
+     ** parameters over so they arrive just as the next values are read.
+     */
+    size_t RampSamples() const { return rampSamples_; }
+
+    /** Returns the rate in Hz the controls are actually updated at for a block size */
+    float UpdateRate(size_t blockSize) const
+    {
+        return sampleRate_
+               / (float)((size_t)intervalSamples_ > blockSize ? (size_t)intervalSamples_
+                                                              : blockSize);
+    }
+
+  private:
+    float   sampleRate_         = 48000.0f;
+    int32_t intervalSamples_    = 1;
+    int32_t samplesUntilUpdate_ = 0;
+    size_t  rampSamples_        = 1;
+};
+} // namespace bkshepherd
+#endif
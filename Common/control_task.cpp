@@ -0,0 +1,43 @@
+#include "control_task.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+// Timer ticks are counted at 1MHz, plenty of resolution for control rates
+static const uint32_t kTickFreq = 1000000;
+
+// The lowest interrupt priority, the audio DMA runs at 1 and always gets in first
+static const uint32_t kIrqPriority = 0x0f;
+
+void ControlTask::Init(float rate, TaskFunction task)
+{
+    task_ = task;
+    ticks_.store(0, std::memory_order_relaxed);
+
+    // TIM2 keeps System time, TIM5 is the other 32 bit timer
+    TimerHandle::Config config;
+    config.periph     = TimerHandle::Config::Peripheral::TIM_5;
+    config.dir        = TimerHandle::Config::CounterDir::UP;
+    config.enable_irq = true;
+    timer_.Init(config);
+    HAL_NVIC_SetPriority(TIM5_IRQn, kIrqPriority, 0);
+
+    // Without a prescaler the timer ticks at its clock, which depends on the CPU clock
+    const uint32_t clock = timer_.GetFreq();
+    timer_.SetPrescaler(clock > kTickFreq ? clock / kTickFreq - 1 : 0);
+
+    uint32_t period = (uint32_t)(timer_.GetFreq() / rate + 0.5f);
+    period          = period > 1 ? period : 1;
+    timer_.SetPeriod(period - 1);
+    rate_ = (float)timer_.GetFreq() / (float)period;
+
+    timer_.SetCallback(TimerCallback, this);
+}
+
+void ControlTask::TimerCallback(void* data)
+{
+    ControlTask* task = static_cast<ControlTask*>(data);
+    task->ticks_.fetch_add(1, std::memory_order_relaxed);
+    if(task->task_)
+        task->task_();
+}
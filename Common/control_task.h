@@ -0,0 +1,61 @@
+#pragma once
+#ifndef CONTROL_TASK_H
+#define CONTROL_TASK_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "daisy_seed.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Runs the control scanning from a hardware timer interrupt at a fixed rate.
+
+   Debouncing switches and encoders and filtering the knobs inside the audio callback
+   ties them to the block size, a block size of 48 debounces the switches 1000 times a
+   second and a block size of 4 does it 12000 times.  Running the scan from its own timer
+   keeps the HID timing the same whatever the audio is set to, and the audio callback is
+   left with only the DSP.
+
+   The task function runs in interrupt context, so it should only read the controls and
+   hand the results over, e.g. through a LatestValue, never touch the flash or the
+   display.  Init() gives the timer interrupt a lower priority than the audio DMA so the
+   audio can interrupt it.
+*/
+class ControlTask
+{
+  public:
+    typedef void (*TaskFunction)();
+
+    ControlTask() {}
+    ~ControlTask() {}
+
+    /** Sets up the timer, it doesn't run until Start()
+    \param rate Rate in Hz to run the task at
+    \param task Function called every time the timer elapses
+    */
+    void Init(float rate, TaskFunction task);
+
+    /** Starts calling the task function */
+    void Start() { timer_.Start(); }
+
+    /** Stops calling the task function */
+    void Stop() { timer_.Stop(); }
+
+    /** Returns the rate the task really runs at, the timer rounds to whole ticks */
+    float Rate() const { return rate_; }
+
+    /** Returns the number of times the task has run */
+    uint32_t TickCount() const { return ticks_.load(std::memory_order_relaxed); }
+
+  private:
+    static void TimerCallback(void* data);
+
+    daisy::TimerHandle    timer_;
+    TaskFunction          task_ = nullptr;
+    float                 rate_ = 1000.0f;
+    std::atomic<uint32_t> ticks_{0};
+};
+} // namespace bkshepherd
+#endif
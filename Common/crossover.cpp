@@ -0,0 +1,84 @@
+#include <math.h>
+#include "crossover.h"
+
+using namespace bkshepherd;
+
+void LinkwitzRileyCrossover::Init(float sampleRate, float freq)
+{
+    sampleRate_ = sampleRate;
+    for(size_t ch = 0; ch < kMaxChannels; ch++)
+    {
+        lowpassState_[ch][0] = {0.0f, 0.0f};
+        lowpassState_[ch][1] = {0.0f, 0.0f};
+        allpassState_[ch]    = {0.0f, 0.0f};
+    }
+
+    freq_ = 0.0f;
+    SetFreq(freq);
+}
+
+void LinkwitzRileyCrossover::SetFreq(float freq)
+{
+    const float nyquist = sampleRate_ * 0.49f;
+    freq                = freq < 10.0f ? 10.0f : (freq > nyquist ? nyquist : freq);
+    if(freq == freq_)
+        return;
+    freq_ = freq;
+
+    // Butterworth low pass and the matching allpass, Q = 1 / sqrt(2) (RBJ cookbook)
+    const float w0    = 6.2831853f * freq / sampleRate_;
+    const float cosw  = cosf(w0);
+    const float alpha = sinf(w0) * 0.70710678f;
+    const float a0    = 1.0f / (1.0f + alpha);
+
+    lowpass_.b0 = (1.0f - cosw) * 0.5f * a0;
+    lowpass_.b1 = (1.0f - cosw) * a0;
+    lowpass_.b2 = lowpass_.b0;
+    lowpass_.a1 = -2.0f * cosw * a0;
+    lowpass_.a2 = (1.0f - alpha) * a0;
+
+    allpass_.b0 = lowpass_.a2;
+    allpass_.b1 = lowpass_.a1;
+    allpass_.b2 = 1.0f;
+    allpass_.a1 = lowpass_.a1;
+    allpass_.a2 = lowpass_.a2;
+}
+
+void LinkwitzRileyCrossover::Process(size_t channel, const float* in, float* low, float* high, size_t size)
+{
+    if(channel >= kMaxChannels)
+        return;
+
+    ProcessBiquad(lowpass_, lowpassState_[channel][0], in, low, size);
+    ProcessBiquad(lowpass_, lowpassState_[channel][1], low, low, size);
+    ProcessBiquad(allpass_, allpassState_[channel], in, high, size);
+
+    for(size_t i = 0; i < size; i++)
+    {
+        high[i] -= low[i];
+    }
+}
+
+void LinkwitzRileyCrossover::ProcessBiquad(const Biquad& biquad,
+                                           State&        state,
+                                           const float*  in,
+                                           float*        out,
+                                           size_t        size)
+{
+    // Works in place, each input sample is read before its output is written
+    const float b0 = biquad.b0, b1 = biquad.b1, b2 = biquad.b2;
+    const float a1 = biquad.a1, a2 = biquad.a2;
+    float       z1 = state.z1, z2 = state.z2;
+
+    for(size_t i = 0; i < size; i++)
+    {
+        const float x = in[i];
+        const float y = b0 * x + z1;
+        z1            = b1 * x - a1 * y + z2;
+        z2            = b2 * x - a2 * y;
+        out[i]        = y;
+    }
+
+    state.z1 = z1;
+    state.z2 = z2;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef CROSSOVER_H
+#define CROSSOVER_H /**< & */
+
+#include <stddef.h>
+
+namespace bkshepherd {
+
+/**
+   @brief 4th order Linkwitz-Riley crossover that splits a signal into a low and a high band.
+
+   The low band is two cascaded 2nd order Butterworth low pass biquads.  The two bands of
+   a Linkwitz-Riley crossover add up to a 2nd order allpass, so the high band is worked
+   out as that allpass minus the low band, which takes three biquads per channel instead
+   of four and sums back to a flat response by construction.
+
+   Each biquad runs over the whole block before the next one, in transposed direct form
+   II.  Coefficients are only recalculated when SetFreq() is given a new frequency.
+*/
+class LinkwitzRileyCrossover
+{
+  public:
+    static constexpr size_t kMaxChannels = 2;
+
+    LinkwitzRileyCrossover() {}
+    ~LinkwitzRileyCrossover() {}
+
+    /** Initialize the crossover
+    \param sampleRate Audio sample rate in Hz
+    \param freq Crossover frequency in Hz
+    */
+    void Init(float sampleRate, float freq);
+
+    /** Sets the crossover frequency, does nothing if it hasn't changed */
+    void SetFreq(float freq);
+
+    float Freq() const { return freq_; }
+
+    /** Splits a block of one channel, in may be the same buffer as neither output
+    \param channel Channel index, each channel has its own filter state
+    \param in Input samples
+    \param low Receives the low band
+    \param high Receives the high band
+    \param size Number of samples
+    */
+    void Process(size_t channel, const float* in, float* low, float* high, size_t size);
+
+  private:
+    struct Biquad
+    {
+        float b0, b1, b2, a1, a2;
+    };
+
+    struct State
+    {
+        float z1, z2;
+    };
+
+    static void ProcessBiquad(const Biquad& biquad, State& state, const float* in, float* out, size_t size);
+
+    float  sampleRate_ = 48000.0f;
+    float  freq_       = 0.0f;
+    Biquad lowpass_;
+    Biquad allpass_;
+    State  lowpassState_[kMaxChannels][2];
+    State  allpassState_[kMaxChannels];
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H /**< & */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "spsc_queue.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Logging from the audio callback without formatting or I/O in the real-time path.
+
+   Log() only copies a small binary record (format string pointer, up to kMaxArgs integer
+   arguments and a sample timestamp) into a lock-free ring, which costs the same every
+   time.  The main loop calls Drain() to format and print the records.  When the ring is
+   full records are dropped and counted instead of blocking the callback.
+
+   Format strings must be string literals (or otherwise outlive the record), the pointer
+   doubles as the record's format id.
+
+   \tparam kCapacity Number of records the ring holds, must be a power of two
+*/
+template <size_t kCapacity>
+class DeferredLog
+{
+  public:
+    static constexpr size_t kMaxArgs = 4;
+
+    struct Record
+    {
+        const char* format;          /**< printf style format string */
+        uint32_t    timestamp;       /**< Sample count the record was made at */
+        int32_t     args[kMaxArgs];  /**< Integer arguments for the format string */
+    };
+
+    DeferredLog() {}
+    ~DeferredLog() {}
+
+    /** Records a message, call from the audio callback (the single producer).
+    \param timestamp Sample count to tag the message with
+    \param format printf style format string, integer conversions only
+    \param args Up to kMaxArgs integer arguments
+    \return false if the ring was full and the message was dropped
+    */
+    template <typename... Args>
+    bool Log(uint32_t timestamp, const char* format, Args... args)
+    {
+        static_assert(sizeof...(Args) <= kMaxArgs, "Too many arguments for a log record");
+
+        Record record;
+        record.format    = format;
+        record.timestamp = timestamp;
+
+        const int32_t values[kMaxArgs + 1] = {static_cast<int32_t>(args)...};
+        for(size_t i = 0; i < kMaxArgs; i++)
+        {
+            record.args[i] = i < sizeof...(Args) ? values[i] : 0;
+        }
+
+        if(!records_.Push(record))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /** Hands every queued record to a printer, call from the main loop (the single consumer).
+    \param print Callable taking a const Record&
+    \return Number of records printed
+    */
+    template <typename Printer>
+    size_t Drain(Printer print)
+    {
+        size_t printed = 0;
+        Record record;
+        while(records_.Pop(record))
+        {
+            print(record);
+            printed++;
+        }
+        return printed;
+    }
+
+    /** Returns the number of records dropped since the last call, call from the main loop */
+    uint32_t TakeDroppedCount()
+    {
+        const uint32_t dropped = dropped_.load(std::memory_order_relaxed);
+        const uint32_t count   = dropped - droppedReported_;
+        droppedReported_       = dropped;
+        return count;
+    }
+
+    /** Returns the total number of records dropped */
+    uint32_t DroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+  private:
+    SpscQueue<Record, kCapacity> records_;
+    std::atomic<uint32_t>        dropped_{0};
+    uint32_t                     droppedReported_ = 0;
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef EFFECT_BLOCK_H
+#define EFFECT_BLOCK_H /**< & */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace bkshepherd {
+
+/**
+   @brief Common interface of the block based effects, so they can be put in an EffectChain.
+
+   ProcessBlock() is called once per block (or part of a block) and loops over the
+   samples itself, so the virtual call costs once per block and never per sample.  The
+   effects keep all of their state in the object, nothing is allocated.
+
+   Whoever runs an effect can time it and hand the time to RecordCost(), so the cost of
+   a combination of effects can be estimated before it is switched on.
+*/
+class EffectBlock
+{
+  public:
+    virtual ~EffectBlock() {}
+
+    /** Processes a block, in and out must not overlap
+    \param in Input channels
+    \param out Output channels
+    \param numChannels Number of channels
+    \param size Number of samples per channel, up to kMaxAudioBlockSize
+    */
+    virtual void ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size) = 0;
+
+    /** Returns a level for the effect LED after the last block, 0.0 to 1.0 */
+    virtual float Level() const { return 1.0f; }
+
+    /** Returns the effect name, for menus and reports */
+    virtual const char* Name() const = 0;
+
+    /** Returns the recent processing cost in ticks per sample (see AudioLoadMeter), 0
+     ** until the effect has been timed.
+    */
+    virtual float CostPerSample() const { return costPerSample_; }
+
+    /** Folds a measurement into CostPerSample().  Rises straight away to a more
+     ** expensive block and decays slowly, so the estimate errs on the safe side.
+    \param ticks Ticks the last ProcessBlock() took
+    \param size Number of samples it processed
+    */
+    void RecordCost(uint32_t ticks, size_t size)
+    {
+        if(size == 0)
+            return;
+
+        const float cost = (float)ticks / (float)size;
+        costPerSample_   = cost > costPerSample_ ? cost : costPerSample_ + (cost - costPerSample_) * (1.0f / 256.0f);
+    }
+
+  protected:
+    float costPerSample_ = 0.0f;
+};
+} // namespace bkshepherd
+#endif
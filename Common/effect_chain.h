@@ -0,0 +1,172 @@
+#pragma once
+#ifndef EFFECT_CHAIN_H
+#define EFFECT_CHAIN_H /**< & */
+
+#include <stddef.h>
+#include "audio_block.h"
+#include "audio_load_meter.h"
+#include "effect_block.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Runs a block through a fixed number of effect slots in order.
+
+   Each slot points at a statically allocated effect, or is empty, and can be bypassed
+   on its own.  Between slots the audio goes through two scratch buffers inside the
+   chain, the first active slot reads the input and the last one writes the output
+   directly, so no extra copies are made and nothing is allocated.
+
+   The slots are changed from the audio callback only, for example when it picks up new
+   settings from the main loop.  An effect must only be in one slot at a time since it
+   keeps its state in the object.
+
+   Every slot is timed with AudioLoadMeter::ReadTicks() and the time recorded on its
+   effect, so CostPerSample() of the chain is the sum of the effects it would run, even
+   right after it was set up.  A chain is an EffectBlock itself, so an EffectSwitcher can
+   fade between two of them.
+
+   \tparam kMaxSlots Number of slots
+   \tparam kMaxChannels Maximum number of channels
+*/
+template <size_t kMaxSlots, size_t kMaxChannels = 2>
+class EffectChain : public EffectBlock
+{
+  public:
+    EffectChain()
+    {
+        for(size_t ch = 0; ch < kMaxChannels; ch++)
+        {
+            scratchPtrs_[0][ch] = scratch_[0][ch];
+            scratchPtrs_[1][ch] = scratch_[1][ch];
+        }
+    }
+    ~EffectChain() {}
+
+    /** Empties every slot */
+    void Init()
+    {
+        for(size_t slot = 0; slot < kMaxSlots; slot++)
+        {
+            effects_[slot] = nullptr;
+            bypass_[slot]  = false;
+        }
+    }
+
+    /** Puts an effect in a slot, nullptr empties the slot */
+    void SetSlot(size_t slot, EffectBlock* effect)
+    {
+        if(slot < kMaxSlots)
+            effects_[slot] = effect;
+    }
+
+    EffectBlock* GetSlot(size_t slot) const { return slot < kMaxSlots ? effects_[slot] : nullptr; }
+
+    /** Bypasses a slot, the effect keeps its state but isn't processed */
+    void SetBypass(size_t slot, bool bypass)
+    {
+        if(slot < kMaxSlots)
+            bypass_[slot] = bypass;
+    }
+
+    bool IsBypassed(size_t slot) const { return slot < kMaxSlots && bypass_[slot]; }
+
+    /** Returns true if the slot has an effect and isn't bypassed */
+    bool IsActive(size_t slot) const
+    {
+        return slot < kMaxSlots && effects_[slot] && !bypass_[slot];
+    }
+
+    /** Runs a block through the active slots, in and out must not overlap
+    \param in Input channels
+    \param out Output channels
+    \param numChannels Number of channels, up to kMaxChannels
+    \param size Number of samples per channel, up to kMaxAudioBlockSize
+    \return Level() of the last active effect, 1.0 if every slot is empty or bypassed
+    */
+    float Process(const float* const* in, float** out, size_t numChannels, size_t size)
+    {
+        size_t last = kMaxSlots;
+        for(size_t slot = 0; slot < kMaxSlots; slot++)
+        {
+            if(IsActive(slot))
+                last = slot;
+        }
+
+        if(last == kMaxSlots)
+        {
+            for(size_t ch = 0; ch < numChannels; ch++)
+            {
+                CopyBlock(out[ch], in[ch], size);
+            }
+            level_ = 1.0f;
+            return level_;
+        }
+
+        const float* const* source  = in;
+        size_t              scratch = 0;
+        for(size_t slot = 0; slot <= last; slot++)
+        {
+            if(!IsActive(slot))
+                continue;
+
+            float** dest = slot == last ? out : scratchPtrs_[scratch];
+
+            const uint32_t start = AudioLoadMeter::ReadTicks();
+            effects_[slot]->ProcessBlock(source, dest, numChannels, size);
+            effects_[slot]->RecordCost(AudioLoadMeter::ReadTicks() - start, size);
+            source  = dest;
+            scratch = 1 - scratch;
+        }
+        level_ = effects_[last]->Level();
+        return level_;
+    }
+
+    void ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size) override
+    {
+        Process(in, out, numChannels, size);
+    }
+
+    /** Returns the level of the last active effect after the last block */
+    float Level() const override { return level_; }
+
+    const char* Name() const override { return "Chain"; }
+
+    /** Returns the summed cost of the active slots */
+    float CostPerSample() const override
+    {
+        float cost = 0.0f;
+        for(size_t slot = 0; slot < kMaxSlots; slot++)
+        {
+            if(IsActive(slot))
+                cost += effects_[slot]->CostPerSample();
+        }
+        return cost;
+    }
+
+    /** Returns true if an effect is active in both chains, they can't run side by side then */
+    bool SharesEffectsWith(const EffectChain& other) const
+    {
+        for(size_t slot = 0; slot < kMaxSlots; slot++)
+        {
+            for(size_t otherSlot = 0; otherSlot < kMaxSlots; otherSlot++)
+            {
+                if(IsActive(slot) && other.IsActive(otherSlot)
+                   && effects_[slot] == other.effects_[otherSlot])
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+  private:
+    EffectBlock* effects_[kMaxSlots] = {};
+    bool         bypass_[kMaxSlots]  = {};
+    float        level_              = 1.0f;
+    float        scratch_[2][kMaxChannels][kMaxAudioBlockSize];
+    float*       scratchPtrs_[2][kMaxChannels];
+};
+} // namespace bkshepherd
+#endif
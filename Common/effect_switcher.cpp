@@ -0,0 +1,178 @@
+#include <math.h>
+#include "effect_switcher.h"
+
+using namespace bkshepherd;
+
+// Quarter sine, sin(pi / 2 * t) for t from 0 to 1, interpolated between the points
+static const size_t kCurveSize = 64;
+static float        curve[kCurveSize + 1];
+
+static inline float EqualPowerGain(float t)
+{
+    const float  position = t * kCurveSize;
+    const size_t index    = (size_t)position;
+    if(index >= kCurveSize)
+        return 1.0f;
+    return curve[index] + (curve[index + 1] - curve[index]) * (position - (float)index);
+}
+
+void EffectSwitcher::Init(const AudioLoadMeter* meter, EffectBlock* program)
+{
+    for(size_t i = 0; i <= kCurveSize; i++)
+    {
+        curve[i] = sinf(1.5707963f * (float)i / (float)kCurveSize);
+    }
+
+    for(size_t buffer = 0; buffer < 2; buffer++)
+    {
+        for(size_t ch = 0; ch < 2; ch++)
+        {
+            scratchPtrs_[buffer][ch] = scratch_[buffer][ch];
+        }
+    }
+
+    meter_        = meter;
+    current_      = program;
+    next_         = program;
+    fadeLength_   = 0;
+    fadePosition_ = 0;
+}
+
+EffectSwitcher::SwitchMode
+EffectSwitcher::Switch(EffectBlock* program, size_t fadeSamples, bool sharesState, size_t blockSize)
+{
+    if(IsSwitching())
+        return SWITCH_REFUSED;
+
+    // Everything the callback does now, with and without the running program
+    const float budget      = meter_ ? kMaxLoad * (float)meter_->BudgetTicks() : 0.0f;
+    const float currentCost = current_ ? current_->CostPerSample() * blockSize : 0.0f;
+    const float nextCost    = program ? program->CostPerSample() * blockSize : 0.0f;
+    float       load        = meter_ ? meter_->RecentTicks() : 0.0f;
+    load                    = load > currentCost ? load : currentCost;
+
+    SwitchMode mode;
+    if(meter_ && load - currentCost + nextCost > budget)
+        mode = SWITCH_REFUSED;
+    else if(sharesState || (meter_ && load + nextCost > budget))
+        mode = SWITCH_DIP;
+    else
+        mode = SWITCH_CROSSFADE;
+
+    if(mode == SWITCH_REFUSED || program == current_)
+        return mode;
+
+    mode_         = mode;
+    next_         = program;
+    fadeLength_   = fadeSamples < 2 ? 2 : fadeSamples;
+    fadePosition_ = 0;
+    return mode;
+}
+
+float EffectSwitcher::Process(const float* const* in, float** out, size_t numChannels, size_t size)
+{
+    if(!IsSwitching())
+        return RunProgram(current_, in, out, numChannels, size);
+
+    float gainOut[kMaxAudioBlockSize], gainIn[kMaxAudioBlockSize];
+
+    if(mode_ == SWITCH_CROSSFADE)
+    {
+        const float levelOut = RunProgram(current_, in, scratchPtrs_[0], numChannels, size);
+        const float levelIn  = RunProgram(next_, in, scratchPtrs_[1], numChannels, size);
+        FadeGains(gainOut, fadePosition_, fadeLength_, false, size);
+        FadeGains(gainIn, fadePosition_, fadeLength_, true, size);
+
+        for(size_t ch = 0; ch < numChannels; ch++)
+        {
+            const float* __restrict outgoing = scratch_[0][ch];
+            const float* __restrict incoming = scratch_[1][ch];
+            float* __restrict       output   = out[ch];
+            for(size_t i = 0; i < size; i++)
+            {
+                output[i] = outgoing[i] * gainOut[i] + incoming[i] * gainIn[i];
+            }
+        }
+
+        const bool mostlyIn = fadePosition_ * 2 >= fadeLength_;
+        fadePosition_ += size;
+        if(fadePosition_ >= fadeLength_)
+            current_ = next_;
+        return mostlyIn ? levelIn : levelOut;
+    }
+
+    // Dip: the block is split where the fade turns round and where it ends
+    const size_t half  = fadeLength_ / 2;
+    float        level = 1.0f;
+    size_t       done  = 0;
+    while(done < size)
+    {
+        const float* segmentIn[2]  = {in[0] + done, in[numChannels > 1 ? 1 : 0] + done};
+        float*       segmentOut[2] = {out[0] + done, out[numChannels > 1 ? 1 : 0] + done};
+
+        size_t count;
+        if(!IsSwitching())
+        {
+            count = size - done;
+            level = RunProgram(current_, segmentIn, segmentOut, numChannels, count);
+        }
+        else
+        {
+            const bool fadingIn = fadePosition_ >= half;
+            const size_t end    = fadingIn ? fadeLength_ : half;
+            count               = end - fadePosition_ < size - done ? end - fadePosition_ : size - done;
+
+            level = RunProgram(fadingIn ? next_ : current_, segmentIn, segmentOut, numChannels, count);
+            if(fadingIn)
+                FadeGains(gainIn, fadePosition_ - half, fadeLength_ - half, true, count);
+            else
+                FadeGains(gainIn, fadePosition_, half, false, count);
+
+            for(size_t ch = 0; ch < numChannels; ch++)
+            {
+                for(size_t i = 0; i < count; i++)
+                {
+                    segmentOut[ch][i] *= gainIn[i];
+                }
+            }
+
+            fadePosition_ += count;
+            if(fadePosition_ >= fadeLength_)
+                current_ = next_;
+        }
+        done += count;
+    }
+    return level;
+}
+
+float EffectSwitcher::RunProgram(EffectBlock* program,
+                                 const float* const* in,
+                                 float**             out,
+                                 size_t              numChannels,
+                                 size_t              size)
+{
+    if(!program)
+    {
+        for(size_t ch = 0; ch < numChannels; ch++)
+        {
+            CopyBlock(out[ch], in[ch], size);
+        }
+        return 1.0f;
+    }
+
+    const uint32_t start = AudioLoadMeter::ReadTicks();
+    program->ProcessBlock(in, out, numChannels, size);
+    program->RecordCost(AudioLoadMeter::ReadTicks() - start, size);
+    return program->Level();
+}
+
+void EffectSwitcher::FadeGains(float* gain, size_t position, size_t length, bool fadeIn, size_t size)
+{
+    const float step = 1.0f / (float)length;
+    for(size_t i = 0; i < size; i++)
+    {
+        float t = (float)(position + i + 1) * step;
+        t       = t > 1.0f ? 1.0f : t;
+        gain[i] = EqualPowerGain(fadeIn ? t : 1.0f - t);
+    }
+}
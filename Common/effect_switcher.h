@@ -0,0 +1,84 @@
+#pragma once
+#ifndef EFFECT_SWITCHER_H
+#define EFFECT_SWITCHER_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "audio_block.h"
+#include "audio_load_meter.h"
+#include "effect_block.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Switches between effect programs without a click.
+
+   Switch() starts moving from the running program to another one.  If the programs
+   don't share any effect objects and running both fits in the audio callback's budget,
+   both run side by side for the fade and their outputs are crossfaded with equal power
+   (cos / sin) curves, so the level stays constant between uncorrelated programs.
+   Otherwise the running program fades out over the first half of the fade and the new
+   one fades in over the second half, only one of them runs at a time.  A program that
+   wouldn't fit in the budget even on its own is refused.
+
+   The budget check adds the new program's CostPerSample() to the recent callback load
+   measured by an AudioLoadMeter.  Everything here runs in the audio callback.
+*/
+class EffectSwitcher
+{
+  public:
+    /** How Switch() is going to change program */
+    enum SwitchMode
+    {
+        SWITCH_REFUSED,   /**< The new program doesn't fit, the old one keeps running */
+        SWITCH_CROSSFADE, /**< Both programs run for the fade */
+        SWITCH_DIP,       /**< Fade out, then fade in, one program at a time */
+    };
+
+    /** Largest fraction of the block budget a switch may take the callback to */
+    static constexpr float kMaxLoad = 0.9f;
+
+    EffectSwitcher() {}
+    ~EffectSwitcher() {}
+
+    /** Initialize the switcher
+    \param meter Load meter of the audio callback, sets the budget
+    \param program Program to start with, nullptr passes the input through
+    */
+    void Init(const AudioLoadMeter* meter, EffectBlock* program);
+
+    /** Starts switching to another program, ignored while a switch is in progress
+    \param program Program to switch to, nullptr passes the input through
+    \param fadeSamples Length of the fade
+    \param sharesState True if the programs share effect objects and can't run side by side
+    \param blockSize Audio block size, for the budget check
+    */
+    SwitchMode Switch(EffectBlock* program, size_t fadeSamples, bool sharesState, size_t blockSize);
+
+    /** Returns true while a fade is in progress */
+    bool IsSwitching() const { return next_ != current_; }
+
+    /** Returns the program running, or fading out */
+    EffectBlock* Current() const { return current_; }
+
+    /** Processes a block with the running program, fading while switching
+    \return Level() of the program that is mostly audible
+    */
+    float Process(const float* const* in, float** out, size_t numChannels, size_t size);
+
+  private:
+    float RunProgram(EffectBlock* program, const float* const* in, float** out, size_t numChannels, size_t size);
+    void  FadeGains(float* gain, size_t position, size_t length, bool fadeIn, size_t size);
+
+    const AudioLoadMeter* meter_        = nullptr;
+    EffectBlock*          current_      = nullptr;
+    EffectBlock*          next_         = nullptr;
+    SwitchMode            mode_         = SWITCH_CROSSFADE;
+    size_t                fadeLength_   = 0;
+    size_t                fadePosition_ = 0;
+
+    float  scratch_[2][2][kMaxAudioBlockSize];
+    float* scratchPtrs_[2][2];
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,317 @@
+#pragma once
+#ifndef GUITAR_PEDAL_H
+#define GUITAR_PEDAL_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "daisy_seed.h"
+#include "knob_front_end.h"
+
+using namespace daisy;
+
+namespace bkshepherd {
+
+/** Pins of a rotary encoder with a push button, Daisy Seed pin numbers */
+struct EncoderPins
+{
+    uint8_t a;     /**< & */
+    uint8_t b;     /**< & */
+    uint8_t click; /**< & */
+};
+
+/** Display type for boards without one, it takes no code and no pins */
+struct NoDisplay
+{
+};
+
+template <typename F, size_t... I>
+inline void UnrolledFor(F& f, std::index_sequence<I...>)
+{
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+/** Calls f(std::integral_constant<size_t, I>) for I = 0 to N - 1, written out in full at
+ ** compile time instead of looping.
+ */
+template <size_t N, typename F>
+inline void Unrolled(F&& f)
+{
+    UnrolledFor(f, std::make_index_sequence<N>{});
+}
+
+/**
+   @brief Helpers and hardware definitions for a Guitar Pedal based on the Daisy Seed.
+
+   Everything that differs between enclosures comes from the Board description, a struct
+   of enums and constexpr pin tables:
+
+       enum SwitchIndex  { SWITCH_1, ..., SWITCH_LAST };
+       enum KnobIndex    { KNOB_1, ..., KNOB_LAST };
+       enum EncoderIndex { ..., ENCODER_LAST };
+       enum LedIndex     { LED_1, ..., LED_LAST };
+       kSwitchPins, kKnobPins, kEncoderPins, kLedPins   one entry per index
+       kMidiRxPin, kMidiTxPin                           -1 for the UART's default pins
+       kBypassPin, kMutePin                             relay and mute GPIOs
+       kBlockSize, kSampleRate                          audio setup after Init()
+       Display                                          NoDisplay if there is none
+       static void InitDisplay(DaisySeed&, Display&)    only for boards with a display
+
+   The control counts are known at compile time, so the loops over knobs, switches and
+   LEDs are written out in full, and a board without encoders or a display doesn't
+   build any code for them.  Adding an enclosure is a matter of writing its Board.
+*/
+template <typename Board>
+class GuitarPedal : public Board
+{
+  public:
+    using typename Board::SwitchIndex;
+    using typename Board::KnobIndex;
+    using typename Board::LedIndex;
+    using Display = typename Board::Display;
+
+    static constexpr bool kHasDisplay = !std::is_same<Display, NoDisplay>::value;
+
+    /** Constructor */
+    GuitarPedal() {}
+    /** Destructor */
+    ~GuitarPedal() {}
+
+    /** Initialize the pedal */
+    void Init(bool boost = false)
+    {
+        // Initialize the seed hardware.
+        seed.Configure();
+        seed.Init(boost);
+
+        // Initialize all the hardware accessories
+        InitSwitches();
+        InitEncoders();
+        InitLeds();
+        InitAnalogControls();
+        InitMidi();
+
+        // Set Default Audio Configurations
+        SetAudioBlockSize(Board::kBlockSize);
+        SetAudioSampleRate(Board::kSampleRate);
+
+        // Init the HW Audio Bypass
+        audioBypassTrigger.Init(Board::kBypassPin, GPIO::Mode::OUTPUT);
+        SetAudioBypass(true);
+
+        // Init the HW Audio Mute
+        audioMuteTrigger.Init(Board::kMutePin, GPIO::Mode::OUTPUT);
+        SetAudioMute(false);
+
+        if constexpr(kHasDisplay)
+        {
+            Board::InitDisplay(seed, display);
+        }
+    }
+
+    /**
+       Wait before moving on.
+       \param del Delay time in ms.
+     */
+    void DelayMs(size_t del) { seed.DelayMs(del); }
+
+    /** Starts the callback
+    \param cb Interleaved callback function
+    */
+    void StartAudio(AudioHandle::InterleavingAudioCallback cb) { seed.StartAudio(cb); }
+
+    /** Starts the callback
+    \param cb multichannel callback function
+    */
+    void StartAudio(AudioHandle::AudioCallback cb) { seed.StartAudio(cb); }
+
+    /**
+       Switch callback functions
+       \param cb New interleaved callback function.
+    */
+    void ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb) { seed.ChangeAudioCallback(cb); }
+
+    /**
+       Switch callback functions
+       \param cb New multichannel callback function.
+    */
+    void ChangeAudioCallback(AudioHandle::AudioCallback cb) { seed.ChangeAudioCallback(cb); }
+
+    /** Stops the audio if it is running. */
+    void StopAudio() { seed.StopAudio(); }
+
+    /** Updates the Audio Sample Rate, and reinitializes.
+     ** Audio must be stopped for this to work.
+     */
+    void SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate)
+    {
+        seed.SetAudioSampleRate(samplerate);
+        SetHidUpdateRates();
+    }
+
+    /** Returns the audio sample rate in Hz as a floating point number.
+     */
+    float AudioSampleRate() { return seed.AudioSampleRate(); }
+
+    /** Sets the number of samples processed per channel by the audio callback.
+       \param size Audio block size
+     */
+    void SetAudioBlockSize(size_t size)
+    {
+        seed.SetAudioBlockSize(size);
+        SetHidUpdateRates();
+    }
+
+    /** Returns the number of samples per channel in a block of audio. */
+    size_t AudioBlockSize() { return seed.AudioBlockSize(); }
+
+    /** Returns the rate in Hz that the Audio callback is called */
+    float AudioCallbackRate() { return seed.AudioCallbackRate(); }
+
+    /** Start analog to digital conversion. */
+    void StartAdc() { seed.adc.Start(); }
+
+    /** Stops Transfering data from the ADC */
+    void StopAdc() { seed.adc.Stop(); }
+
+    /** Reads every knob from the ADC into the knob front end, call once per control
+     ** scan at a fixed rate, the front end averages over the last scans.
+     */
+    void ProcessAnalogControls()
+    {
+        uint16_t readings[Board::KNOB_LAST];
+        Unrolled<Board::KNOB_LAST>([&](auto i) { readings[i] = seed.adc.Get(i); });
+        knobs.Process(readings);
+    }
+
+    /** Process Analog and Digital Controls */
+    inline void ProcessAllControls()
+    {
+        ProcessAnalogControls();
+        ProcessDigitalControls();
+    }
+
+    /** Get value per knob.
+    \param k Which knob to get
+    \return Floating point knob position.
+    */
+    float GetKnobValue(KnobIndex k)
+    {
+        size_t idx;
+        idx = k < Board::KNOB_LAST ? k : Board::KNOB_1;
+        return knobs.Value(idx);
+    }
+
+    /** Process digital controls */
+    void ProcessDigitalControls()
+    {
+        Unrolled<Board::SWITCH_LAST>([this](auto i) { switches[i].Debounce(); });
+        Unrolled<Board::ENCODER_LAST>([this](auto i) { encoders[i].Debounce(); });
+    }
+
+    /** Toggle the Hardware Audio Bypass (if applicable) */
+    void SetAudioBypass(bool enabled)
+    {
+        audioBypass = enabled;
+        audioBypassTrigger.Write(!audioBypass);
+    }
+
+    /** Toggle the Hardware Audio Mute (if applicable) */
+    void SetAudioMute(bool enabled)
+    {
+        audioMute = enabled;
+        audioMuteTrigger.Write(audioMute);
+    }
+
+    /** Turn all leds off */
+    void ClearLeds()
+    {
+        Unrolled<Board::LED_LAST>([this](auto i) { leds[i].Set(0.0f); });
+    }
+
+    /**
+       Set Led
+       \param idx Led Index
+       \param bright Brightness
+     */
+    void SetLed(LedIndex k, float bright)
+    {
+        size_t idx;
+        idx = k < Board::LED_LAST ? k : Board::LED_1;
+        leds[idx].Set(bright);
+    }
+
+    /** Updates all the LEDs based on their values */
+    void UpdateLeds()
+    {
+        Unrolled<Board::LED_LAST>([this](auto i) { leds[i].Update(); });
+    }
+
+    DaisySeed seed;    /**< & */
+    Display   display; /**< & */
+    KnobFrontEnd<Board::KNOB_LAST>              knobs;      /**< & */
+    std::array<Encoder, Board::ENCODER_LAST>    encoders;   /**< & */
+    std::array<Switch, Board::SWITCH_LAST>      switches;   /**< & */
+    std::array<Led, Board::LED_LAST>            leds;       /**< & */
+    MidiUartHandler midi;
+    GPIO audioBypassTrigger;
+    bool audioBypass;
+    GPIO audioMuteTrigger;
+    bool audioMute;
+
+  private:
+    void SetHidUpdateRates()
+    {
+        const float ledRate = AudioCallbackRate();
+        Unrolled<Board::LED_LAST>([&](auto i) { leds[i].SetSampleRate(ledRate); });
+    }
+
+    void InitSwitches()
+    {
+        Unrolled<Board::SWITCH_LAST>([this](auto i) {
+            switches[i].Init(seed.GetPin(Board::kSwitchPins[i]));
+        });
+    }
+
+    void InitEncoders()
+    {
+        // Boards without encoders don't need a pin table for them
+        if constexpr(Board::ENCODER_LAST > 0)
+        {
+            Unrolled<Board::ENCODER_LAST>([this](auto i) {
+                encoders[i].Init(seed.GetPin(Board::kEncoderPins[i].a),
+                                 seed.GetPin(Board::kEncoderPins[i].b),
+                                 seed.GetPin(Board::kEncoderPins[i].click));
+            });
+        }
+    }
+
+    void InitLeds()
+    {
+        Unrolled<Board::LED_LAST>([this](auto i) { leds[i].Init(seed.GetPin(Board::kLedPins[i]), false); });
+    }
+
+    void InitAnalogControls()
+    {
+        // Set order of ADCs based on CHANNEL NUMBER, one single pin per knob
+        AdcChannelConfig cfg[Board::KNOB_LAST];
+        Unrolled<Board::KNOB_LAST>([&](auto i) { cfg[i].InitSingle(seed.GetPin(Board::kKnobPins[i])); });
+        seed.adc.Init(cfg, Board::KNOB_LAST);
+        knobs.Init(KnobFrontEnd<Board::KNOB_LAST>::kDefaultDeadBand);
+    }
+
+    void InitMidi()
+    {
+        MidiUartHandler::Config midi_config;
+        if constexpr(Board::kMidiRxPin >= 0)
+        {
+            midi_config.transport_config.rx = seed.GetPin(Board::kMidiRxPin);
+            midi_config.transport_config.tx = seed.GetPin(Board::kMidiTxPin);
+        }
+        midi.Init(midi_config);
+    }
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,132 @@
+#pragma once
+#ifndef KNOB_FRONT_END_H
+#define KNOB_FRONT_END_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+namespace bkshepherd {
+
+/**
+   @brief Turns raw ADC readings of the knobs into steady values and change events.
+
+   Every scan takes one 16 bit reading per knob.  The last kOversample readings are
+   averaged, which takes the noise down by the square root of kOversample on top of the
+   ADC's own oversampling.  The average then has to move further than a dead band from
+   the value last reported before the knob counts as turned, the value then follows it.
+   At the ends of the travel the value goes all the way to 0.0 or 1.0.
+
+   Each change bumps the knob's version, and a version for all the knobs together, so
+   code that applies the knobs can compare one number with the version it applied last
+   and skip the work while nobody touches a knob.  The first scan reports every knob.
+*/
+template <size_t kNumKnobs, size_t kOversample = 8>
+class KnobFrontEnd
+{
+  public:
+    /** Dead band that keeps a knob quiet at the noise of the Daisy Seed's ADC */
+    static constexpr float kDefaultDeadBand = 0.002f;
+
+    KnobFrontEnd() {}
+    ~KnobFrontEnd() {}
+
+    /** Initialize the front end, the next scan fills the averages and reports every knob
+    \param deadBand Smallest change of a knob that is reported, 0.0 to 1.0
+    */
+    void Init(float deadBand)
+    {
+        deadBand_ = deadBand;
+        primed_   = false;
+        version_  = 0;
+        for(size_t knob = 0; knob < kNumKnobs; knob++)
+        {
+            value_[knob]    = 0.0f;
+            versions_[knob] = 0;
+        }
+    }
+
+    /** Sets the smallest change that is reported */
+    void SetDeadBand(float deadBand) { deadBand_ = deadBand; }
+
+    /** Takes one reading of every knob, call once per scan
+    \param readings Raw ADC readings in knob order, 0 - 65535
+    */
+    void Process(const uint16_t* readings)
+    {
+        if(!primed_)
+        {
+            Prime(readings);
+            return;
+        }
+
+        for(size_t knob = 0; knob < kNumKnobs; knob++)
+        {
+            sum_[knob] += readings[knob];
+            sum_[knob] -= history_[knob][position_];
+            history_[knob][position_] = readings[knob];
+            Report(knob, (float)sum_[knob] * kScale);
+        }
+        position_ = (position_ + 1) % kOversample;
+    }
+
+    /** Returns the last reported value of a knob, 0.0 to 1.0 */
+    float Value(size_t knob) const { return value_[knob]; }
+
+    /** Returns the number of changes of a knob so far */
+    uint32_t Version(size_t knob) const { return versions_[knob]; }
+
+    /** Returns the number of changes of all the knobs so far */
+    uint32_t Version() const { return version_; }
+
+  private:
+    static constexpr float kScale = 1.0f / (65536.0f * kOversample);
+
+    void Prime(const uint16_t* readings)
+    {
+        for(size_t knob = 0; knob < kNumKnobs; knob++)
+        {
+            for(size_t i = 0; i < kOversample; i++)
+            {
+                history_[knob][i] = readings[knob];
+            }
+            sum_[knob]   = (uint32_t)readings[knob] * kOversample;
+            value_[knob] = Snap((float)sum_[knob] * kScale);
+            versions_[knob]++;
+        }
+        position_ = 0;
+        primed_   = true;
+        version_++;
+    }
+
+    // Snaps to the ends, the dead band would otherwise keep the knob short of them
+    float Snap(float average) const
+    {
+        const float snap = 0.5f * deadBand_;
+        return average < snap ? 0.0f : (average > 1.0f - snap ? 1.0f : average);
+    }
+
+    void Report(size_t knob, float average)
+    {
+        average = Snap(average);
+        const float change = fabsf(average - value_[knob]);
+        const bool  atEnd  = (average == 0.0f || average == 1.0f) && change > 0.0f;
+        if(change <= deadBand_ && !atEnd)
+            return;
+
+        value_[knob] = average;
+        versions_[knob]++;
+        version_++;
+    }
+
+    float    deadBand_ = kDefaultDeadBand;
+    bool     primed_   = false;
+    size_t   position_ = 0;
+    uint32_t version_  = 0;
+    float    value_[kNumKnobs]                = {};
+    uint32_t versions_[kNumKnobs]             = {};
+    uint32_t sum_[kNumKnobs]                  = {};
+    uint16_t history_[kNumKnobs][kOversample] = {};
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,101 @@
+#include <math.h>
+#include "latency_probe.h"
+
+using namespace bkshepherd;
+
+// Barker code of length 13, every shifted copy correlates with it by at most 1
+static const float kCode[LatencyProbe::kCodeLength] = {1, 1, 1, 1, 1, -1, -1, 1, 1, -1, 1, -1, 1};
+
+// Smallest normalized correlation taken as the marker, the best shifted copy reaches 1/13
+static const float kDetectThreshold = 0.8f;
+
+// Windows with less than this fraction of the marker's energy are noise, whatever they
+// correlate with, so the cable may lose up to 10dB
+static const float kMinEnergy = 0.1f;
+
+void LatencyProbe::Init(float sampleRate, float intervalSeconds, float amplitude)
+{
+    sampleRate_      = sampleRate;
+    intervalSamples_ = (uint32_t)(sampleRate * intervalSeconds);
+    intervalSamples_ = intervalSamples_ > 2 * kCodeLength ? intervalSamples_ : 2 * kCodeLength;
+    amplitude_       = amplitude;
+    resetPending_.store(false, std::memory_order_relaxed);
+    Clear();
+}
+
+void LatencyProbe::Clear()
+{
+    sampleCount_ = 0;
+    listening_   = false;
+    windowPos_   = 0;
+    for(size_t i = 0; i < kCodeLength; i++)
+    {
+        window_[i] = 0.0f;
+    }
+
+    timeouts_     = 0;
+    minSamples_   = UINT32_MAX;
+    maxSamples_   = 0;
+    totalSamples_ = 0;
+    count_.store(0, std::memory_order_release);
+}
+
+void LatencyProbe::Process(const float* in, float* out, size_t size)
+{
+    if(resetPending_.exchange(false, std::memory_order_acquire))
+        Clear();
+
+    for(size_t i = 0; i < size; i++)
+    {
+        // A new marker every interval, a marker that hasn't come back by then is lost
+        if(sampleCount_ == intervalSamples_)
+        {
+            if(listening_)
+                timeouts_++;
+            sampleCount_ = 0;
+            listening_   = true;
+        }
+
+        out[i] = sampleCount_ < kCodeLength ? kCode[sampleCount_] * amplitude_ : 0.0f;
+
+        // Latency from the last marker sample going out to the last one coming in
+        if(Detect(in[i]) && listening_ && sampleCount_ >= kCodeLength - 1)
+        {
+            listening_ = false;
+            Record(sampleCount_ - (kCodeLength - 1));
+        }
+        sampleCount_++;
+    }
+}
+
+bool LatencyProbe::Detect(float sample)
+{
+    window_[windowPos_] = sample;
+    windowPos_          = windowPos_ + 1 < kCodeLength ? windowPos_ + 1 : 0;
+
+    // windowPos_ is now the oldest sample, lined up with the start of the code
+    float correlation = 0.0f, energy = 0.0f;
+    for(size_t i = 0; i < kCodeLength; i++)
+    {
+        const float x = window_[(windowPos_ + i) % kCodeLength];
+        correlation += x * kCode[i];
+        energy += x * x;
+    }
+
+    // The sign is ignored, some converters invert the signal
+    return energy > kMinEnergy * kCodeLength * amplitude_ * amplitude_
+           && fabsf(correlation) >= kDetectThreshold * sqrtf(energy * kCodeLength);
+}
+
+void LatencyProbe::Record(uint32_t latency)
+{
+    minSamples_ = latency < minSamples_ ? latency : minSamples_;
+    maxSamples_ = latency > maxSamples_ ? latency : maxSamples_;
+    totalSamples_ += latency;
+    count_.fetch_add(1, std::memory_order_release);
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    if(hostObserver_)
+        hostObserver_(latency);
+#endif
+}
@@ -0,0 +1,99 @@
+#pragma once
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace bkshepherd {
+
+/**
+   @brief Measures the round trip from the output jack back to the input jack.
+
+   With a patch cable from the output to the input, the probe plays a short marker on
+   the output at a fixed interval and listens for it on the input.  The marker is a 13
+   sample Barker code, its correlation with itself is 13 times larger than with any
+   shifted copy, so the arrival is found to the sample even through the converters'
+   filtering.  It has to come back no more than 10dB quieter than it was played.  The time from writing the marker to finding it is the
+   real latency: the block buffered on the way in, the block on the way out and the
+   converters.
+
+   Process() runs in the audio callback and replaces the output with the markers.  The
+   results are written there and read from the main loop, they are only meant for
+   display.
+*/
+class LatencyProbe
+{
+  public:
+    static constexpr size_t kCodeLength = 13;
+
+    LatencyProbe() {}
+    ~LatencyProbe() {}
+
+    /** Initialize the probe and clear the results
+    \param sampleRate Audio sample rate in Hz
+    \param intervalSeconds Time between markers, longer than any latency to be measured
+    \param amplitude Level the marker is played at
+    */
+    void Init(float sampleRate, float intervalSeconds = 0.1f, float amplitude = 0.5f);
+
+    /** Clears the results and starts again with a marker at the next Process(), can be
+     ** called from the main loop
+     */
+    void Reset() { resetPending_.store(true, std::memory_order_release); }
+
+    /** Plays the markers and listens for them
+    \param in Input samples, from the patch cable
+    \param out Output samples, overwritten with the markers
+    \param size Number of samples
+    */
+    void Process(const float* in, float* out, size_t size);
+
+    /** Returns the number of markers that came back */
+    uint32_t Count() const { return count_.load(std::memory_order_acquire); }
+
+    /** Returns the number of markers that didn't come back within the interval */
+    uint32_t Timeouts() const { return timeouts_; }
+
+    /** Latencies in samples, 0 until a marker came back */
+    uint32_t MinSamples() const { return Count() > 0 ? minSamples_ : 0; }
+    uint32_t MaxSamples() const { return maxSamples_; }
+    float    AvgSamples() const { return Count() > 0 ? (float)totalSamples_ / Count() : 0.0f; }
+
+    /** Returns the sample rate the latencies are counted at */
+    float SampleRate() const { return sampleRate_; }
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    /** Host only: called with every latency measured, for checking against a known delay */
+    typedef void (*HostObserver)(uint32_t latencySamples);
+    static void HostSetObserver(HostObserver observer) { hostObserver_ = observer; }
+#endif
+
+  private:
+    void Clear();
+    bool Detect(float sample);
+    void Record(uint32_t latency);
+
+    float    sampleRate_     = 48000.0f;
+    uint32_t intervalSamples_ = 4800;
+    float    amplitude_      = 0.5f;
+
+    uint32_t sampleCount_ = 0;  /**< Samples since the last marker started */
+    bool     listening_   = false;
+    float    window_[kCodeLength]; /**< The last input samples */
+    size_t   windowPos_ = 0;
+
+    std::atomic<bool>     resetPending_{false};
+    std::atomic<uint32_t> count_{0};
+    uint32_t              timeouts_     = 0;
+    uint32_t              minSamples_   = UINT32_MAX;
+    uint32_t              maxSamples_   = 0;
+    uint64_t              totalSamples_ = 0;
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    static inline HostObserver hostObserver_ = nullptr;
+#endif
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef LATEST_VALUE_H
+#define LATEST_VALUE_H /**< & */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+namespace bkshepherd {
+
+/**
+   @brief Wait-free handoff of the newest value from one context to another.
+
+   Where an SpscQueue keeps every item and refuses new ones once it is full, this keeps
+   only the newest: a write always succeeds and replaces whatever the reader hasn't
+   picked up yet.  Made for readings that are published faster than they are read,
+   e.g. a control task scanning at 1 kHz for an audio callback running at any block
+   size.
+
+   Three slots are used, one each for the writer and the reader and one in between that
+   holds the newest complete value.  Write() fills its slot and swaps it with the one in
+   between, Read() swaps that one with its own, so neither side ever waits for the other
+   and a value is never read while it is being written.  Exactly one context may Write
+   and exactly one other context may Read.
+
+   \tparam T Value type, should be a small trivially copyable struct
+*/
+template <typename T>
+class LatestValue
+{
+  public:
+    LatestValue() {}
+    ~LatestValue() {}
+
+    /** Publishes a value, writer side only */
+    void Write(const T& value)
+    {
+        slots_[back_] = value;
+        back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    /** Picks up the newest value, reader side only.
+    \return false if nothing was written since the last Read() and value was not changed
+    */
+    bool Read(T& value)
+    {
+        if(!(middle_.load(std::memory_order_relaxed) & kFresh))
+            return false;
+
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        value  = slots_[front_];
+        return true;
+    }
+
+  private:
+    static constexpr uint8_t kIndexMask = 0x03;
+    static constexpr uint8_t kFresh     = 0x04; /**< The slot in between hasn't been read */
+
+    T                    slots_[3];
+    uint8_t              back_  = 0; /**< Writer's slot */
+    uint8_t              front_ = 1; /**< Reader's slot */
+    std::atomic<uint8_t> middle_{2};
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef LINEAR_RAMP_H
+#define LINEAR_RAMP_H /**< & */
+
+#include <stddef.h>
+
+namespace bkshepherd {
+
+/**
+   @brief Moves a parameter linearly to a new target over a number of samples.
+
+   Used to hand control rate parameter changes to the audio path without zipper noise.
+   When the ramp is finished Process() is a plain fill.
+*/
+class LinearRamp
+{
+  public:
+    LinearRamp() {}
+    ~LinearRamp() {}
+
+    /** Jumps straight to a value */
+    void Init(float value)
+    {
+        value_     = value;
+        target_    = value;
+        step_      = 0.0f;
+        remaining_ = 0;
+    }
+
+    /** Starts a ramp from the current value.
+    \param target Value to arrive at
+    \param rampSamples Length of the ramp, 0 jumps straight to the target
+    */
+    void SetTarget(float target, size_t rampSamples)
+    {
+        if(rampSamples == 0)
+        {
+            Init(target);
+            return;
+        }
+
+        target_    = target;
+        step_      = (target - value_) / (float)rampSamples;
+        remaining_ = rampSamples;
+    }
+
+    /** Returns true while the value is still moving */
+    bool IsRamping() const { return remaining_ > 0; }
+
+    /** Returns the current value */
+    float Value() const { return value_; }
+
+    /** Returns the value the ramp is heading to */
+    float Target() const { return target_; }
+
+    /** Writes the next size values of the ramp.
+    \param out Buffer receiving size values
+    \param size Number of samples
+    */
+    void Process(float* out, size_t size)
+    {
+        size_t rampLength = remaining_ < size ? remaining_ : size;
+        size_t i          = 0;
+
+        for(; i < rampLength; i++)
+        {
+            value_ += step_;
+            out[i] = value_;
+        }
+
+        remaining_ -= rampLength;
+        if(rampLength > 0 && remaining_ == 0)
+        {
+            // Land exactly on the target, whatever rounding happened on the way.
+            value_     = target_;
+            out[i - 1] = value_;
+        }
+
+        for(; i < size; i++)
+        {
+            out[i] = value_;
+        }
+    }
+
+  private:
+    float  value_     = 0.0f;
+    float  target_    = 0.0f;
+    float  step_      = 0.0f;
+    size_t remaining_ = 0;
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,166 @@
+#include <math.h>
+#include "midi_clock_sync.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+// Loop gains for the phase (tick time) and the frequency (tick period), a critically
+// damped second order loop that settles in a couple of beats.
+static const double kPhaseGain  = 0.1;
+static const double kPeriodGain = kPhaseGain * kPhaseGain / 4.0;
+
+// Ticks further than this fraction of a period from the prediction are outliers, a few
+// in a row mean the tempo jumped and the loop locks again from scratch.
+static const double   kOutlierThreshold = 0.5;
+static const uint32_t kOutliersToRelock = 3;
+
+// The clock counts as stopped once this many ticks have been missed.
+static const float kTimeoutTicks = 12.0f;
+
+static const uint8_t kTicksPerCycle[MidiClockSync::DIVISION_LAST] = {96, 48, 24, 16, 12, 8, 6, 3};
+
+static const char* kDivisionNames[MidiClockSync::DIVISION_LAST]
+    = {"1/1", "1/2", "1/4", "1/4T", "1/8", "1/8T", "1/16", "1/32"};
+
+void MidiClockSync::Init(float sampleRate, const SampleClock* clock)
+{
+    sampleRate_      = sampleRate;
+    clock_           = clock;
+    stopped_         = false;
+    locked_          = false;
+    haveTick_        = false;
+    outliers_        = 0;
+    ticksSinceStart_ = 0;
+    state_           = {0, 0.0f, 0.0f, 0, false};
+    running_         = false;
+}
+
+bool MidiClockSync::HandleMidiEvent(const MidiEvent& event)
+{
+    if(event.type != SystemRealTime)
+        return false;
+
+    switch(event.srt_type)
+    {
+        case TimingClock: OnTick(clock_->Now()); return true;
+        case Start:
+        case Continue:
+        case Stop: OnTransport(event.srt_type); return true;
+        default: return false;
+    }
+}
+
+void MidiClockSync::OnTick(uint32_t sample)
+{
+    // Work on an unwrapped sample position so the loop can use doubles throughout.
+    unwrapped_ += haveTick_ ? (uint32_t)(sample - lastTickRaw_) : sample;
+    lastTickRaw_ = sample;
+
+    const double now      = (double)unwrapped_;
+    const double interval = now - lastTickTime_;
+    lastTickTime_         = now;
+
+    if(!haveTick_)
+    {
+        haveTick_ = true;
+        tickTime_ = now;
+    }
+    else if(!locked_)
+    {
+        // The first interval gives the starting tempo.
+        period_   = interval;
+        tickTime_ = now;
+        locked_   = period_ > 0.0;
+    }
+    else
+    {
+        const double predicted = tickTime_ + period_;
+        const double error     = now - predicted;
+
+        if(fabs(error) <= period_ * kOutlierThreshold)
+        {
+            tickTime_ = predicted + kPhaseGain * error;
+            period_ += kPeriodGain * error;
+            outliers_ = 0;
+        }
+        else if(++outliers_ >= kOutliersToRelock)
+        {
+            period_   = interval;
+            tickTime_ = now;
+            outliers_ = 0;
+        }
+        else
+        {
+            // A late tick from a busy main loop, keep running on the prediction.
+            tickTime_ = predicted;
+        }
+    }
+
+    ticksSinceStart_++;
+    if(locked_)
+        Publish();
+}
+
+void MidiClockSync::OnTransport(SystemRealTimeType type)
+{
+    // After Start the next tick is the first beat.
+    if(type == Start)
+        ticksSinceStart_ = 0;
+
+    stopped_ = type == Stop;
+    if(locked_)
+        Publish();
+}
+
+void MidiClockSync::Publish()
+{
+    const double whole = floor(tickTime_);
+
+    State state;
+    state.tickSample   = (uint32_t)(uint64_t)whole;
+    state.tickFraction = (float)(tickTime_ - whole);
+    state.period       = (float)period_;
+    state.tickCount    = (int32_t)ticksSinceStart_ - 1;
+    state.running      = !stopped_;
+    states_.Push(state);
+}
+
+bool MidiClockSync::Update(uint32_t blockStart)
+{
+    states_.PopLatest(state_);
+
+    const float sinceTick = (float)(int32_t)(blockStart - state_.tickSample);
+    running_ = state_.running && state_.period > 0.0f
+               && sinceTick < state_.period * kTimeoutTicks;
+    return running_;
+}
+
+float MidiClockSync::Tempo() const
+{
+    return state_.period > 0.0f ? sampleRate_ * 60.0f / (state_.period * 24.0f) : 0.0f;
+}
+
+float MidiClockSync::CycleFreq() const
+{
+    return state_.period > 0.0f ? sampleRate_ / (state_.period * kTicksPerCycle[division_]) : 0.0f;
+}
+
+float MidiClockSync::CyclePhase(uint32_t sample) const
+{
+    const double cycles = TickPosition(sample) / kTicksPerCycle[division_];
+    return (float)(cycles - floor(cycles));
+}
+
+double MidiClockSync::TickPosition(uint32_t sample) const
+{
+    if(state_.period <= 0.0f)
+        return 0.0;
+
+    const double sinceTick = (double)(int32_t)(sample - state_.tickSample) - state_.tickFraction;
+    return state_.tickCount + sinceTick / state_.period;
+}
+
+const char* MidiClockSync::DivisionName(Division division)
+{
+    return division < DIVISION_LAST ? kDivisionNames[division] : "";
+}
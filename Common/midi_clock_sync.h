@@ -0,0 +1,129 @@
+#pragma once
+#ifndef MIDI_CLOCK_SYNC_H
+#define MIDI_CLOCK_SYNC_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "daisy_seed.h"
+#include "sample_clock.h"
+#include "spsc_queue.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Follows incoming MIDI clock so an LFO can be locked to the tempo.
+
+   The main loop hands every MIDI event to HandleMidiEvent().  Timing clock messages (24
+   per quarter note) are stamped with the SampleClock position and fed to a second order
+   phase locked loop, which smooths out the jitter of the UART and the main loop and
+   follows tempo changes.  Start, Continue and Stop are followed too.
+
+   The audio callback calls Update() every block and then reads the tempo and the phase
+   of a note division from CycleFreq() and CyclePhase().  The position is counted in clock
+   ticks since Start, so changing tempo never makes the phase jump.
+*/
+class MidiClockSync
+{
+  public:
+    /** Note divisions an LFO cycle can follow */
+    enum Division
+    {
+        DIVISION_WHOLE,
+        DIVISION_HALF,
+        DIVISION_QUARTER,
+        DIVISION_QUARTER_TRIPLET,
+        DIVISION_EIGHTH,
+        DIVISION_EIGHTH_TRIPLET,
+        DIVISION_SIXTEENTH,
+        DIVISION_THIRTY_SECOND,
+        DIVISION_LAST,
+    };
+
+    MidiClockSync() {}
+    ~MidiClockSync() {}
+
+    /** Initialize the tracker
+    \param sampleRate Audio sample rate in Hz
+    \param clock Sample clock advanced by the audio callback, used to stamp clock messages
+    */
+    void Init(float sampleRate, const SampleClock* clock);
+
+    /** Follows clock and transport messages, call from the main loop.
+    \return true if the event was a clock or transport message
+    */
+    bool HandleMidiEvent(const daisy::MidiEvent& event);
+
+    /** Feeds one timing clock tick, main loop side.
+    \param sample Sample position the tick arrived at
+    */
+    void OnTick(uint32_t sample);
+
+    /** Feeds Start, Continue or Stop, main loop side */
+    void OnTransport(daisy::SystemRealTimeType type);
+
+    /** Picks up the latest clock state, call at the start of every audio block.
+    \param blockStart Sample position of the block, see SampleClock::BlockStart()
+    \return true while the clock is running and the LFO should follow it
+    */
+    bool Update(uint32_t blockStart);
+
+    /** Returns true while the clock is running, audio callback side */
+    bool Running() const { return running_; }
+
+    /** Sets the note division one LFO cycle lasts */
+    void SetDivision(Division division) { division_ = division < DIVISION_LAST ? division : DIVISION_QUARTER; }
+
+    Division GetDivision() const { return division_; }
+
+    /** Returns the tempo in quarter notes per minute, audio callback side */
+    float Tempo() const;
+
+    /** Returns the LFO frequency in Hz for the note division, audio callback side */
+    float CycleFreq() const;
+
+    /** Returns the LFO phase for the note division at a sample position, 0.0 to 1.0, audio callback side */
+    float CyclePhase(uint32_t sample) const;
+
+    /** Returns the position in clock ticks since Start at a sample position, audio callback side */
+    double TickPosition(uint32_t sample) const;
+
+    /** Returns the name of a division for display, for example "1/8T" */
+    static const char* DivisionName(Division division);
+
+  private:
+    /** Clock state handed from the main loop to the audio callback */
+    struct State
+    {
+        uint32_t tickSample;   /**< Whole sample position of the last tick after smoothing */
+        float    tickFraction; /**< Fractional part of that position */
+        float    period;       /**< Samples per tick */
+        int32_t  tickCount;    /**< Position of the last tick in ticks since Start */
+        bool     running;
+    };
+
+    void Publish();
+
+    float              sampleRate_ = 48000.0f;
+    const SampleClock* clock_      = nullptr;
+
+    // Main loop side
+    bool     stopped_         = false;
+    bool     locked_          = false;
+    bool     haveTick_        = false;
+    uint32_t outliers_        = 0;
+    uint32_t lastTickRaw_     = 0;
+    uint64_t unwrapped_       = 0;
+    double   lastTickTime_    = 0.0;
+    double   tickTime_        = 0.0;
+    double   period_          = 0.0;
+    uint32_t ticksSinceStart_ = 0;
+
+    SpscQueue<State, 8> states_;
+
+    // Audio callback side
+    State    state_    = {0, 0.0f, 0.0f, 0, false};
+    bool     running_  = false;
+    Division division_ = DIVISION_QUARTER;
+};
+} // namespace bkshepherd
+#endif
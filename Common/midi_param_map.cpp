@@ -0,0 +1,67 @@
+#include "midi_param_map.h"
+
+using namespace bkshepherd;
+
+void MidiParamMap::Init(const MidiCcMapping* mappings, size_t numMappings, const SampleClock* clock)
+{
+    mappings_    = mappings;
+    numMappings_ = numMappings;
+    clock_       = clock;
+    dropped_     = 0;
+
+    ParamEvent stale;
+    while(events_.Pop(stale))
+    {
+    }
+}
+
+bool MidiParamMap::HandleMidiEvent(const daisy::MidiEvent& event)
+{
+    if(event.type != daisy::ControlChange)
+        return false;
+
+    for(size_t i = 0; i < numMappings_; i++)
+    {
+        const MidiCcMapping& mapping = mappings_[i];
+        if(mapping.controlNumber != event.data[0]
+           || (mapping.channel != kOmni && mapping.channel != event.channel))
+            continue;
+
+        // One block of latency keeps the spacing between changes intact, a change
+        // that arrived part way through a block is applied at the same offset in the next.
+        ParamEvent paramEvent;
+        paramEvent.sample = clock_->Now() + clock_->BlockSize();
+        paramEvent.param  = mapping.param;
+        paramEvent.value  = (float)event.data[1] / 127.0f;
+
+        if(!events_.Push(paramEvent))
+        {
+            dropped_++;
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool MidiParamMap::PopDueEvent(uint32_t blockStart, size_t size, ParamEvent& event, size_t& offset)
+{
+    if(!events_.Peek(event))
+        return false;
+
+    // Sample positions wrap, compare them as a signed distance from the block start.
+    const int32_t position = (int32_t)(event.sample - blockStart);
+    if(position >= (int32_t)size)
+        return false;
+
+    events_.Pop(event);
+
+    // Anything late is applied at the start of the block.
+    offset = position > 0 ? (size_t)position : 0;
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    if(hostObserver_)
+        hostObserver_(event, blockStart + (uint32_t)offset);
+#endif
+    return true;
+}
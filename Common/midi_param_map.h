@@ -0,0 +1,95 @@
+#pragma once
+#ifndef MIDI_PARAM_MAP_H
+#define MIDI_PARAM_MAP_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "daisy_seed.h"
+#include "sample_clock.h"
+#include "spsc_queue.h"
+
+namespace bkshepherd {
+
+/** One row of a MIDI CC map, connects a controller on a channel to a pedal parameter */
+struct MidiCcMapping
+{
+    uint8_t channel;       /**< MIDI channel 0-15, or MidiParamMap::kOmni for any channel */
+    uint8_t controlNumber; /**< CC number 0-119 */
+    uint8_t param;         /**< Pedal specific parameter id */
+};
+
+/** A parameter change scheduled for a position on the audio timeline */
+struct ParamEvent
+{
+    uint32_t sample; /**< Sample position to apply the change at */
+    uint8_t  param;  /**< Parameter id from the MidiCcMapping */
+    float    value;  /**< 0.0 to 1.0 */
+};
+
+/**
+   @brief Table driven MIDI CC to parameter dispatch with sample accurate timing.
+
+   The main loop hands every MIDI event it pops to HandleMidiEvent().  Control changes
+   found in the map are stamped with the SampleClock position the main loop handled them
+   at, plus one block, and queued for the audio callback.  The callback asks PopDueEvent()
+   for the changes that fall inside its block and applies each one at its offset, so the
+   spacing between changes is kept as well as the main loop keeps up with the UART.  Bytes
+   that wait while the main loop is busy, during a flash erase for example, all get the
+   position of the pass that finally reads them and are applied together.
+*/
+class MidiParamMap
+{
+  public:
+    /** Channel value that matches every MIDI channel */
+    static constexpr uint8_t kOmni = 0xFF;
+
+    /** Number of parameter changes that can be waiting for the audio callback */
+    static constexpr size_t kQueueSize = 32;
+
+    MidiParamMap() {}
+    ~MidiParamMap() {}
+
+    /** Initialize the map and drop any changes still queued, they belong to the timeline
+     ** of a clock that is starting over.  Only call while the audio callback is stopped.
+    \param mappings Table of mappings, must stay valid while the map is used
+    \param numMappings Number of entries in the table
+    \param clock Sample clock advanced by the audio callback
+    */
+    void Init(const MidiCcMapping* mappings, size_t numMappings, const SampleClock* clock);
+
+    /** Schedules the event if it is a mapped control change, call from the main loop.
+    \return true if the event was mapped and queued
+    */
+    bool HandleMidiEvent(const daisy::MidiEvent& event);
+
+    /** Pops the next parameter change due in the current block, call from the audio callback.
+    \param blockStart Sample position of the block, see SampleClock::BlockStart()
+    \param size Number of samples in the block
+    \param event Receives the parameter change
+    \param offset Receives the sample offset in the block to apply the change at
+    \return false when no more changes are due in this block
+    */
+    bool PopDueEvent(uint32_t blockStart, size_t size, ParamEvent& event, size_t& offset);
+
+    /** Returns the number of changes dropped because the queue was full */
+    uint32_t DroppedCount() const { return dropped_; }
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    /** Host only: called with every change as it is applied, for checking the timeline */
+    typedef void (*HostObserver)(const ParamEvent& event, uint32_t appliedSample);
+    static void HostSetObserver(HostObserver observer) { hostObserver_ = observer; }
+#endif
+
+  private:
+    const MidiCcMapping*               mappings_    = nullptr;
+    size_t                             numMappings_ = 0;
+    const SampleClock*                 clock_       = nullptr;
+    SpscQueue<ParamEvent, kQueueSize> events_;
+    uint32_t                           dropped_ = 0;
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    static inline HostObserver hostObserver_ = nullptr;
+#endif
+};
+} // namespace bkshepherd
+#endif
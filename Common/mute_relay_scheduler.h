@@ -0,0 +1,119 @@
+#pragma once
+#ifndef MUTE_RELAY_SCHEDULER_H
+#define MUTE_RELAY_SCHEDULER_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace bkshepherd {
+
+/**
+   @brief Times the hardware mute and the true bypass relay around an effect toggle.
+
+   Switching the relay while audio is passing makes a pop, so a toggle mutes the output
+   straight away, switches the relay once the mute has settled and unmutes after that.
+   The two deadlines are kept as sample positions on the audio timeline.  At the start
+   of a block NextChange() works out whether either falls inside it, which is at most
+   twice per toggle, every other block has nothing to do.
+
+   The changes are quantised to blocks.  Both outputs are GPIOs the audio callback writes
+   once per block, so a change that falls inside a block reaches the hardware at the
+   start of the next one, wherever in the block its deadline was.
+*/
+class MuteRelayScheduler
+{
+  public:
+    MuteRelayScheduler() {}
+    ~MuteRelayScheduler() {}
+
+    /** Initialize the scheduler, not muted and not bypassed
+    \param sampleRate Audio sample rate in Hz
+    \param muteSeconds Time from a toggle until the mute comes off
+    \param relaySeconds Time from a toggle until the relay switches
+    */
+    void Init(float sampleRate, float muteSeconds, float relaySeconds)
+    {
+        sampleRate_ = sampleRate;
+        muteOn_     = false;
+        bypassOn_   = false;
+        pending_    = false;
+        SetTimes(muteSeconds, relaySeconds);
+    }
+
+    /** Sets the mute and relay times, a running sequence keeps its deadlines.  The relay
+     ** has to switch while the output is muted, so it is held to the mute time.
+     */
+    void SetTimes(float muteSeconds, float relaySeconds)
+    {
+        muteSamples_  = (uint32_t)(sampleRate_ * muteSeconds);
+        relaySamples_ = (uint32_t)(sampleRate_ * relaySeconds);
+        relaySamples_ = relaySamples_ < muteSamples_ ? relaySamples_ : muteSamples_;
+    }
+
+    /** Mutes now and schedules the relay and the unmute, a toggle during a running
+     ** sequence starts it again from the new sample.
+    \param sample Sample position the effect was toggled at
+    \param bypass Relay state to switch to
+    */
+    void Start(uint32_t sample, bool bypass)
+    {
+        muteOn_        = true;
+        pending_       = true;
+        relayPending_  = true;
+        targetBypass_  = bypass;
+        muteDeadline_  = sample + muteSamples_;
+        relayDeadline_ = sample + relaySamples_;
+    }
+
+    /** Checks whether the next change falls inside a block
+    \param blockStart Sample position of the block
+    \param size Number of samples in the block
+    \return false if nothing changes in this block
+    */
+    bool NextChange(uint32_t blockStart, size_t size) const
+    {
+        if(!pending_)
+            return false;
+
+        // Sample positions wrap, compare them as a signed distance.
+        const int32_t deadline = relayPending_ ? (int32_t)(relayDeadline_ - blockStart)
+                                               : (int32_t)(muteDeadline_ - blockStart);
+        return deadline < (int32_t)size;
+    }
+
+    /** Applies the change NextChange() found */
+    void ApplyChange()
+    {
+        if(relayPending_)
+        {
+            bypassOn_     = targetBypass_;
+            relayPending_ = false;
+
+            // Both deadlines can be on the same sample.
+            if(relayDeadline_ != muteDeadline_)
+                return;
+        }
+        muteOn_  = false;
+        pending_ = false;
+    }
+
+    /** Returns true while the hardware mute should be on */
+    bool MuteOn() const { return muteOn_; }
+
+    /** Returns true while the relay should bypass the effect */
+    bool BypassOn() const { return bypassOn_; }
+
+  private:
+    float    sampleRate_    = 48000.0f;
+    uint32_t muteSamples_   = 0;
+    uint32_t relaySamples_  = 0;
+    uint32_t muteDeadline_  = 0;
+    uint32_t relayDeadline_ = 0;
+    bool     muteOn_        = false;
+    bool     bypassOn_      = false;
+    bool     targetBypass_  = false;
+    bool     pending_       = false;
+    bool     relayPending_  = false;
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,156 @@
+#include <string.h>
+#include "preset_store.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+// Smallest erasable block of the Daisy Seed's IS25LP064A flash
+static const uint32_t kSectorSize = 4096;
+
+// Marks a slot that holds a record, and the layout of the record
+static const uint16_t kMagic = 0x5052;
+
+// Slot layout, little endian like the Cortex-M7:
+//   0  magic     uint16
+//   2  version   uint8, payload format
+//   3  size      uint8, payload bytes
+//   4  sequence  uint32, one more than the previous record
+//   8  crc       uint32, CRC-32 of bytes 0 - 7 and the payload
+//  12  payload
+static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for(int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t RecordCrc(const uint8_t* slot)
+{
+    const uint32_t crc = Crc32(0, slot, 8);
+    return Crc32(crc, slot + PresetStore::kHeaderSize, slot[3]);
+}
+
+void PresetStore::Init(QSPIHandle* qspi, uint32_t offset, size_t numSectors)
+{
+    qspi_           = qspi;
+    offset_         = offset;
+    slotsPerSector_ = kSectorSize / kSlotSize;
+    numSlots_       = slotsPerSector_ * numSectors;
+    hasRecord_      = false;
+    sequence_       = 0;
+    newestSlot_     = 0;
+
+    // One pass over every slot, the highest valid sequence number is the newest record.
+    for(size_t slot = 0; slot < numSlots_; slot++)
+    {
+        uint32_t sequence;
+        if(IsValid(slot, sequence) && (!hasRecord_ || (int32_t)(sequence - sequence_) > 0))
+        {
+            hasRecord_  = true;
+            sequence_   = sequence;
+            newestSlot_ = slot;
+        }
+    }
+    slotsScanned_ = numSlots_;
+
+    if(hasRecord_)
+        memcpy(record_, Slot(newestSlot_), kSlotSize);
+
+    // Carry on after the newest record, stepping over anything a torn write left behind.
+    // Reaching a sector boundary is fine, Save() erases the sector before using it.
+    nextSlot_ = hasRecord_ ? (newestSlot_ + 1) % numSlots_ : 0;
+    while(nextSlot_ % slotsPerSector_ != 0 && !IsBlank(nextSlot_))
+    {
+        nextSlot_ = (nextSlot_ + 1) % numSlots_;
+    }
+}
+
+size_t PresetStore::Load(void* payload, size_t size, uint8_t& version) const
+{
+    if(!hasRecord_)
+        return 0;
+
+    const size_t recordSize = record_[3];
+    size    = size < recordSize ? size : recordSize;
+    version = record_[2];
+    memcpy(payload, &record_[kHeaderSize], size);
+    return size;
+}
+
+bool PresetStore::Save(const void* payload, size_t size, uint8_t version)
+{
+    if(!qspi_ || size > kMaxPayloadSize)
+        return false;
+
+    const uint32_t sequence = hasRecord_ ? sequence_ + 1 : 0;
+
+    // Only the header and the payload are programmed, the rest of the slot stays erased.
+    uint8_t slot[kSlotSize];
+    memset(slot, 0xff, sizeof(slot));
+    slot[0] = kMagic & 0xff;
+    slot[1] = kMagic >> 8;
+    slot[2] = version;
+    slot[3] = (uint8_t)size;
+    memcpy(&slot[4], &sequence, sizeof(sequence));
+    memcpy(&slot[kHeaderSize], payload, size);
+    const uint32_t crc = RecordCrc(slot);
+    memcpy(&slot[8], &crc, sizeof(crc));
+
+    // Starting a sector, wipe the old records in it.  The newest record is always in
+    // another sector at this point.
+    const uint32_t address = offset_ + nextSlot_ * kSlotSize;
+    if(nextSlot_ % slotsPerSector_ == 0
+       && qspi_->EraseSector(address) != QSPIHandle::Result::OK)
+    {
+        return false;
+    }
+
+    if(qspi_->Write(address, kHeaderSize + size, slot) != QSPIHandle::Result::OK)
+    {
+        // Whatever made it into the slot fails the CRC, don't use it again.
+        nextSlot_ = (nextSlot_ + 1) % numSlots_;
+        return false;
+    }
+
+    memcpy(record_, slot, kSlotSize);
+    hasRecord_  = true;
+    sequence_   = sequence;
+    newestSlot_ = nextSlot_;
+    nextSlot_   = (nextSlot_ + 1) % numSlots_;
+    return true;
+}
+
+const uint8_t* PresetStore::Slot(size_t slot) const
+{
+    return static_cast<const uint8_t*>(qspi_->GetData(offset_ + slot * kSlotSize));
+}
+
+bool PresetStore::IsBlank(size_t slot) const
+{
+    const uint8_t* data = Slot(slot);
+    for(size_t i = 0; i < kSlotSize; i++)
+    {
+        if(data[i] != 0xff)
+            return false;
+    }
+    return true;
+}
+
+bool PresetStore::IsValid(size_t slot, uint32_t& sequence) const
+{
+    const uint8_t* data = Slot(slot);
+    if(data[0] != (kMagic & 0xff) || data[1] != (kMagic >> 8) || data[3] > kMaxPayloadSize)
+        return false;
+
+    uint32_t crc;
+    memcpy(&crc, &data[8], sizeof(crc));
+    memcpy(&sequence, &data[4], sizeof(sequence));
+    return crc == RecordCrc(data);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef PRESET_STORE_H
+#define PRESET_STORE_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "daisy_seed.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Keeps small settings records in QSPI flash across power cycles.
+
+   Records are appended to a log over a few flash sectors instead of rewriting one
+   place, each save takes the next fixed size slot.  When a sector is full the next one
+   is erased and the log carries on there, going round all the sectors so they wear
+   evenly.  The sector holding the newest record is never erased, so a power cut at any
+   point leaves either the old or the new settings readable.
+
+   Every record carries a sequence number and a CRC.  Init() reads every slot header
+   once, which bounds the boot time by the size of the region, and keeps the newest
+   record that checks out.  Torn writes fail the CRC and are skipped.
+
+   Saving erases and programs flash, which blocks for milliseconds, so only call Save()
+   from the main loop, never from the audio callback.
+*/
+class PresetStore
+{
+  public:
+    static constexpr size_t kSlotSize       = 32;
+    static constexpr size_t kHeaderSize     = 12;
+    static constexpr size_t kMaxPayloadSize = kSlotSize - kHeaderSize;
+
+    PresetStore() {}
+    ~PresetStore() {}
+
+    /** Scans the log and finds the newest valid record
+    \param qspi Flash to keep the log in, memory mapped for reading
+    \param offset Start of the log in the flash, sector aligned
+    \param numSectors Number of flash sectors the log goes round, at least 2
+    */
+    void Init(daisy::QSPIHandle* qspi, uint32_t offset, size_t numSectors);
+
+    /** Copies the newest record's payload
+    \param payload Buffer for the payload
+    \param size Size of the buffer, longer payloads are cut off
+    \param version Set to the version the payload was saved with
+    \return Number of payload bytes, 0 if nothing was saved yet
+    */
+    size_t Load(void* payload, size_t size, uint8_t& version) const;
+
+    /** Appends a record, main loop only
+    \param payload Settings to save, up to kMaxPayloadSize bytes
+    \param size Payload size
+    \param version Format version of the payload, handed back by Load()
+    \return false if the payload is too large or the flash write failed
+    */
+    bool Save(const void* payload, size_t size, uint8_t version);
+
+    /** Returns true if a valid record was found or saved */
+    bool HasRecord() const { return hasRecord_; }
+
+    /** Returns the sequence number of the newest record */
+    uint32_t Sequence() const { return sequence_; }
+
+    /** Returns the number of slots Init() looked at */
+    size_t SlotsScanned() const { return slotsScanned_; }
+
+  private:
+    const uint8_t* Slot(size_t slot) const;
+    bool           IsBlank(size_t slot) const;
+    bool           IsValid(size_t slot, uint32_t& sequence) const;
+
+    daisy::QSPIHandle* qspi_           = nullptr;
+    uint32_t           offset_         = 0;
+    size_t             numSlots_       = 0;
+    size_t             slotsPerSector_ = 0;
+    size_t             newestSlot_     = 0;
+    size_t             nextSlot_       = 0;
+    uint32_t           sequence_       = 0;
+    bool               hasRecord_      = false;
+    size_t             slotsScanned_   = 0;
+    uint8_t            record_[kSlotSize]; /**< Copy of the newest record, flash is only read by Init() */
+};
+} // namespace bkshepherd
+#endif
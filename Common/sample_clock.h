@@ -0,0 +1,88 @@
+#pragma once
+#ifndef SAMPLE_CLOCK_H
+#define SAMPLE_CLOCK_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "daisy_seed.h"
+
+namespace bkshepherd {
+
+/**
+   @brief Counts processed samples so events from the main loop can be placed on the
+   audio timeline.
+
+   The audio callback calls OnBlockStart() first thing every block, which notes the sample
+   position of the block together with System::GetUs().  The main loop calls Now() to
+   estimate the sample position the audio is at, interpolating the time since the last
+   block started.  A timer interrupt can call it too, e.g. to stamp a footswitch at the
+   sample position the scan saw it rather than at the block it fell in.
+*/
+class SampleClock
+{
+  public:
+    SampleClock() {}
+    ~SampleClock() {}
+
+    /** Initialize the clock
+    \param sampleRate Audio sample rate in Hz
+    */
+    void Init(float sampleRate)
+    {
+        samplesPerUs_    = sampleRate / 1000000.0f;
+        nextBlockStart_  = 0;
+        blockStart_      = 0;
+        blockStartUs_    = daisy::System::GetUs();
+        blockSize_       = 0;
+        sequence_.store(0, std::memory_order_release);
+    }
+
+    /** Call at the start of the audio callback
+    \param size Number of samples in this block
+    */
+    inline void OnBlockStart(size_t size)
+    {
+        blockStart_   = nextBlockStart_;
+        blockStartUs_ = daisy::System::GetUs();
+        blockSize_    = (uint32_t)size;
+        nextBlockStart_ += (uint32_t)size;
+        sequence_.fetch_add(1, std::memory_order_release);
+    }
+
+    /** Returns the sample position of the current block, audio callback side */
+    uint32_t BlockStart() const { return blockStart_; }
+
+    /** Returns an estimate of the sample position the audio is at, main loop or timer
+     ** interrupt side */
+    uint32_t Now() const
+    {
+        uint32_t start, startUs, sequence;
+
+        // Read again if the audio callback ran in between, the fields belong together.
+        do
+        {
+            sequence = sequence_.load(std::memory_order_acquire);
+            start    = blockStart_;
+            startUs  = blockStartUs_;
+        } while(sequence != sequence_.load(std::memory_order_acquire));
+
+        const uint32_t elapsedUs = daisy::System::GetUs() - startUs;
+        return start + (uint32_t)((float)elapsedUs * samplesPerUs_ + 0.5f);
+    }
+
+    /** Returns the size of the last block, events scheduled this far past Now() land
+     ** in the next block at the offset they arrived at.
+     */
+    uint32_t BlockSize() const { return blockSize_; }
+
+  private:
+    float                  samplesPerUs_   = 0.048f;
+    uint32_t               nextBlockStart_ = 0;
+    volatile uint32_t      blockStart_     = 0;
+    volatile uint32_t      blockStartUs_   = 0;
+    volatile uint32_t      blockSize_      = 0;
+    std::atomic<uint32_t>  sequence_{0};
+};
+} // namespace bkshepherd
+#endif
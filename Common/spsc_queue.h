@@ -0,0 +1,103 @@
+#pragma once
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H /**< & */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+namespace bkshepherd {
+
+/**
+   @brief Wait-free single producer / single consumer queue.
+
+   Used to hand data between the main loop and the audio callback without locks or
+   disabling interrupts.  Exactly one context may Push and exactly one other context may
+   Pop.  Items are copied in and out, the storage is a fixed array so nothing is
+   allocated.
+
+   \tparam T Item type, should be a small trivially copyable struct
+   \tparam kCapacity Maximum number of queued items, must be a power of two
+*/
+template <typename T, size_t kCapacity>
+class SpscQueue
+{
+    static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+  public:
+    SpscQueue() {}
+    ~SpscQueue() {}
+
+    /** Adds an item, producer side only.
+    \return false if the queue is full and the item was not added
+    */
+    bool Push(const T& item)
+    {
+        const uint32_t write = write_.load(std::memory_order_relaxed);
+        const uint32_t read  = read_.load(std::memory_order_acquire);
+        if(write - read >= kCapacity)
+            return false;
+
+        items_[write & (kCapacity - 1)] = item;
+        write_.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Removes the oldest item, consumer side only.
+    \return false if the queue was empty
+    */
+    bool Pop(T& item)
+    {
+        const uint32_t read  = read_.load(std::memory_order_relaxed);
+        const uint32_t write = write_.load(std::memory_order_acquire);
+        if(read == write)
+            return false;
+
+        item = items_[read & (kCapacity - 1)];
+        read_.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Copies the oldest item without removing it, consumer side only.
+    \return false if the queue was empty
+    */
+    bool Peek(T& item) const
+    {
+        const uint32_t read  = read_.load(std::memory_order_relaxed);
+        const uint32_t write = write_.load(std::memory_order_acquire);
+        if(read == write)
+            return false;
+
+        item = items_[read & (kCapacity - 1)];
+        return true;
+    }
+
+    /** Removes every queued item and keeps only the newest, consumer side only.
+    \return false if the queue was empty and item was not changed
+    */
+    bool PopLatest(T& item)
+    {
+        bool popped = false;
+        while(Pop(item))
+        {
+            popped = true;
+        }
+        return popped;
+    }
+
+    /** Returns the number of queued items, exact only from the consumer side */
+    size_t Size() const
+    {
+        return write_.load(std::memory_order_acquire) - read_.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const { return Size() == 0; }
+
+  private:
+    T                     items_[kCapacity];
+    std::atomic<uint32_t> write_{0};
+    std::atomic<uint32_t> read_{0};
+};
+} // namespace bkshepherd
+#endif
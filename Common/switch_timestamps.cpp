@@ -0,0 +1,66 @@
+#include "switch_timestamps.h"
+
+using namespace bkshepherd;
+
+void SwitchTimestamps::Init(size_t numSwitches, float sampleRate, float debounceSeconds)
+{
+    numSwitches_     = numSwitches < kMaxSwitches ? numSwitches : kMaxSwitches;
+    debounceSamples_ = (uint32_t)(debounceSeconds * sampleRate);
+    dropped_         = 0;
+    for(size_t i = 0; i < kMaxSwitches; i++)
+    {
+        state_[i]    = false;
+        settling_[i] = false;
+        changed_[i]  = 0;
+    }
+
+    SwitchEvent stale;
+    while(events_.Pop(stale))
+    {
+    }
+}
+
+void SwitchTimestamps::Poll(size_t index, bool raw, uint32_t sample)
+{
+    if(index >= numSwitches_)
+        return;
+
+    // Sample positions wrap, compare them as a signed distance.  Once the debounce time
+    // is over the switch stays settled, however long it is left alone.
+    if(settling_[index] && (int32_t)(sample - changed_[index]) >= (int32_t)debounceSamples_)
+        settling_[index] = false;
+    if(raw == state_[index] || settling_[index])
+        return;
+
+    state_[index]    = raw;
+    settling_[index] = true;
+    changed_[index]  = sample;
+
+    SwitchEvent event;
+    event.sample  = sample;
+    event.index   = (uint8_t)index;
+    event.pressed = raw;
+    if(!events_.Push(event))
+        dropped_++;
+}
+
+bool SwitchTimestamps::PopDueEvent(uint32_t blockStart, size_t size, SwitchEvent& event, size_t& offset)
+{
+    if(!events_.Peek(event))
+        return false;
+
+    const int32_t position = (int32_t)(event.sample - blockStart);
+    if(position >= (int32_t)size)
+        return false;
+
+    events_.Pop(event);
+
+    // Anything late is applied at the start of the block.
+    offset = position > 0 ? (size_t)position : 0;
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    if(hostObserver_)
+        hostObserver_(event, blockStart + (uint32_t)offset);
+#endif
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef SWITCH_TIMESTAMPS_H
+#define SWITCH_TIMESTAMPS_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "spsc_queue.h"
+
+namespace bkshepherd {
+
+/** A switch press or release placed on the audio timeline */
+struct SwitchEvent
+{
+    uint32_t sample;  /**< Sample position the change takes effect at */
+    uint8_t  index;   /**< Switch index */
+    bool     pressed; /**< true for a press, false for a release */
+};
+
+/**
+   @brief Puts footswitch presses on the audio timeline at the sample they happened.
+
+   The raw switch states are handed to Poll() from an interrupt that runs on time
+   whatever the main loop is doing, together with the sample position the change should
+   take effect at.  The first change after a switch has been steady for the debounce
+   time is taken straight away, the bounces after it are ignored.
+
+   The timer task stamps a change with the sample position the audio is at when the scan
+   sees it, plus one block.  A press that happened part way through a block is then
+   applied at the same offset in the next, and the latency is one block plus the time
+   until the next scan.  Polling from the audio callback instead would put every press at
+   the start of a block.  The audio callback asks PopDueEvent() for the presses that
+   fall inside its block and splits its processing there.
+*/
+class SwitchTimestamps
+{
+  public:
+    static constexpr size_t kMaxSwitches = 4;
+
+    /** Number of changes that can be waiting for the audio callback */
+    static constexpr size_t kQueueSize = 16;
+
+    SwitchTimestamps() {}
+    ~SwitchTimestamps() {}
+
+    /** Initialize the timestamps, every switch starts out released.  Changes still queued
+     ** are dropped, they belong to the timeline of a clock that is starting over.  Only
+     ** call while neither the poller nor the audio callback runs.
+    \param numSwitches Number of switches polled, up to kMaxSwitches
+    \param sampleRate Audio sample rate in Hz
+    \param debounceSeconds Time a switch ignores bounces for after it changed
+    */
+    void Init(size_t numSwitches, float sampleRate, float debounceSeconds = 0.01f);
+
+    /** Checks a switch for a change, call from the control task or the audio callback
+    \param index Switch index
+    \param raw Undebounced switch state, true while pressed
+    \param sample Sample position a change seen now takes effect at
+    */
+    void Poll(size_t index, bool raw, uint32_t sample);
+
+    /** Pops the next switch change due in the current block, call from the audio callback.
+    \param blockStart Sample position of the block, see SampleClock::BlockStart()
+    \param size Number of samples in the block
+    \param event Receives the switch change
+    \param offset Receives the sample offset in the block to apply the change at
+    \return false when no more changes are due in this block
+    */
+    bool PopDueEvent(uint32_t blockStart, size_t size, SwitchEvent& event, size_t& offset);
+
+    /** Returns the number of changes dropped because the queue was full */
+    uint32_t DroppedCount() const { return dropped_; }
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    /** Host only: called with every change as it is applied, for checking the timeline */
+    typedef void (*HostObserver)(const SwitchEvent& event, uint32_t appliedSample);
+    static void HostSetObserver(HostObserver observer) { hostObserver_ = observer; }
+#endif
+
+  private:
+    size_t                             numSwitches_     = 0;
+    uint32_t                           debounceSamples_ = 0;
+    bool                               state_[kMaxSwitches];
+    bool                               settling_[kMaxSwitches]; /**< Within the debounce time */
+    uint32_t                           changed_[kMaxSwitches];  /**< Sample position of the last change */
+    SpscQueue<SwitchEvent, kQueueSize> events_;
+    uint32_t                           dropped_ = 0;
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    static inline HostObserver hostObserver_ = nullptr;
+#endif
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,127 @@
+#include <math.h>
+#include "tap_tempo.h"
+
+using namespace bkshepherd;
+
+void TapTempo::Init(float sampleRate, float minTempo, float maxTempo)
+{
+    sampleRate_  = sampleRate;
+    minInterval_ = (uint32_t)(sampleRate * 60.0f / maxTempo);
+    maxInterval_ = (uint32_t)(sampleRate * 60.0f / minTempo);
+    Cancel();
+}
+
+bool TapTempo::Tap(uint32_t sample)
+{
+    // Sample positions wrap, the difference is still right.
+    const uint32_t interval = sample - lastTap_;
+
+    // Faster than the fastest tempo, a bounce or a double tap.
+    if(haveTap_ && interval < minInterval_)
+        return false;
+
+    taps_++;
+    lastTap_ = sample;
+    if(!haveTap_ || interval > maxInterval_)
+    {
+        // The first tap, or the first after a pause, only starts the count.
+        haveTap_ = true;
+        count_   = 0;
+        return false;
+    }
+
+    if(count_ == kMaxIntervals)
+    {
+        for(size_t i = 1; i < kMaxIntervals; i++)
+        {
+            intervals_[i - 1] = intervals_[i];
+        }
+        count_--;
+    }
+    intervals_[count_++] = interval;
+
+    // Average the intervals close to the median.
+    const float median = MedianInterval();
+    float       sum    = 0.0f;
+    size_t      used   = 0;
+    for(size_t i = 0; i < count_; i++)
+    {
+        if(fabsf((float)intervals_[i] - median) <= kOutlierThreshold * median)
+        {
+            sum += (float)intervals_[i];
+            used++;
+        }
+    }
+
+    if(used == 0)
+    {
+        // Nothing agrees, the tempo changed.
+        intervals_[0] = interval;
+        count_        = 1;
+        sum           = (float)interval;
+        used          = 1;
+    }
+
+    pendingPeriod_ = sum / (float)used;
+    beatSample_    = sample + (uint32_t)(pendingPeriod_ + 0.5f);
+    pending_       = true;
+    return true;
+}
+
+void TapTempo::Cancel()
+{
+    haveTap_ = false;
+    count_   = 0;
+    pending_ = false;
+    active_  = false;
+    period_  = 0.0f;
+}
+
+bool TapTempo::NextBeat(uint32_t blockStart, size_t size, size_t& offset) const
+{
+    if(!pending_)
+        return false;
+
+    // Sample positions wrap, compare them as a signed distance.
+    const int32_t beat = (int32_t)(beatSample_ - blockStart);
+    if(beat >= (int32_t)size)
+        return false;
+
+    offset = beat > 0 ? (size_t)beat : 0;
+    return true;
+}
+
+void TapTempo::ApplyBeat()
+{
+    period_  = pendingPeriod_;
+    anchor_  = beatSample_;
+    active_  = true;
+    pending_ = false;
+}
+
+float TapTempo::CyclePhase(uint32_t sample) const
+{
+    if(!active_)
+        return 0.0f;
+
+    const float cycles = (float)(int32_t)(sample - anchor_) / period_;
+    return cycles - floorf(cycles);
+}
+
+float TapTempo::MedianInterval() const
+{
+    uint32_t sorted[kMaxIntervals];
+    for(size_t i = 0; i < count_; i++)
+    {
+        // Insertion sort, there are only a handful.
+        size_t j = i;
+        for(; j > 0 && sorted[j - 1] > intervals_[i]; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = intervals_[i];
+    }
+
+    const size_t middle = count_ / 2;
+    return count_ % 2 ? (float)sorted[middle] : 0.5f * ((float)sorted[middle - 1] + (float)sorted[middle]);
+}
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef TAP_TEMPO_H
+#define TAP_TEMPO_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace bkshepherd {
+
+/**
+   @brief Works out a tempo from footswitch taps so an LFO can follow it.
+
+   The taps come from SwitchTimestamps, stamped with the sample position of the switch
+   scan that saw them in the pedals' 1 kHz control task.  They are stamped inside the
+   timer interrupt, never in the main loop, so a busy main loop can't move them and each
+   one is within a scan period of the press whatever the block size.  The last
+   kMaxIntervals intervals are kept.  A new tempo is their average, leaving out the ones
+   further than kOutlierThreshold from the median, so a missed or doubled tap doesn't
+   throw it off.  When all of them are that far out the tempo changed, the newest
+   interval starts over.  A pause longer than the slowest tempo starts over too.
+
+   A new tempo isn't applied straight away.  The next beat falls one period after the
+   tap, NextBeat() finds it inside a block and ApplyBeat() then switches to the new
+   period with the cycle starting on that sample.  Everything runs in the audio callback.
+*/
+class TapTempo
+{
+  public:
+    /** Number of intervals averaged */
+    static constexpr size_t kMaxIntervals = 4;
+
+    /** Intervals further than this fraction of the median are left out */
+    static constexpr float kOutlierThreshold = 0.25f;
+
+    TapTempo() {}
+    ~TapTempo() {}
+
+    /** Initialize the tap tempo, with no tempo until it is tapped
+    \param sampleRate Audio sample rate in Hz
+    \param minTempo Slowest tempo in beats per minute, longer pauses start over
+    \param maxTempo Fastest tempo in beats per minute, shorter intervals are ignored
+    */
+    void Init(float sampleRate, float minTempo = 30.0f, float maxTempo = 300.0f);
+
+    /** Feeds a tap
+    \param sample Sample position of the tap
+    \return true if the tap gave a new tempo, it starts on the next beat
+    */
+    bool Tap(uint32_t sample);
+
+    /** Forgets the taps and the tempo, for when the rate is set some other way */
+    void Cancel();
+
+    /** Finds the beat a new tempo starts on inside a block
+    \param blockStart Sample position of the block
+    \param size Number of samples in the block
+    \param offset Set to the sample offset of the beat within the block
+    \return false if no new tempo starts in this block
+    */
+    bool NextBeat(uint32_t blockStart, size_t size, size_t& offset) const;
+
+    /** Switches to the new tempo, call at the beat NextBeat() found */
+    void ApplyBeat();
+
+    /** Returns true once a tapped tempo has started */
+    bool Active() const { return active_; }
+
+    /** Returns the number of taps so far, kept over Init() and Cancel() */
+    uint32_t TapCount() const { return taps_; }
+
+    /** Returns the tempo that is running in beats per minute, 0 before one was tapped */
+    float Tempo() const { return active_ ? sampleRate_ * 60.0f / period_ : 0.0f; }
+
+    /** Returns the LFO frequency in Hz for one cycle per beat */
+    float CycleFreq() const { return active_ ? sampleRate_ / period_ : 0.0f; }
+
+    /** Returns the number of samples per beat */
+    float Period() const { return period_; }
+
+    /** Returns the cycle phase at a sample position, 0.0 on every beat */
+    float CyclePhase(uint32_t sample) const;
+
+  private:
+    float MedianInterval() const;
+
+    float    sampleRate_  = 48000.0f;
+    uint32_t minInterval_ = 0;
+    uint32_t maxInterval_ = 0;
+
+    uint32_t taps_    = 0;
+    bool     haveTap_ = false;
+    uint32_t lastTap_ = 0;
+    uint32_t intervals_[kMaxIntervals] = {}; /**< Oldest first */
+    size_t   count_                    = 0;
+
+    bool     pending_       = false;
+    uint32_t beatSample_    = 0;
+    float    pendingPeriod_ = 0.0f;
+
+    bool     active_ = false;
+    uint32_t anchor_ = 0; /**< Sample position of the beat the running tempo started on */
+    float    period_ = 0.0f;
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,192 @@
+#include <math.h>
+#include "daisysp.h"
+#include "wavetable_lfo.h"
+
+using namespace daisysp;
+using namespace bkshepherd;
+
+enum
+{
+    TABLE_SINE,
+    TABLE_TRIANGLE,
+    TABLE_SAW,
+    TABLE_RAMP,
+    TABLE_SQUARE,
+    TABLE_LAST,
+};
+
+// One cycle per waveform with a guard point at the end for the interpolation
+static float tables[TABLE_LAST][WavetableLfo::kTableSize + 1];
+static bool  tablesBuilt = false;
+
+// Sums the Fourier series of each waveform up to kHarmonics.  The harmonics are tapered
+// with the Lanczos sigma factor so the rounded edges don't ring, then every table is
+// scaled back to a peak of 1.
+static void BuildTables()
+{
+    const size_t size = WavetableLfo::kTableSize;
+    for(size_t i = 0; i <= size; i++)
+    {
+        const float phase = TWOPI_F * float(i % size) / float(size);
+        float       triangle = 0.0f, saw = 0.0f, square = 0.0f;
+        for(size_t n = 1; n <= WavetableLfo::kHarmonics; n++)
+        {
+            const float x     = PI_F * float(n) / float(WavetableLfo::kHarmonics + 1);
+            const float sigma = sinf(x) / x;
+            saw += sigma * sinf(phase * n) / float(n);
+            if(n % 2 == 1)
+            {
+                triangle += cosf(phase * n) / float(n * n);
+                square += sigma * sinf(phase * n) / float(n);
+            }
+        }
+
+        tables[TABLE_SINE][i]     = sinf(phase);
+        tables[TABLE_TRIANGLE][i] = triangle;
+        tables[TABLE_SAW][i]      = saw;
+        tables[TABLE_RAMP][i]     = -saw;
+        tables[TABLE_SQUARE][i]   = square;
+    }
+
+    for(size_t t = 0; t < TABLE_LAST; t++)
+    {
+        float peak = 0.0f;
+        for(size_t i = 0; i <= size; i++)
+        {
+            peak = fmaxf(peak, fabsf(tables[t][i]));
+        }
+        for(size_t i = 0; i <= size; i++)
+        {
+            tables[t][i] /= peak;
+        }
+    }
+    tablesBuilt = true;
+}
+
+void WavetableLfo::Init(float sampleRate, size_t decimation)
+{
+    if(!tablesBuilt)
+        BuildTables();
+
+    sampleRate_ = sampleRate;
+    decimation_ = decimation > 0 ? decimation : 1;
+    offset_     = 0.0f;
+    offsetOn_   = false;
+    SetWaveform(Oscillator::WAVE_SIN);
+    SetFreq(1.0f);
+    Reset(0.0f);
+}
+
+void WavetableLfo::SetFreq(float freq)
+{
+    phaseInc_ = freq / sampleRate_;
+}
+
+void WavetableLfo::SetWaveform(int waveform)
+{
+    switch(waveform)
+    {
+        case Oscillator::WAVE_TRI:
+        case Oscillator::WAVE_POLYBLEP_TRI: table_ = tables[TABLE_TRIANGLE]; break;
+        case Oscillator::WAVE_SAW:
+        case Oscillator::WAVE_POLYBLEP_SAW: table_ = tables[TABLE_SAW]; break;
+        case Oscillator::WAVE_RAMP: table_ = tables[TABLE_RAMP]; break;
+        case Oscillator::WAVE_SQUARE:
+        case Oscillator::WAVE_POLYBLEP_SQUARE: table_ = tables[TABLE_SQUARE]; break;
+        default: table_ = tables[TABLE_SINE]; break;
+    }
+
+    // Carry on from the same phase with the new waveform
+    if(remaining_ > 0)
+        Reset(Phase());
+}
+
+void WavetableLfo::Reset(float phase)
+{
+    phase_     = phase - floorf(phase);
+    remaining_ = 0;
+}
+
+float WavetableLfo::Phase() const
+{
+    const float phase = phase_ - segmentInc_ * float(remaining_);
+    return phase - floorf(phase);
+}
+
+void WavetableLfo::ProcessBlock(float* out, size_t size, float* offsetOut, float offset)
+{
+    // The offset line is only followed while there is an offset to fill, mono costs
+    // one table read per control point
+    const bool offsetOn = offsetOut && offset != 0.0f;
+    if(offsetOn && (!offsetOn_ || offset != offset_))
+    {
+        // Start the offset line over from the current sample
+        offset_ = offset;
+        if(remaining_ > 0)
+        {
+            offsetValue_ = ValueAt(Phase() + offset_);
+            offsetStep_  = (ValueAt(phase_ + offset_) - offsetValue_) / float(remaining_);
+        }
+    }
+    offsetOn_ = offsetOn;
+
+    size_t done = 0;
+    while(done < size)
+    {
+        if(remaining_ == 0)
+            NextControlPoint();
+
+        const size_t count = remaining_ < size - done ? remaining_ : size - done;
+        for(size_t i = 0; i < count; i++)
+        {
+            out[done + i] = value_ + step_ * float(i);
+        }
+        value_ += step_ * float(count);
+
+        if(offsetOn_)
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                offsetOut[done + i] = offsetValue_ + offsetStep_ * float(i);
+            }
+            offsetValue_ += offsetStep_ * float(count);
+        }
+        else if(offsetOut)
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                offsetOut[done + i] = out[done + i];
+            }
+        }
+
+        remaining_ -= count;
+        done += count;
+    }
+}
+
+float WavetableLfo::ValueAt(float phase) const
+{
+    phase -= floorf(phase);
+    const float position = phase * float(kTableSize);
+    size_t      index    = (size_t)position;
+    index                = index < kTableSize ? index : kTableSize - 1;
+    const float frac     = position - float(index);
+    return table_[index] + (table_[index + 1] - table_[index]) * frac;
+}
+
+void WavetableLfo::NextControlPoint()
+{
+    // Start the segment on the table, so rounding in the lines never builds up
+    segmentInc_  = phaseInc_;
+    float next   = phase_ + segmentInc_ * float(decimation_);
+    next        -= floorf(next);
+    value_       = ValueAt(phase_);
+    step_        = (ValueAt(next) - value_) / float(decimation_);
+    if(offsetOn_)
+    {
+        offsetValue_ = ValueAt(phase_ + offset_);
+        offsetStep_  = (ValueAt(next + offset_) - offsetValue_) / float(decimation_);
+    }
+    phase_       = next;
+    remaining_   = decimation_;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef WAVETABLE_LFO_H
+#define WAVETABLE_LFO_H /**< & */
+
+#include <stddef.h>
+
+namespace bkshepherd {
+
+/**
+   @brief Low frequency oscillator that reads band-limited wavetables at a decimated rate.
+
+   Every waveform is a table built once from a limited number of harmonics, so the edges
+   of the square, saw and ramp waves are rounded off and don't click when they modulate
+   a gain.  The tables are only read every few samples, at the control points, and the
+   samples in between are a straight line from one control point to the next.  At LFO
+   rates the line is indistinguishable from the curve and costs an add per sample.
+
+   The waveforms and phases match daisysp::Oscillator: sine, triangle, saw, ramp and
+   square, with the polyblep variants falling back to the plain ones.  The output is
+   -1.0 to 1.0.
+*/
+class WavetableLfo
+{
+  public:
+    static constexpr size_t kTableSize = 512;
+    static constexpr size_t kHarmonics = 32;
+
+    WavetableLfo() {}
+    ~WavetableLfo() {}
+
+    /** Initialize the LFO, phase 0, 1 Hz sine
+    \param sampleRate Rate Process() is called at, in Hz
+    \param decimation Number of samples between table reads, 1 reads every sample
+    */
+    void Init(float sampleRate, size_t decimation = 1);
+
+    /** Sets the frequency in Hz, picked up at the next control point */
+    void SetFreq(float freq);
+
+    /** Sets the waveform, one of the daisysp::Oscillator waveforms */
+    void SetWaveform(int waveform);
+
+    /** Jumps to a phase, 0.0 to 1.0, and starts a new control point there */
+    void Reset(float phase);
+
+    /** Returns the phase of the next sample, 0.0 to 1.0 */
+    float Phase() const;
+
+    /** Returns the next sample */
+    float Process()
+    {
+        if(remaining_ == 0)
+            NextControlPoint();
+        remaining_--;
+        const float out = value_;
+        value_ += step_;
+        offsetValue_ += offsetStep_;
+        return out;
+    }
+
+    /** Fills a block with the next samples
+    \param out Buffer receiving size samples
+    \param size Number of samples
+    \param offsetOut Optional buffer receiving the waveform at a phase offset, following
+                     the same control points.  Without it, or at an offset of 0.0, the
+                     control points only read the table once.
+    \param offset Phase offset for offsetOut, 0.0 to 1.0
+    */
+    void ProcessBlock(float* out, size_t size, float* offsetOut = nullptr, float offset = 0.0f);
+
+    /** Returns the waveform at a phase from the table, interpolated */
+    float ValueAt(float phase) const;
+
+  private:
+    void NextControlPoint();
+
+    const float* table_      = nullptr;
+    float        sampleRate_ = 48000.0f;
+    size_t       decimation_ = 1;
+    float        phaseInc_    = 0.0f; /**< Per sample, from SetFreq() */
+    float        segmentInc_  = 0.0f; /**< Per sample, in the current segment */
+    float        phase_       = 0.0f; /**< At the next control point */
+    size_t       remaining_   = 0;    /**< Samples left before the next control point */
+    float        value_       = 0.0f;
+    float        step_        = 0.0f;
+    float        offset_      = 0.0f;
+    bool         offsetOn_    = false; /**< The offset line is followed, not for mono */
+    float        offsetValue_ = 0.0f;
+    float        offsetStep_  = 0.0f;
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,94 @@
+#include "cpu_load_page.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+bool CpuLoadPage::OnOkayButton(uint8_t numberOfPresses, bool isRetriggering)
+{
+    if(numberOfPresses == 1 && !isRetriggering)
+    {
+        Close();
+    }
+    return true;
+}
+
+bool CpuLoadPage::OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution)
+{
+    // Nothing to navigate on this page
+    return true;
+}
+
+void CpuLoadPage::DrawLoad(MyOledDisplay& display, uint8_t y, const char* label, float load)
+{
+    // Tenths of a percent, printf on the Daisy Seed has no float support.
+    int  tenths = (int)(load * 1000.0f);
+    char line[16];
+    sprintf(line, "%s %d.%d%%", label, tenths / 10, tenths % 10);
+    display.SetCursor(0, y);
+    display.WriteString(line, Font_6x8, true);
+}
+
+void CpuLoadPage::DrawAudioSettings(MyOledDisplay& display)
+{
+    const unsigned sampleRate = (unsigned)hardware_->AudioSampleRate();
+    const unsigned blockSize  = (unsigned)hardware_->AudioBlockSize();
+
+    char line[24];
+    sprintf(line, "%uk/%u", sampleRate / 1000, blockSize);
+    display.SetCursor(72, 0);
+    display.WriteString(line, Font_6x8, true);
+
+    // A block is buffered on the way in and another on the way out, the converters add
+    // their own delay on top.  In hundredths of a millisecond.
+    const unsigned hundredths = (2 * blockSize * 100000 + sampleRate / 2) / sampleRate;
+    sprintf(line, "Lat %u.%02ums", hundredths / 100, hundredths % 100);
+    display.SetCursor(0, 54);
+    display.WriteString(line, Font_6x8, true);
+}
+
+void CpuLoadPage::Draw(const UiCanvasDescriptor& canvas)
+{
+    MyOledDisplay& display = *((MyOledDisplay*)(canvas.handle_));
+
+    display.SetCursor(0, 0);
+    display.WriteString("CPU Load", Font_7x10, true);
+
+    if(meter_ == nullptr)
+        return;
+
+    DrawLoad(display, 14, "Min", meter_->MinLoad());
+    DrawLoad(display, 24, "Avg", meter_->AvgLoad());
+    DrawLoad(display, 34, "Max", meter_->MaxLoad());
+
+    char line[16];
+    sprintf(line, "Miss %lu", (unsigned long)meter_->DeadlineMisses());
+    display.SetCursor(0, 44);
+    display.WriteString(line, Font_6x8, true);
+
+    if(hardware_ != nullptr)
+        DrawAudioSettings(display);
+
+    // Histogram of the load in 10% steps, the last bar is everything over budget.
+    const uint8_t histogramLeft   = 72;
+    const uint8_t histogramBottom = 63;
+    const uint8_t histogramHeight = 48;
+    const uint8_t barWidth        = 5;
+
+    uint32_t largestBin = 1;
+    for(size_t i = 0; i < AudioLoadMeter::kNumHistogramBins; i++)
+    {
+        if(meter_->HistogramBin(i) > largestBin)
+            largestBin = meter_->HistogramBin(i);
+    }
+
+    for(size_t i = 0; i < AudioLoadMeter::kNumHistogramBins; i++)
+    {
+        uint8_t x      = histogramLeft + i * barWidth;
+        uint8_t height = (uint8_t)((uint64_t)meter_->HistogramBin(i) * histogramHeight / largestBin);
+        display.DrawLine(x, histogramBottom, x + barWidth - 2, histogramBottom, true);
+        if(height > 0)
+        {
+            display.DrawRect(x, histogramBottom - height, x + barWidth - 2, histogramBottom, true, true);
+        }
+    }
+}
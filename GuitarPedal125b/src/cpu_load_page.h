@@ -0,0 +1,43 @@
+#pragma once
+#ifndef CPU_LOAD_PAGE_H
+#define CPU_LOAD_PAGE_H /**< & */
+
+#include "guitar_pedal_125b.h"
+#include "audio_load_meter.h"
+
+namespace bkshepherd {
+
+/**
+   @brief OLED page showing the Audio Callback load measured by an AudioLoadMeter.
+
+   Shows the min / avg / max load as a percentage of the block budget, the number of
+   blocks that missed their deadline and a histogram of the load.  The sample rate, block
+   size and the latency they add are shown too, to weigh the load against the latency.
+   Press the encoder to close the page.
+*/
+class CpuLoadPage : public UiPage
+{
+  public:
+    /** Initialize the page
+    \param meter Meter filled in by the Audio Callback
+    \param hardware Pedal the audio settings are read from
+    */
+    void Init(const AudioLoadMeter* meter, GuitarPedal125B* hardware)
+    {
+        meter_    = meter;
+        hardware_ = hardware;
+    }
+
+    bool OnOkayButton(uint8_t numberOfPresses, bool isRetriggering) override;
+    bool OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution) override;
+    void Draw(const UiCanvasDescriptor& canvas) override;
+
+  private:
+    void DrawLoad(MyOledDisplay& display, uint8_t y, const char* label, float load);
+    void DrawAudioSettings(MyOledDisplay& display);
+
+    const AudioLoadMeter* meter_    = nullptr;
+    GuitarPedal125B*      hardware_ = nullptr;
+};
+} // namespace bkshepherd
+#endif
@@ -3,25 +3,27 @@
 #define GUITAR_PEDAL_125B_H /**< & */
 
 #include "daisy_seed.h"
-#include "dev/oled_ssd130x.h"
+#include "hid/disp/oled_display.h"
+#include "oled_ssd130x_dma.h"
+#include "guitar_pedal.h"
 
 using namespace daisy;
 
 /** Typedef the OledDisplay to make syntax cleaner below 
  *  This is a 4Wire SPI Transport controlling an 128x64 sized SSDD1306
+ *  Only the changed pages are sent, with DMA, so Update() doesn't block the main loop.
  * 
  *  There are several other premade test 
 */
-using MyOledDisplay = OledDisplay<SSD130x4WireSpi128x64Driver>;
+using MyOledDisplay = OledDisplay<bkshepherd::SSD130x4WireSpiDma128x64Driver>;
 
 namespace bkshepherd {
 
 /**
-   @brief Helpers and hardware definitions for a 125B sized Guitar Pedal based on the Daisy Seed.
+   @brief Hardware definitions for a 125B sized Guitar Pedal based on the Daisy Seed.
 */
-class GuitarPedal125B
+struct GuitarPedal125BBoard
 {
-  public:
     /** Switches */
     enum SwitchIndex
     {
@@ -42,7 +44,7 @@ class GuitarPedal125B
         KNOB_LAST, /**< & */
     };
 
-    /** Knobs */
+    /** Encoders */
     enum EncoderIndex
     {
         ENCODER_1,    /**< & */
@@ -57,132 +59,31 @@ class GuitarPedal125B
         LED_LAST, /**< & */
     };
 
-    /** Constructor */
-    GuitarPedal125B() {}
-    /** Destructor */
-    ~GuitarPedal125B() {}
-
-    /** Initialize the pedal */
-    void Init(bool boost = false);
-
-    /**
-       Wait before moving on.
-       \param del Delay time in ms.
-     */
-    void DelayMs(size_t del);
-
-
-    /** Starts the callback
-    \param cb Interleaved callback function
-    */
-    void StartAudio(AudioHandle::InterleavingAudioCallback cb);
-
-    /** Starts the callback
-    \param cb multichannel callback function
-    */
-    void StartAudio(AudioHandle::AudioCallback cb);
-
-    /**
-       Switch callback functions
-       \param cb New interleaved callback function.
-    */
-    void ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb);
-
-    /**
-       Switch callback functions
-       \param cb New multichannel callback function.
-    */
-    void ChangeAudioCallback(AudioHandle::AudioCallback cb);
-
-    /** Stops the audio if it is running. */
-    void StopAudio();
+    static constexpr uint8_t     kSwitchPins[SWITCH_LAST]   = {6, 5};
+    static constexpr uint8_t     kKnobPins[KNOB_LAST]       = {15, 16, 17, 18, 19, 20};
+    static constexpr EncoderPins kEncoderPins[ENCODER_LAST] = {{3, 2, 4}};
+    static constexpr uint8_t     kLedPins[LED_LAST]         = {22, 23};
 
-    /** Updates the Audio Sample Rate, and reinitializes.
-     ** Audio must be stopped for this to work.
-     */
-    void SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate);
+    static constexpr int kMidiRxPin = 30;
+    static constexpr int kMidiTxPin = 29;
 
-    /** Returns the audio sample rate in Hz as a floating point number.
-     */
-    float AudioSampleRate();
+    static constexpr Pin kBypassPin = seed::D1;
+    static constexpr Pin kMutePin   = seed::D12;
 
-    /** Sets the number of samples processed per channel by the audio callback.
-       \param size Audio block size
-     */
-    void SetAudioBlockSize(size_t size);
+    static constexpr size_t                        kBlockSize  = 48;
+    static constexpr SaiHandle::Config::SampleRate kSampleRate = SaiHandle::Config::SampleRate::SAI_48KHZ;
 
-    /** Returns the number of samples per channel in a block of audio. */
-    size_t AudioBlockSize();
+    using Display = MyOledDisplay;
 
-    /** Returns the rate in Hz that the Audio callback is called */
-    float AudioCallbackRate();
-
-    /** Start analog to digital conversion. */
-    void StartAdc();
-
-    /** Stops Transfering data from the ADC */
-    void StopAdc();
-
-    /** Call at the same frequency as controls are read for stable readings.*/
-    void ProcessAnalogControls();
+    /** Sets up the OLED on its SPI pins, with the DMA buffer it sends frames from */
+    static void InitDisplay(DaisySeed& seed, Display& display);
+};
 
-    /** Process Analog and Digital Controls */
-    inline void ProcessAllControls()
-    {
-        ProcessAnalogControls();
-        ProcessDigitalControls();
-    }
-
-    /** Get value per knob.
-    \param k Which knob to get
-    \return Floating point knob position.
-    */
-    float GetKnobValue(KnobIndex k);
-
-    /** Process digital controls */
-    void ProcessDigitalControls();
-
-    /** Toggle the Hardware Audio Bypass (if applicable) */
-    void SetAudioBypass(bool enabled);
-
-    /** Toggle the Hardware Audio Mute (if applicable) */
-    void SetAudioMute(bool enabled);
-
-    /** Turn all leds off */
-    void ClearLeds();
-
-    /**
-       Set Led
-       \param idx Led Index
-       \param bright Brightness
-     */
-    void SetLed(LedIndex idx, float bright);
-
-    /** Updates all the LEDs based on their values */
-    void UpdateLeds();
-
-    DaisySeed seed;    /**< & */
-    MyOledDisplay display;
-    AnalogControl knobs[KNOB_LAST]; /**< & */
-    Encoder encoders[ENCODER_LAST]; /**< & */
-    Switch        switches[SWITCH_LAST] /**< & */;
-    Led           leds[LED_LAST]; /**< & */
-    MidiUartHandler midi;
-    GPIO audioBypassTrigger;
-    bool audioBypass;
-    GPIO audioMuteTrigger;
-    bool audioMute;
-
-  private:
-    void SetHidUpdateRates();
-    void InitSwitches();
-    void InitEncoders();
-    void InitLeds();
-    void InitAnalogControls();
-    void InitMidi();
-
-    inline uint16_t* adc_ptr(const uint8_t chn) { return seed.adc.GetPtr(chn); }
+/**
+   @brief Helpers and hardware definitions for a 125B sized Guitar Pedal based on the Daisy Seed.
+*/
+using GuitarPedal125B = GuitarPedal<GuitarPedal125BBoard>;
 
-};
+extern template class GuitarPedal<GuitarPedal125BBoard>;
 } // namespace bkshepherd
 #endif
@@ -1,6 +1,28 @@
 #include <string.h>
 #include "guitar_pedal_125b.h"
 #include "daisysp.h"
+#include "audio_load_meter.h"
+#include "block_tremolo.h"
+#include "wavetable_lfo.h"
+#include "block_overdrive.h"
+#include "block_delay.h"
+#include "effect_chain.h"
+#include "effect_switcher.h"
+#include "control_rate.h"
+#include "control_task.h"
+#include "mute_relay_scheduler.h"
+#include "spsc_queue.h"
+#include "latest_value.h"
+#include "sample_clock.h"
+#include "midi_param_map.h"
+#include "switch_timestamps.h"
+#include "midi_clock_sync.h"
+#include "tap_tempo.h"
+#include "preset_store.h"
+#include "cpu_load_page.h"
+#include "latency_probe.h"
+#include "latency_page.h"
+#include "tempo_page.h"
 
 using namespace daisy;
 using namespace daisysp;
@@ -16,45 +38,399 @@ float led2Brightness = 0.0f;
 
 bool midiEnabled = true;
 bool relayBypassEnabled = true;
-bool bypassOn = false;
-bool muteOn = false;
-float muteOffTransitionTimeInSeconds = 0.02f;
-int muteOffTransitionTimeInSamples;
-int samplesTilMuteOff;
-float bypassToggleTransitionTimeInSeconds = 0.01f;
-int bypassToggleTransitionTimeInSamples;
-int samplesTilBypassToggle;
+
+// Toggling the effect mutes the output, switches the relay and unmutes, timed from the menu
+MuteRelayScheduler muteRelay;
+MappedIntValue muteOffTransitionTimeMs(5, 100, 20, 1, 5, "ms");
+MappedIntValue bypassToggleTransitionTimeMs(1, 50, 10, 1, 5, "ms");
+
+// Audio Callback Load Measurement
+AudioLoadMeter loadMeter;
+
+// Round trip latency measurement, with the output patched to the input
+LatencyProbe latencyProbe;
+
+// Knobs are read at a fixed control rate, and only cause recalculation when they really move
+const float controlUpdateRate = 1000.0f;
+const float knobDeadBand = 0.002f;
+ControlRateScheduler controlRate;
+
+// The switches, encoder and knobs are scanned by a timer task at the control rate, which
+// publishes the knob values for the Audio Callback.  The versions count the changes the
+// front end reported, so the callback only applies knobs that moved.
+struct ControlValues
+{
+    float knobs[GuitarPedal125B::KNOB_LAST];
+    uint32_t versions[GuitarPedal125B::KNOB_LAST];
+    uint32_t version; // Changes of any knob
+};
+
+ControlTask controlTask;
+LatestValue<ControlValues> publishedControls;
+ControlValues latestControls; // Audio Callback side
+uint32_t appliedKnobVersions[GuitarPedal125B::KNOB_LAST];
+uint32_t appliedKnobsVersion = 0;
+
+// MIDI Control Changes are mapped onto these parameters and applied at the sample they arrived at
+enum MidiParam
+{
+    MIDI_PARAM_TREM_RATE,
+    MIDI_PARAM_TREM_DEPTH,
+    MIDI_PARAM_TREM_WAVEFORM,
+    MIDI_PARAM_BYPASS,
+};
+
+const MidiCcMapping midiCcMappings[] = {
+    {MidiParamMap::kOmni, 14, MIDI_PARAM_TREM_RATE},
+    {MidiParamMap::kOmni, 15, MIDI_PARAM_TREM_DEPTH},
+    {MidiParamMap::kOmni, 16, MIDI_PARAM_TREM_WAVEFORM},
+    {MidiParamMap::kOmni, 102, MIDI_PARAM_BYPASS}, // 64 - 127 bypasses the effect
+};
+
+SampleClock sampleClock;
+MidiParamMap midiParamMap;
+
+// Footswitch presses are stamped by the control task and applied at the sample they happened
+SwitchTimestamps switchTimestamps;
+
+// The Tremolo follows MIDI clock while it's running, the rate then picks the note division
+MidiClockSync midiClock;
+bool tremSynced = false;
+
+// The Second Footswitch taps a tempo, the Tremolo then runs a cycle per beat until the
+// rate knob is turned well away from where it was or MIDI sets the rate.
+TapTempo tapTempo;
+const float tapKnobTakeover = 0.05f;
+float tapRateKnob = 0.0f;
+uint32_t shownTapCount = 0; // Main loop side, the Tempo page opens on a new tap
 
 // Menu System Variables
 daisy::UI ui;
 FullScreenItemMenu mainMenu;
 FullScreenItemMenu tremoloMenu;
+FullScreenItemMenu chainMenu;
 FullScreenItemMenu globalSettingsMenu;
+FullScreenItemMenu audioMenu;
+CpuLoadPage        cpuLoadPage;
+LatencyPage        latencyPage;
+TempoPage          tempoPage;
 UiEventQueue       eventQueue;
 
-const int                kNumMainMenuItems =  2;
+const int                kNumMainMenuItems =  5;
 AbstractMenu::ItemConfig mainMenuItems[kNumMainMenuItems];
-const int                kNumTremoloMenuItems = 4;
+const int                kNumTremoloMenuItems = 7;
 AbstractMenu::ItemConfig tremoloMenuItems[kNumTremoloMenuItems];
-const int                kNumGlobalSettingsMenuItems = 3;
+const int                kNumChainMenuItems = 2 * 3 + 1;
+AbstractMenu::ItemConfig chainMenuItems[kNumChainMenuItems];
+const int                kNumGlobalSettingsMenuItems = 5;
 AbstractMenu::ItemConfig globalSettingsMenuItems[kNumGlobalSettingsMenuItems];
+const int                kNumAudioMenuItems = 5;
+AbstractMenu::ItemConfig audioMenuItems[kNumAudioMenuItems];
+
+// Audio menu items, the audio restarts with them once they have stopped changing
+const char* audioBlockSizeListValues[]
+    = {"1", "2", "4", "8", "16", "32", "48", "64", "128", "256"};
+const size_t audioBlockSizes[] = {1, 2, 4, 8, 16, 32, 48, 64, 128, 256};
+MappedStringListValue audioBlockSizeListMappedValues(audioBlockSizeListValues, 10, 2);
+
+const char* audioSampleRateListValues[]
+    = {"8kHz", "16kHz", "32kHz", "48kHz", "96kHz"};
+const SaiHandle::Config::SampleRate audioSampleRates[] = {
+    SaiHandle::Config::SampleRate::SAI_8KHZ,
+    SaiHandle::Config::SampleRate::SAI_16KHZ,
+    SaiHandle::Config::SampleRate::SAI_32KHZ,
+    SaiHandle::Config::SampleRate::SAI_48KHZ,
+    SaiHandle::Config::SampleRate::SAI_96KHZ,
+};
+MappedStringListValue audioSampleRateListMappedValues(audioSampleRateListValues, 5, 3);
+
+const uint32_t audioRestartDelayMs = 500; // Wait for the menu to settle before restarting the audio
+int      runningBlockSizeIndex;
+int      runningSampleRateIndex;
+uint32_t audioMenuChangedMs;
 
 // Tremolo menu items
 const char* tremTypeListValues[]
     = {"Simple", "Harmonic"};
 MappedStringListValue tremTypeListMappedValues(tremTypeListValues, 2, 0);
 
+// Harmonic mode crossover, kept to a multiple of 10 Hz so the preset can store it in a byte
+MappedIntValue tremCrossoverValue(200, 2000, 800, 10, 100, "Hz");
+
+// Right channel LFO phase, 0, 90 and 180 degrees
+const char* tremStereoListValues[]
+    = {"Mono", "Wide", "Ping-Pong"};
+MappedStringListValue tremStereoListMappedValues(tremStereoListValues, 3, 0);
+const float tremStereoPhases[] = {0.0f, 0.25f, 0.5f};
+
 const char* tremWaveformListValues[]
     = {"Sine", "Triangle", "Saw", "Ramp", "Square"};
 MappedStringListValue tremWaveformListMappedValues(tremWaveformListValues, 5, 0);
 MappedStringListValue tremOscWaveformListMappedValues(tremWaveformListValues, 5, 0);
 
+// The effects run in a chain of slots that is set up from the menu.  Every effect has
+// one statically allocated instance, so an effect can only be in one slot at a time.
+enum ChainEffect
+{
+    CHAIN_EFFECT_NONE,
+    CHAIN_EFFECT_OVERDRIVE,
+    CHAIN_EFFECT_TREMOLO,
+    CHAIN_EFFECT_DELAY,
+    CHAIN_EFFECT_LAST,
+};
+
+const size_t kNumChainSlots = 3;
+const char* chainEffectListValues[] = {"None", "Overdrive", "Tremolo", "Delay"};
+MappedStringListValue chainSlotListMappedValues[kNumChainSlots] = {
+    MappedStringListValue(chainEffectListValues, CHAIN_EFFECT_LAST, CHAIN_EFFECT_TREMOLO),
+    MappedStringListValue(chainEffectListValues, CHAIN_EFFECT_LAST, CHAIN_EFFECT_NONE),
+    MappedStringListValue(chainEffectListValues, CHAIN_EFFECT_LAST, CHAIN_EFFECT_NONE),
+};
+bool chainSlotOn[kNumChainSlots] = {true, true, true};
+
+// Changes to the chain are set up in the idle one of two chains, then the switcher fades
+// over to it.  Chains that share an effect fade out and back in, others crossfade.
+typedef EffectChain<kNumChainSlots> PedalChain;
+PedalChain effectChains[2];
+EffectSwitcher chainSwitcher;
+float chainFadeTimeInSeconds = 0.03f;
+int chainFadeTimeInSamples;
+
 // Effect Related Variables
-Tremolo    treml, tremr;
-Oscillator freq_osc;
+BlockOverdrive overdrive;
+BlockTremolo tremolo;
+BlockDelay delay;
+
+// Up to a little over a second of delay, in SDRAM
+const size_t delayBufferLength = 65536;
+float DSY_SDRAM_BSS delayBuffer[2][delayBufferLength];
+WavetableLfo freq_osc; // Modulates the tremolo rate, runs at the control rate
 int  waveform;
 float osc_freq;
-Parameter osc_freq_knob;
+float tremRate = 0.0f;    // Set by the knob or MIDI, 0.0 to 1.0
+float tremRateMod = 1.0f; // Last value of the frequency modulation oscillator
+
+// Settings from the menus.  The main loop publishes a copy whenever they change and the
+// Audio Callback picks up the newest copy at the start of a block, so the DSP objects are
+// only ever touched from the callback.
+struct PedalSettings
+{
+    int tremType;
+    int tremCrossover;
+    int tremStereo;
+    int tremWaveform;
+    int tremOscWaveform;
+    bool relayBypassEnabled;
+    int muteOffTimeMs;
+    int bypassToggleTimeMs;
+    int chainEffect[kNumChainSlots];
+    bool chainSlotOn[kNumChainSlots];
+
+    bool SameChain(const PedalSettings& other) const
+    {
+        for (size_t slot = 0; slot < kNumChainSlots; slot++)
+        {
+            if (chainEffect[slot] != other.chainEffect[slot] || chainSlotOn[slot] != other.chainSlotOn[slot])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const PedalSettings& other) const
+    {
+        return !SameChain(other)
+               || tremType != other.tremType
+               || tremCrossover != other.tremCrossover
+               || tremStereo != other.tremStereo
+               || tremWaveform != other.tremWaveform
+               || tremOscWaveform != other.tremOscWaveform
+               || relayBypassEnabled != other.relayBypassEnabled
+               || muteOffTimeMs != other.muteOffTimeMs
+               || bypassToggleTimeMs != other.bypassToggleTimeMs;
+    }
+};
+
+SpscQueue<PedalSettings, 4> settingsQueue;
+PedalSettings publishedSettings; // Main loop side
+PedalSettings audioSettings;     // Audio Callback side
+PedalSettings chainSettings;     // Audio Callback side, the chain running or fading in
+
+// Collects the current menu values.
+PedalSettings ReadMenuSettings()
+{
+    PedalSettings settings;
+    settings.tremType = tremTypeListMappedValues.GetIndex();
+    settings.tremCrossover = tremCrossoverValue.Get();
+    settings.tremStereo = tremStereoListMappedValues.GetIndex();
+    settings.tremWaveform = tremWaveformListMappedValues.GetIndex();
+    settings.tremOscWaveform = tremOscWaveformListMappedValues.GetIndex();
+    settings.relayBypassEnabled = relayBypassEnabled;
+    settings.muteOffTimeMs = muteOffTransitionTimeMs.Get();
+    settings.bypassToggleTimeMs = bypassToggleTransitionTimeMs.Get();
+    for (size_t slot = 0; slot < kNumChainSlots; slot++)
+    {
+        settings.chainEffect[slot] = chainSlotListMappedValues[slot].GetIndex();
+        settings.chainSlotOn[slot] = chainSlotOn[slot];
+    }
+    return settings;
+}
+
+// Applies settings to the effect, only call from the Audio Callback once audio is running.
+// Chain changes are picked up by UpdateEffectChain().
+void ApplySettings(const PedalSettings& settings)
+{
+    tremolo.SetMode(settings.tremType == 1 ? BlockTremolo::MODE_HARMONIC : BlockTremolo::MODE_SIMPLE);
+    tremolo.SetCrossover((float)settings.tremCrossover);
+    tremolo.SetStereoPhase(tremStereoPhases[settings.tremStereo]);
+    tremolo.SetWaveform(settings.tremWaveform);
+    freq_osc.SetWaveform(settings.tremOscWaveform);
+    muteRelay.SetTimes(settings.muteOffTimeMs * 0.001f, settings.bypassToggleTimeMs * 0.001f);
+    audioSettings = settings;
+}
+
+// Fills the chain slots, an effect already used by an earlier slot leaves the slot empty.
+void SetupChain(PedalChain& chain, const PedalSettings& settings)
+{
+    EffectBlock* const effects[CHAIN_EFFECT_LAST] = {nullptr, &overdrive, &tremolo, &delay};
+    bool used[CHAIN_EFFECT_LAST] = {};
+    for (size_t slot = 0; slot < kNumChainSlots; slot++)
+    {
+        int effect = settings.chainEffect[slot];
+        chain.SetSlot(slot, used[effect] ? nullptr : effects[effect]);
+        chain.SetBypass(slot, !settings.chainSlotOn[slot]);
+        used[effect] = effect != CHAIN_EFFECT_NONE;
+    }
+}
+
+// Fades over to a changed chain, called from the Audio Callback every block.  While a
+// fade is running, or if the new chain doesn't fit in the CPU budget, the change waits.
+void UpdateEffectChain(size_t blockSize)
+{
+    if (audioSettings.SameChain(chainSettings) || chainSwitcher.IsSwitching())
+    {
+        return;
+    }
+
+    PedalChain& running = chainSwitcher.Current() == &effectChains[0] ? effectChains[0] : effectChains[1];
+    PedalChain& next = &running == &effectChains[0] ? effectChains[1] : effectChains[0];
+    SetupChain(next, audioSettings);
+
+    if (chainSwitcher.Switch(&next, chainFadeTimeInSamples, next.SharesEffectsWith(running), blockSize)
+        != EffectSwitcher::SWITCH_REFUSED)
+    {
+        chainSettings = audioSettings;
+    }
+}
+
+// The menu settings are kept in QSPI flash and restored at power up.  Fields are only
+// ever added to the end of the preset, a record saved by older firmware fills in the
+// fields it has and the rest keep their defaults.  The version only changes if the
+// meaning of an existing field does.
+struct Preset
+{
+    uint8_t tremType;
+    uint8_t tremWaveform;
+    uint8_t tremOscWaveform;
+    uint8_t relayBypassEnabled;
+    uint8_t midiEnabled;
+    uint8_t chainEffect[kNumChainSlots];
+    uint8_t chainSlotOn[kNumChainSlots];
+    uint8_t tremCrossover; // In 10 Hz steps
+    uint8_t tremStereo;
+    uint8_t muteOffTimeMs;
+    uint8_t bypassToggleTimeMs;
+    uint8_t audioBlockSize;  // Index into audioBlockSizes
+    uint8_t audioSampleRate; // Index into audioSampleRates
+};
+
+const uint8_t  presetVersion = 1;
+const uint32_t presetFlashOffset = 0x7FC000; // The last 16kB of the 8MB QSPI flash
+const size_t   presetFlashSectors = 4;
+const uint32_t presetSaveDelayMs = 1000;     // Wait for the menus to settle before writing flash
+
+PresetStore presetStore;
+Preset      pendingPreset;   // Last menu state seen by the main loop
+Preset      savedPreset;     // Menu state in flash
+uint32_t    presetChangedMs;
+
+// Collects the menu values that are saved.
+Preset ReadPreset()
+{
+    Preset preset;
+    preset.tremType = tremTypeListMappedValues.GetIndex();
+    preset.tremWaveform = tremWaveformListMappedValues.GetIndex();
+    preset.tremOscWaveform = tremOscWaveformListMappedValues.GetIndex();
+    preset.relayBypassEnabled = relayBypassEnabled;
+    preset.midiEnabled = midiEnabled;
+    for (size_t slot = 0; slot < kNumChainSlots; slot++)
+    {
+        preset.chainEffect[slot] = chainSlotListMappedValues[slot].GetIndex();
+        preset.chainSlotOn[slot] = chainSlotOn[slot];
+    }
+    preset.tremCrossover = tremCrossoverValue.Get() / 10;
+    preset.tremStereo = tremStereoListMappedValues.GetIndex();
+    preset.muteOffTimeMs = muteOffTransitionTimeMs.Get();
+    preset.bypassToggleTimeMs = bypassToggleTransitionTimeMs.Get();
+    preset.audioBlockSize = audioBlockSizeListMappedValues.GetIndex();
+    preset.audioSampleRate = audioSampleRateListMappedValues.GetIndex();
+    return preset;
+}
+
+// Restores the saved menu values, the list values clamp out of range indices.
+void LoadPreset()
+{
+    presetStore.Init(&hardware.seed.qspi, presetFlashOffset, presetFlashSectors);
+
+    Preset preset = ReadPreset();
+    uint8_t version;
+    if (presetStore.Load(&preset, sizeof(preset), version) > 0 && version == presetVersion)
+    {
+        tremTypeListMappedValues.SetIndex(preset.tremType);
+        tremWaveformListMappedValues.SetIndex(preset.tremWaveform);
+        tremOscWaveformListMappedValues.SetIndex(preset.tremOscWaveform);
+        relayBypassEnabled = preset.relayBypassEnabled != 0;
+        midiEnabled = preset.midiEnabled != 0;
+        for (size_t slot = 0; slot < kNumChainSlots; slot++)
+        {
+            chainSlotListMappedValues[slot].SetIndex(preset.chainEffect[slot]);
+            chainSlotOn[slot] = preset.chainSlotOn[slot] != 0;
+        }
+        tremCrossoverValue.Set(preset.tremCrossover * 10);
+        tremStereoListMappedValues.SetIndex(preset.tremStereo);
+        muteOffTransitionTimeMs.Set(preset.muteOffTimeMs);
+        bypassToggleTransitionTimeMs.Set(preset.bypassToggleTimeMs);
+        audioBlockSizeListMappedValues.SetIndex(preset.audioBlockSize);
+        audioSampleRateListMappedValues.SetIndex(preset.audioSampleRate);
+    }
+
+    savedPreset = ReadPreset();
+    pendingPreset = savedPreset;
+    presetChangedMs = System::GetNow();
+}
+
+// Writes the menu values to flash once they have stopped changing, main loop only.
+void SavePresetWhenSettled()
+{
+    Preset preset = ReadPreset();
+    uint32_t now = System::GetNow();
+    if (memcmp(&preset, &pendingPreset, sizeof(preset)) != 0)
+    {
+        pendingPreset = preset;
+        presetChangedMs = now;
+    }
+    else if (memcmp(&preset, &savedPreset, sizeof(preset)) != 0
+             && now - presetChangedMs >= presetSaveDelayMs)
+    {
+        // If the write fails try again after another delay
+        if (presetStore.Save(&preset, sizeof(preset), presetVersion))
+        {
+            savedPreset = preset;
+        }
+        presetChangedMs = now;
+    }
+}
 
 /** This is the type of display we use on the patch. This is provided here for better readability. */
 using OledDisplayType = decltype(GuitarPedal125B::display);
@@ -113,8 +489,20 @@ void InitUiPages()
     mainMenuItems[0].asOpenUiPageItem.pageToOpen = &tremoloMenu;
 
     mainMenuItems[1].type = daisy::AbstractMenu::ItemType::openUiPageItem;
-    mainMenuItems[1].text = "Settings";
-    mainMenuItems[1].asOpenUiPageItem.pageToOpen = &globalSettingsMenu;
+    mainMenuItems[1].text = "Chain";
+    mainMenuItems[1].asOpenUiPageItem.pageToOpen = &chainMenu;
+
+    mainMenuItems[2].type = daisy::AbstractMenu::ItemType::openUiPageItem;
+    mainMenuItems[2].text = "Settings";
+    mainMenuItems[2].asOpenUiPageItem.pageToOpen = &globalSettingsMenu;
+
+    mainMenuItems[3].type = daisy::AbstractMenu::ItemType::openUiPageItem;
+    mainMenuItems[3].text = "CPU Load";
+    mainMenuItems[3].asOpenUiPageItem.pageToOpen = &cpuLoadPage;
+
+    mainMenuItems[4].type = daisy::AbstractMenu::ItemType::openUiPageItem;
+    mainMenuItems[4].text = "Audio";
+    mainMenuItems[4].asOpenUiPageItem.pageToOpen = &audioMenu;
 
     mainMenu.Init(mainMenuItems, kNumMainMenuItems);
 
@@ -137,11 +525,47 @@ void InitUiPages()
     tremoloMenuItems[2].asMappedValueItem.valueToModify
         = &tremOscWaveformListMappedValues;
 
-    tremoloMenuItems[3].type = daisy::AbstractMenu::ItemType::closeMenuItem;
-    tremoloMenuItems[3].text = "Back";
+    tremoloMenuItems[3].type = daisy::AbstractMenu::ItemType::valueItem;
+    tremoloMenuItems[3].text = "X-Over";
+    tremoloMenuItems[3].asMappedValueItem.valueToModify
+        = &tremCrossoverValue;
+
+    tremoloMenuItems[4].type = daisy::AbstractMenu::ItemType::valueItem;
+    tremoloMenuItems[4].text = "Stereo";
+    tremoloMenuItems[4].asMappedValueItem.valueToModify
+        = &tremStereoListMappedValues;
+
+    tremoloMenuItems[5].type = daisy::AbstractMenu::ItemType::openUiPageItem;
+    tremoloMenuItems[5].text = "Tempo";
+    tremoloMenuItems[5].asOpenUiPageItem.pageToOpen = &tempoPage;
+
+    tremoloMenuItems[6].type = daisy::AbstractMenu::ItemType::closeMenuItem;
+    tremoloMenuItems[6].text = "Back";
 
     tremoloMenu.Init(tremoloMenuItems, kNumTremoloMenuItems);
 
+    // ====================================================================
+    // The "Chain" menu, the effect in each slot followed by the slot on / off switches
+    // ====================================================================
+    static const char* chainSlotNames[kNumChainSlots] = {"Slot 1", "Slot 2", "Slot 3"};
+    static const char* chainSlotOnNames[kNumChainSlots] = {"Slot 1 On", "Slot 2 On", "Slot 3 On"};
+    for (size_t slot = 0; slot < kNumChainSlots; slot++)
+    {
+        chainMenuItems[slot].type = daisy::AbstractMenu::ItemType::valueItem;
+        chainMenuItems[slot].text = chainSlotNames[slot];
+        chainMenuItems[slot].asMappedValueItem.valueToModify
+            = &chainSlotListMappedValues[slot];
+
+        chainMenuItems[kNumChainSlots + slot].type = daisy::AbstractMenu::ItemType::checkboxItem;
+        chainMenuItems[kNumChainSlots + slot].text = chainSlotOnNames[slot];
+        chainMenuItems[kNumChainSlots + slot].asCheckboxItem.valueToModify = &chainSlotOn[slot];
+    }
+
+    chainMenuItems[2 * kNumChainSlots].type = daisy::AbstractMenu::ItemType::closeMenuItem;
+    chainMenuItems[2 * kNumChainSlots].text = "Back";
+
+    chainMenu.Init(chainMenuItems, kNumChainMenuItems);
+
     // ====================================================================
     // The "Global Settings" menu
     // ====================================================================
@@ -153,10 +577,57 @@ void InitUiPages()
     globalSettingsMenuItems[1].text = "Midi";
     globalSettingsMenuItems[1].asCheckboxItem.valueToModify = &midiEnabled;
 
-    globalSettingsMenuItems[2].type = daisy::AbstractMenu::ItemType::closeMenuItem;
-    globalSettingsMenuItems[2].text = "Back";
+    globalSettingsMenuItems[2].type = daisy::AbstractMenu::ItemType::valueItem;
+    globalSettingsMenuItems[2].text = "Mute Time";
+    globalSettingsMenuItems[2].asMappedValueItem.valueToModify = &muteOffTransitionTimeMs;
+
+    globalSettingsMenuItems[3].type = daisy::AbstractMenu::ItemType::valueItem;
+    globalSettingsMenuItems[3].text = "Relay Time";
+    globalSettingsMenuItems[3].asMappedValueItem.valueToModify = &bypassToggleTransitionTimeMs;
+
+    globalSettingsMenuItems[4].type = daisy::AbstractMenu::ItemType::closeMenuItem;
+    globalSettingsMenuItems[4].text = "Back";
 
     globalSettingsMenu.Init(globalSettingsMenuItems, kNumGlobalSettingsMenuItems);
+
+    // ====================================================================
+    // The "Audio" menu, the CPU Load page shows what a setting costs
+    // ====================================================================
+    audioMenuItems[0].type = daisy::AbstractMenu::ItemType::valueItem;
+    audioMenuItems[0].text = "Block Size";
+    audioMenuItems[0].asMappedValueItem.valueToModify = &audioBlockSizeListMappedValues;
+
+    audioMenuItems[1].type = daisy::AbstractMenu::ItemType::valueItem;
+    audioMenuItems[1].text = "Sample Rate";
+    audioMenuItems[1].asMappedValueItem.valueToModify = &audioSampleRateListMappedValues;
+
+    audioMenuItems[2].type = daisy::AbstractMenu::ItemType::openUiPageItem;
+    audioMenuItems[2].text = "CPU Load";
+    audioMenuItems[2].asOpenUiPageItem.pageToOpen = &cpuLoadPage;
+
+    audioMenuItems[3].type = daisy::AbstractMenu::ItemType::openUiPageItem;
+    audioMenuItems[3].text = "Latency";
+    audioMenuItems[3].asOpenUiPageItem.pageToOpen = &latencyPage;
+
+    audioMenuItems[4].type = daisy::AbstractMenu::ItemType::closeMenuItem;
+    audioMenuItems[4].text = "Back";
+
+    audioMenu.Init(audioMenuItems, kNumAudioMenuItems);
+
+    // ====================================================================
+    // The "CPU Load" page
+    // ====================================================================
+    cpuLoadPage.Init(&loadMeter, &hardware);
+
+    // ====================================================================
+    // The "Latency" page, runs the latency probe instead of the effects while it's open
+    // ====================================================================
+    latencyPage.Init(&latencyProbe);
+
+    // ====================================================================
+    // The "Tempo" page, also opens when the tempo is tapped
+    // ====================================================================
+    tempoPage.Init(&tapTempo, &midiClock);
 }
 
 void GenerateUiEvents()
@@ -178,180 +649,472 @@ int GetNumberOfSamplesForTime(float time)
     return (int)(hardware.AudioSampleRate() * time);
 }
 
-static void AudioCallback(AudioHandle::InputBuffer  in,
-                     AudioHandle::OutputBuffer out,
-                     size_t                    size)
+// Sets the Tremolo frequency from the rate and the frequency modulation.
+void UpdateTremoloFreq()
 {
-    // Handle Inputs
-    hardware.ProcessAnalogControls();
-    hardware.ProcessDigitalControls();
+    midiClock.SetDivision((MidiClockSync::Division)(tremRate * (MidiClockSync::DIVISION_LAST - 1) + 0.5f));
+    if (midiClock.Running())
+    {
+        return;
+    }
 
-    GenerateUiEvents();
+    if (tapTempo.Active())
+    {
+        tremolo.SetFreq(tapTempo.CycleFreq());
+        return;
+    }
 
-    // Handle knobs Tremolo
     float tremFreqMin = 1.0f;
-    float tremFreqMax = hardware.knobs[0].Process() * 20.f; //0 - 20 Hz
-    treml.SetDepth(hardware.knobs[1].Process());
-    tremr.SetDepth(hardware.knobs[1].Value());
-    float knob2Value = osc_freq_knob.Process();
-    float freq_osc_min = 0.01f;
-    freq_osc.SetFreq(freq_osc_min + (knob2Value * 3.0f)); //0 - 20 Hz
-    float mod = freq_osc.Process();
+    float tremFreqMax = tremRate * 20.f; //0 - 20 Hz
+    tremolo.SetFreq(tremFreqMin + tremFreqMax * tremRateMod);
+}
+
+// Scans the controls, called from the control timer at the control rate.
+void ScanControls()
+{
+    hardware.ProcessDigitalControls();
 
-    if (knob2Value < 0.01) {
-        mod = 1.0f;
+    // Stamp footswitch changes here, the main loop stalls for as long as a flash erase
+    // takes.  They are stamped with the sample position the audio is at when the scan
+    // sees them and take effect one block later, at the same offset.
+    const uint32_t switchSample = sampleClock.Now() + sampleClock.BlockSize();
+    for (size_t i = 0; i < GuitarPedal125B::SWITCH_LAST; i++)
+    {
+        switchTimestamps.Poll(i, hardware.switches[i].RawState(), switchSample);
     }
 
-    treml.SetFreq(tremFreqMin + tremFreqMax * mod); 
-    tremr.SetFreq(tremFreqMin + tremFreqMax * mod);
+    // The knob front end reads the ADC, averages the readings and debounces them
+    hardware.ProcessAnalogControls();
 
-    //If the First Footswitch button is pressed, toggle the effect enabled
-    bool oldEffectOn = effectOn;
-    effectOn ^= hardware.switches[0].RisingEdge();
+    GenerateUiEvents();
 
-    // Handle updating the Hardware Bypass & Muting signals
-    if (relayBypassEnabled)
+    ControlValues values;
+    for (size_t i = 0; i < GuitarPedal125B::KNOB_LAST; i++)
     {
-        hardware.SetAudioBypass(bypassOn);
-        hardware.SetAudioMute(muteOn);
+        values.knobs[i] = hardware.knobs.Value(i);
+        values.versions[i] = hardware.knobs.Version(i);
     }
-    else 
+    values.version = hardware.knobs.Version();
+
+    // The rate modulation knob is on an exponential curve
+    values.knobs[2] = values.knobs[2] * values.knobs[2];
+
+    // Replaces a reading the Audio Callback hasn't picked up yet, it only wants the newest
+    publishedControls.Write(values);
+}
+
+// Returns true once for every new value of a knob, Audio Callback side.
+bool KnobChanged(const ControlValues& controls, size_t knob)
+{
+    if (appliedKnobVersions[knob] == controls.versions[knob])
     {
-        hardware.SetAudioBypass(false);
-        hardware.SetAudioMute(false);
+        return false;
     }
+    appliedKnobVersions[knob] = controls.versions[knob];
+    return true;
+}
 
-    // Handle Effect State being Toggled.
-    if (effectOn != oldEffectOn)
+// Maps the knobs onto the Tremolo, called at the control rate.
+void UpdateTremoloControls(const ControlValues& controls, size_t rampSamples)
+{
+    // While nobody touches a knob only the rate modulation below has anything to do
+    bool rateChanged = false;
+    bool oscFreqChanged = false;
+    if (controls.version != appliedKnobsVersion)
     {
-        // Start the timing sequence for the Hardware Mute and Relay Bypass.
-        if (relayBypassEnabled)
+        appliedKnobsVersion = controls.version;
+
+        if (KnobChanged(controls, 1))
+        {
+            tremolo.SetDepth(controls.knobs[1], rampSamples);
+        }
+
+        rateChanged = KnobChanged(controls, 0);
+        if (rateChanged)
+        {
+            tremRate = controls.knobs[0];
+            if (fabsf(tremRate - tapRateKnob) > tapKnobTakeover)
+            {
+                tapTempo.Cancel();
+            }
+        }
+
+        oscFreqChanged = KnobChanged(controls, 2);
+        float freq_osc_min = 0.01f;
+
+        if (oscFreqChanged)
         {
-            // Immediately Mute the Output using the Hardware Mute.
-            muteOn = true;
+            freq_osc.SetFreq(freq_osc_min + (controls.knobs[2] * 3.0f));
+        }
 
-            // Set the timing for when the bypass relay should trigger and when to unmute.
-            samplesTilMuteOff = muteOffTransitionTimeInSamples;
-            samplesTilBypassToggle = bypassToggleTransitionTimeInSamples;
+        // Overdrive drive on knob 4, delay time and feedback on knobs 5 and 6
+        if (KnobChanged(controls, 3))
+        {
+            overdrive.SetDrive(controls.knobs[3], rampSamples);
+        }
+
+        if (KnobChanged(controls, 4))
+        {
+            delay.SetTime(0.05f + controls.knobs[4] * 0.95f, rampSamples);
+        }
+
+        if (KnobChanged(controls, 5))
+        {
+            delay.SetFeedback(controls.knobs[5] * 0.9f);
         }
     }
 
-    // Process Audio
-    for(size_t i = 0; i < size; i++)
+    // The Tremolo frequency only needs recalculating while it's being modulated or when a knob moved
+    bool modulating = controls.knobs[2] >= 0.01f;
+    if (modulating || rateChanged || oscFreqChanged)
     {
-        // Handle Timing for the Hardware Mute and Relay Bypass
-        if (muteOn) {
-            // Decrement the Sample Counts for the timing of the mute and bypass
-            samplesTilMuteOff -= 1;
-            samplesTilBypassToggle -= 1;
+        tremRateMod = modulating ? freq_osc.Process() : 1.0f;
+        UpdateTremoloFreq();
+    }
+}
 
-            // If mute time is up, turn it off.
-            if (samplesTilMuteOff < 0) {
-                muteOn = false;
-            }
+// Applies a MIDI mapped parameter change, called from the Audio Callback at the sample it is due.
+void ApplyMidiParam(const ParamEvent& event)
+{
+    switch(event.param)
+    {
+        case MIDI_PARAM_TREM_RATE:
+            tremRate = event.value;
+            tapTempo.Cancel();
+            UpdateTremoloFreq();
+            break;
+        case MIDI_PARAM_TREM_DEPTH:
+            tremolo.SetDepth(event.value, controlRate.RampSamples());
+            break;
+        case MIDI_PARAM_TREM_WAVEFORM:
+            tremolo.SetWaveform((int)(event.value * 4.0f + 0.5f)); // Sine, Triangle, Saw, Ramp, Square
+            break;
+        case MIDI_PARAM_BYPASS:
+            effectOn = event.value < 0.5f;
+            break;
+        default: break;
+    }
+}
 
-            // Toggle the bypass when it's time (needs to be timed to happen while things are muted, or you get an audio pop)
-            if (samplesTilBypassToggle < 0) {
-                bypassOn = !effectOn;
-            }
-        }
+// Applies a footswitch press or release, called from the Audio Callback at the sample it is due.
+void ApplySwitchEvent(const SwitchEvent& event)
+{
+    // The First Footswitch toggles the effect enabled
+    if (event.index == GuitarPedal125B::SWITCH_1 && event.pressed)
+    {
+        effectOn = !effectOn;
+    }
+
+    // The Second Footswitch taps the tempo, unless the Tremolo follows MIDI clock
+    if (event.index == GuitarPedal125B::SWITCH_2 && event.pressed && !midiClock.Running())
+    {
+        tapTempo.Tap(event.sample);
+        tapRateKnob = latestControls.knobs[0];
+    }
+}
+
+// Starts a tapped tempo with a new cycle, called from the Audio Callback on the beat.
+void ApplyTempoBeat()
+{
+    tapTempo.ApplyBeat();
+    if (!midiClock.Running())
+    {
+        tremolo.ResetPhase(0.0f);
+        UpdateTremoloFreq();
+    }
+}
 
+// Processes part of the block with the current effect settings.
+void ProcessAudio(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t start, size_t count)
+{
+    const float* segmentIn[2] = {in[0] + start, in[1] + start};
+    float* segmentOut[2] = {out[0] + start, out[1] + start};
+
+    if(effectOn)
+    {
+        // Run the effect chain, the LED follows the last effect, so it pulses with a Tremolo at the end
+        led1Brightness = 1.0f;
+        led2Brightness = chainSwitcher.Process(segmentIn, segmentOut, 2, count);
+    }
+    else
+    {
         // By default the Effect is Bypassed and Output == Input and the led is off
-        out[0][i] = in[0][i];
-        out[1][i] = in[1][i];
+        CopyBlock(segmentOut[0], segmentIn[0], count);
+        CopyBlock(segmentOut[1], segmentIn[1], count);
         led1Brightness = 0.0f;
         led2Brightness = 0.0f;
+    }
+}
+
+static void AudioCallback(AudioHandle::InputBuffer  in,
+                     AudioHandle::OutputBuffer out,
+                     size_t                    size)
+{
+    loadMeter.OnBlockStart();
+    sampleClock.OnBlockStart(size);
+
+    // Apply any settings changed from the menus
+    PedalSettings settings;
+    if (settingsQueue.PopLatest(settings))
+    {
+        ApplySettings(settings);
+    }
+    UpdateEffectChain(size);
+
+    // Pick up the newest knob readings from the control task
+    publishedControls.Read(latestControls);
+
+    // Measuring the latency, the markers go straight out with the relay and mute off
+    if (latencyPage.IsActive())
+    {
+        hardware.SetAudioBypass(false);
+        hardware.SetAudioMute(false);
+        latencyProbe.Process(in[0], out[0], size);
+        FillBlock(out[1], 0.0f, size);
+        loadMeter.OnBlockEnd();
+        return;
+    }
+
+    // Follow MIDI clock while it's running
+    bool synced = midiClock.Update(sampleClock.BlockStart());
+
+    // Update the Tremolo at the control rate, independent of the block size
+    if (controlRate.Tick(size))
+    {
+        UpdateTremoloControls(latestControls, controlRate.RampSamples());
+    }
+
+    if (synced)
+    {
+        tremolo.SyncPhase(midiClock.CycleFreq(), midiClock.CyclePhase(sampleClock.BlockStart()));
+    }
+    else if (tremSynced)
+    {
+        // The clock stopped, back to the rate knob
+        UpdateTremoloFreq();
+    }
+    tremSynced = synced;
+
+    bool oldEffectOn = effectOn;
+    size_t toggleOffset = 0;
+
+    // Handle updating the Hardware Bypass & Muting signals
+    if (audioSettings.relayBypassEnabled)
+    {
+        hardware.SetAudioBypass(muteRelay.BypassOn());
+        hardware.SetAudioMute(muteRelay.MuteOn());
+    }
+    else 
+    {
+        hardware.SetAudioBypass(false);
+        hardware.SetAudioMute(false);
+    }
+
+    // Process Audio, split at the sample positions of any MIDI parameter changes, footswitch
+    // presses and the beat a tapped tempo starts on.  On the same sample MIDI goes first.
+    ParamEvent midiEvent;
+    SwitchEvent switchEvent;
+    size_t midiOffset, switchOffset, beatOffset;
+    size_t processed = 0;
+    bool midiDue = midiParamMap.PopDueEvent(sampleClock.BlockStart(), size, midiEvent, midiOffset);
+    bool switchDue = switchTimestamps.PopDueEvent(sampleClock.BlockStart(), size, switchEvent, switchOffset);
+    bool beatDue = tapTempo.NextBeat(sampleClock.BlockStart(), size, beatOffset);
+    while (midiDue || switchDue || beatDue)
+    {
+        bool midiFirst = midiDue && (!switchDue || midiOffset <= switchOffset) && (!beatDue || midiOffset <= beatOffset);
+        bool switchFirst = !midiFirst && switchDue && (!beatDue || switchOffset <= beatOffset);
+        size_t offset = midiFirst ? midiOffset : (switchFirst ? switchOffset : beatOffset);
+        if (offset > processed)
+        {
+            ProcessAudio(in, out, processed, offset - processed);
+            processed = offset;
+        }
+
+        bool wasOn = effectOn;
+        if (midiFirst)
+        {
+            ApplyMidiParam(midiEvent);
+            midiDue = midiParamMap.PopDueEvent(sampleClock.BlockStart(), size, midiEvent, midiOffset);
+        }
+        else if (switchFirst)
+        {
+            ApplySwitchEvent(switchEvent);
+            switchDue = switchTimestamps.PopDueEvent(sampleClock.BlockStart(), size, switchEvent, switchOffset);
+        }
+        else
+        {
+            ApplyTempoBeat();
+        }
+        beatDue = tapTempo.NextBeat(sampleClock.BlockStart(), size, beatOffset);
+        toggleOffset = effectOn != wasOn ? offset : toggleOffset;
+    }
+    ProcessAudio(in, out, processed, size - processed);
 
-        if(effectOn)
+    // Handle Effect State being Toggled, by the footswitch or MIDI.
+    if (effectOn != oldEffectOn)
+    {
+        // Start the timing sequence for the Hardware Mute and Relay Bypass.
+        if (audioSettings.relayBypassEnabled)
         {
-            // Apply the Tremolo Effect and modulate the LED at the frequency of the Tremolo
-            led1Brightness = 1.0f;
-            led2Brightness = treml.Process(1.0f);
-            out[0][i] = in[0][i] * led2Brightness;
-            out[1][i] = tremr.Process(in[1][i]);
+            // Immediately Mute the Output using the Hardware Mute, then toggle the bypass
+            // while muted (or you get an audio pop) and unmute, counted from the sample
+            // the effect was toggled at.
+            muteRelay.Start(sampleClock.BlockStart() + toggleOffset, !effectOn);
         }
     }
 
+    // Handle Timing for the Hardware Mute and Relay Bypass, only the blocks a deadline
+    // falls into have anything to do.  The outputs are written at the next block start.
+    while (muteRelay.NextChange(sampleClock.BlockStart(), size))
+    {
+        muteRelay.ApplyChange();
+    }
+
     // Handle LEDs
     hardware.SetLed((GuitarPedal125B::LedIndex)0, led1Brightness);
     hardware.SetLed((GuitarPedal125B::LedIndex)1, led2Brightness);
     hardware.UpdateLeds();
+
+    loadMeter.OnBlockEnd();
 }
 
-// Typical Switch case for Message Type.
-void HandleMidiMessage(MidiEvent m)
+// Clock and transport messages drive the tempo sync, mapped Control Changes are scheduled
+// for the Audio Callback, other messages are ignored.
+void HandleMidiMessage(const MidiEvent& m)
 {
-    switch(m.type)
+    if (!midiClock.HandleMidiEvent(m))
     {
-        case NoteOn:
-        {
-            NoteOnEvent p = m.AsNoteOn();
-            char        buff[512];
-            sprintf(buff,
-                    "Note Received:\t%d\t%d\t%d\r\n",
-                    m.channel,
-                    m.data[0],
-                    m.data[1]);
-            //hareware.seed.usb_handle.TransmitInternal((uint8_t *)buff, strlen(buff));
-            // This is to avoid Max/MSP Note outs for now..
-            if(m.data[1] != 0)
-            {
-                p = m.AsNoteOn();
-                //led2Brightness = ((float)p.velocity / 127.0f);
-                //osc.SetFreq(mtof(p.note));
-                //osc.SetAmp((p.velocity / 127.0f));
-            }
-        }
-        break;
-        case ControlChange:
-        {
-            ControlChangeEvent p = m.AsControlChange();
-            switch(p.control_number)
-            {
-                case 1:
-                    // CC 1 for cutoff.
-                    //filt.SetFreq(mtof((float)p.value));
-                    break;
-                case 2:
-                    // CC 2 for res.
-                    //filt.SetRes(((float)p.value / 127.0f));
-                    break;
-                default: 
-                    //led2Brightness = ((float)p.value / 127.0f);
-                break;
-            }
-            break;
-        }
-        default: break;
+        midiParamMap.HandleMidiEvent(m);
     }
 }
 
-int main(void)
+// Sets up everything that depends on the sample rate or the block size and applies the
+// menu settings.  Only call while the audio is stopped.
+void InitAudio(const PedalSettings& settings)
 {
-    hardware.Init();
-    hardware.SetAudioBlockSize(4);
-
     float sample_rate = hardware.AudioSampleRate();
 
+    // Measure the Audio Callback against the time available per block
+    loadMeter.Init(hardware.AudioCallbackRate());
+    latencyProbe.Init(sample_rate);
+
+    // The frequency modulation oscillator runs at the rate the Audio Callback updates the Tremolo
+    controlRate.Init(sample_rate, controlUpdateRate);
+    float control_rate = controlRate.UpdateRate(hardware.AudioBlockSize());
+
+    // Apply every knob again on the first control update
+    appliedKnobsVersion = 0;
+    for (size_t i = 0; i < GuitarPedal125B::KNOB_LAST; i++)
+    {
+        appliedKnobVersions[i] = 0;
+    }
+
+    // Timestamp MIDI parameter changes against the audio
+    sampleClock.Init(sample_rate);
+    midiParamMap.Init(midiCcMappings, sizeof(midiCcMappings) / sizeof(midiCcMappings[0]), &sampleClock);
+    midiClock.Init(sample_rate, &sampleClock);
+    switchTimestamps.Init(GuitarPedal125B::SWITCH_LAST, sample_rate);
+    tapTempo.Init(sample_rate);
+
+    // Time the mute and relay, ApplySettings() sets the times from the menu
+    muteRelay.Init(sample_rate, settings.muteOffTimeMs * 0.001f, settings.bypassToggleTimeMs * 0.001f);
+
     // Set the number of samples to use for the crossfade based on the hardware sample rate
-    muteOffTransitionTimeInSamples = GetNumberOfSamplesForTime(muteOffTransitionTimeInSeconds);
-    bypassToggleTransitionTimeInSamples = GetNumberOfSamplesForTime(bypassToggleTransitionTimeInSeconds);
+    chainFadeTimeInSamples = GetNumberOfSamplesForTime(chainFadeTimeInSeconds);
+
+    tremolo.Init(sample_rate);
+    overdrive.Init();
+    float* delayBuffers[2] = {delayBuffer[0], delayBuffer[1]};
+    delay.Init(sample_rate, delayBuffers, 2, delayBufferLength);
+    effectChains[0].Init();
+    effectChains[1].Init();
+    freq_osc.Init(control_rate);
+    freq_osc.SetFreq(osc_freq);
+
+    ApplySettings(settings);
+    chainSettings = settings;
+    SetupChain(effectChains[0], chainSettings);
+    chainSwitcher.Init(&loadMeter, &effectChains[0]);
+}
+
+// Switches to the block size and sample rate chosen in the Audio menu, main loop only.
+// The output is muted while the audio is stopped and for the mute time after it starts
+// again, so the restart doesn't pop.
+void RestartAudio()
+{
+    hardware.SetAudioMute(true);
+    hardware.StopAudio();
+
+    // The control task stamps the footswitches against the sample clock, hold it while
+    // both start over
+    controlTask.Stop();
+
+    runningBlockSizeIndex = audioBlockSizeListMappedValues.GetIndex();
+    runningSampleRateIndex = audioSampleRateListMappedValues.GetIndex();
+    hardware.SetAudioSampleRate(audioSampleRates[runningSampleRateIndex]);
+    hardware.SetAudioBlockSize(audioBlockSizes[runningBlockSizeIndex]);
+
+    // Audio is stopped, so the settings can be applied directly
+    PedalSettings settings;
+    while (settingsQueue.Pop(settings))
+    {
+    }
+    publishedSettings = ReadMenuSettings();
+    InitAudio(publishedSettings);
+    muteRelay.Start(0, !effectOn);
+
+    controlTask.Start();
+    hardware.StartAudio(AudioCallback);
+}
+
+// Restarts the audio once the Audio menu has stopped changing, main loop only.
+void RestartAudioWhenSettled()
+{
+    uint32_t now = System::GetNow();
+    if (audioBlockSizeListMappedValues.GetIndex() == runningBlockSizeIndex
+        && audioSampleRateListMappedValues.GetIndex() == runningSampleRateIndex)
+    {
+        audioMenuChangedMs = now;
+    }
+    else if (now - audioMenuChangedMs >= audioRestartDelayMs)
+    {
+        RestartAudio();
+    }
+}
+
+// Initializes the hardware, UI and the effect, then starts the audio callback.
+void InitPedal()
+{
+    hardware.Init();
+
+    // Scan the controls from a timer at a fixed control rate, the knob front end averages
+    // the readings over that many scans.
+    controlTask.Init(controlUpdateRate, ScanControls);
+    hardware.knobs.Init(knobDeadBand);
 
     InitUi();
     InitUiPages();
     ui.OpenPage(mainMenu);
     UI::SpecialControlIds ids;
 
-    treml.Init(sample_rate);
-    tremr.Init(sample_rate);
     osc_freq = 0.0f;
-    freq_osc.Init(sample_rate);
-    freq_osc.SetAmp(1.0f);
-    freq_osc.SetFreq(osc_freq);
-    osc_freq_knob.Init(hardware.knobs[2], 0.0, 1.0f, Parameter::Curve::EXPONENTIAL);
+
+    // Restore the saved menu settings, including the block size and sample rate. Audio
+    // isn't running yet, so they can be applied directly.
+    LoadPreset();
+    runningBlockSizeIndex = audioBlockSizeListMappedValues.GetIndex();
+    runningSampleRateIndex = audioSampleRateListMappedValues.GetIndex();
+    audioMenuChangedMs = System::GetNow();
+    hardware.SetAudioSampleRate(audioSampleRates[runningSampleRateIndex]);
+    hardware.SetAudioBlockSize(audioBlockSizes[runningBlockSizeIndex]);
+    publishedSettings = ReadMenuSettings();
+    InitAudio(publishedSettings);
  
-    // start callback
+    // start callback, with a first set of control readings ready for it
     hardware.StartAdc();
+    ScanControls();
+    publishedControls.Read(latestControls);
+    controlTask.Start();
     hardware.StartAudio(AudioCallback);
     hardware.midi.StartReceive();
 
@@ -361,26 +1124,56 @@ int main(void)
     midiData[1] = 0b00001010;
     midiData[2] = 0b01111111;
     hardware.midi.SendMessage(midiData, sizeof(uint8_t) * 3);
+}
 
-    while(1)
+// A single pass of the main loop, everything here runs outside the audio callback.
+void ProcessMainLoop()
+{
+    // Show the tempo when it's tapped, unless a measurement is running
+    if (tapTempo.TapCount() != shownTapCount)
+    {
+        shownTapCount = tapTempo.TapCount();
+        if (!tempoPage.IsActive() && !latencyPage.IsActive())
+        {
+            ui.OpenPage(tempoPage);
+        }
+    }
+
+    // Handle UI
+    ui.Process();
+
+    // Hand changed menu settings to the Audio Callback, if the queue is full try again next time around
+    PedalSettings settings = ReadMenuSettings();
+    if (settings != publishedSettings && settingsQueue.Push(settings))
     {
-        // Handle UI
-        ui.Process();
+        publishedSettings = settings;
+    }
 
-        // Handle Updaing Settings from Menus
-        treml.SetWaveform(tremWaveformListMappedValues.GetIndex());
-        tremr.SetWaveform(tremWaveformListMappedValues.GetIndex());
-        freq_osc.SetWaveform(tremOscWaveformListMappedValues.GetIndex());
+    SavePresetWhenSettled();
 
-        // Handle MIDI Events
-        if (midiEnabled)
-        {
-            hardware.midi.Listen();
+    RestartAudioWhenSettled();
 
-            while(hardware.midi.HasEvents())
-            {
-                HandleMidiMessage(hardware.midi.PopEvent());
-            }
+    // Handle MIDI Events
+    if (midiEnabled)
+    {
+        hardware.midi.Listen();
+
+        while(hardware.midi.HasEvents())
+        {
+            HandleMidiMessage(hardware.midi.PopEvent());
         }
     }
 }
+
+// The HostRender tools provide their own main and drive the two functions above.
+#ifndef GUITAR_PEDAL_HOST_RENDER
+int main(void)
+{
+    InitPedal();
+
+    while(1)
+    {
+        ProcessMainLoop();
+    }
+}
+#endif
@@ -0,0 +1,70 @@
+#include "latency_page.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+bool LatencyPage::OnOkayButton(uint8_t numberOfPresses, bool isRetriggering)
+{
+    if(numberOfPresses == 1 && !isRetriggering)
+    {
+        Close();
+    }
+    return true;
+}
+
+bool LatencyPage::OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution)
+{
+    // Nothing to navigate on this page
+    return true;
+}
+
+void LatencyPage::OnShow()
+{
+    if(probe_ == nullptr)
+        return;
+
+    probe_->Reset();
+    active_.store(true, std::memory_order_release);
+}
+
+void LatencyPage::OnHide()
+{
+    active_.store(false, std::memory_order_release);
+}
+
+void LatencyPage::DrawLatency(MyOledDisplay& display, uint8_t y, const char* label, float samples)
+{
+    // Whole samples and microseconds, printf on the Daisy Seed has no float support.
+    unsigned us = (unsigned)(samples * 1000000.0f / probe_->SampleRate() + 0.5f);
+    char     line[32];
+    sprintf(line, "%s %4u smp %5uus", label, (unsigned)(samples + 0.5f), us);
+    display.SetCursor(0, y);
+    display.WriteString(line, Font_6x8, true);
+}
+
+void LatencyPage::Draw(const UiCanvasDescriptor& canvas)
+{
+    MyOledDisplay& display = *((MyOledDisplay*)(canvas.handle_));
+
+    display.SetCursor(0, 0);
+    display.WriteString("Latency", Font_7x10, true);
+
+    if(probe_ == nullptr)
+        return;
+
+    char line[32];
+    sprintf(line, "Got %lu Lost %lu", (unsigned long)probe_->Count(), (unsigned long)probe_->Timeouts());
+    display.SetCursor(0, 14);
+    display.WriteString(line, Font_6x8, true);
+
+    if(probe_->Count() == 0)
+    {
+        display.SetCursor(0, 34);
+        display.WriteString("Patch Out to In", Font_6x8, true);
+        return;
+    }
+
+    DrawLatency(display, 34, "Min", (float)probe_->MinSamples());
+    DrawLatency(display, 44, "Avg", probe_->AvgSamples());
+    DrawLatency(display, 54, "Max", (float)probe_->MaxSamples());
+}
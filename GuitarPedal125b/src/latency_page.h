@@ -0,0 +1,43 @@
+#pragma once
+#ifndef LATENCY_PAGE_H
+#define LATENCY_PAGE_H /**< & */
+
+#include <atomic>
+#include "guitar_pedal_125b.h"
+#include "latency_probe.h"
+
+namespace bkshepherd {
+
+/**
+   @brief OLED page that measures the round trip latency with a LatencyProbe.
+
+   Patch the output to the input before opening the page.  While it is open the Audio
+   Callback runs the probe instead of the effects, the page shows the number of markers
+   that came back and the min / avg / max latency in samples and microseconds.  Press the
+   encoder to close the page and go back to the effects.
+*/
+class LatencyPage : public UiPage
+{
+  public:
+    /** Initialize the page
+    \param probe Probe run by the Audio Callback while the page is open
+    */
+    void Init(LatencyProbe* probe) { probe_ = probe; }
+
+    /** Returns true while the page is open and the probe should run */
+    bool IsActive() const { return active_.load(std::memory_order_acquire); }
+
+    bool OnOkayButton(uint8_t numberOfPresses, bool isRetriggering) override;
+    bool OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution) override;
+    void OnShow() override;
+    void OnHide() override;
+    void Draw(const UiCanvasDescriptor& canvas) override;
+
+  private:
+    void DrawLatency(MyOledDisplay& display, uint8_t y, const char* label, float samples);
+
+    LatencyProbe*     probe_ = nullptr;
+    std::atomic<bool> active_{false};
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,61 @@
+#include "oled_ssd130x_dma.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+void SSD130x4WireSpiDmaTransport::Init(const Config& config)
+{
+    // Same SPI setup as libDaisy's SSD130x4WireSpiTransport
+    SpiHandle::Config spi_config;
+    spi_config.periph         = SpiHandle::Config::Peripheral::SPI_1;
+    spi_config.mode           = SpiHandle::Config::Mode::MASTER;
+    spi_config.direction      = SpiHandle::Config::Direction::TWO_LINES_TX_ONLY;
+    spi_config.datasize       = 8;
+    spi_config.clock_polarity = SpiHandle::Config::ClockPolarity::LOW;
+    spi_config.clock_phase    = SpiHandle::Config::ClockPhase::ONE_EDGE;
+    spi_config.nss            = SpiHandle::Config::NSS::HARD_OUTPUT;
+    spi_config.baud_prescaler = SpiHandle::Config::BaudPrescaler::PS_8;
+    spi_config.pin_config.sclk = seed::D8;
+    spi_config.pin_config.miso = Pin();
+    spi_config.pin_config.mosi = seed::D10;
+    spi_config.pin_config.nss  = seed::D7;
+    spi_.Init(spi_config);
+
+    pinDc_.Init(config.pin_config.dc, GPIO::Mode::OUTPUT);
+    pinReset_.Init(config.pin_config.reset, GPIO::Mode::OUTPUT);
+
+    // Reset the display
+    pinReset_.Write(false);
+    System::Delay(10);
+    pinReset_.Write(true);
+    System::Delay(10);
+
+    busy_ = false;
+}
+
+void SSD130x4WireSpiDmaTransport::SendCommand(uint8_t cmd)
+{
+    pinDc_.Write(false);
+    spi_.BlockingTransmit(&cmd, 1);
+}
+
+bool SSD130x4WireSpiDmaTransport::SendDataDma(uint8_t* buff, size_t size)
+{
+    if(busy_)
+        return false;
+
+    busy_ = true;
+    pinDc_.Write(true);
+    if(spi_.DmaTransmit(buff, size, nullptr, DmaComplete, this) != SpiHandle::Result::OK)
+    {
+        busy_ = false;
+        return false;
+    }
+    return true;
+}
+
+void SSD130x4WireSpiDmaTransport::DmaComplete(void* context, SpiHandle::Result result)
+{
+    (void)result;
+    static_cast<SSD130x4WireSpiDmaTransport*>(context)->busy_ = false;
+}
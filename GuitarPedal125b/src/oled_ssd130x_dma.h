@@ -0,0 +1,218 @@
+#pragma once
+#ifndef OLED_SSD130X_DMA_H
+#define OLED_SSD130X_DMA_H /**< & */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "daisy_seed.h"
+
+namespace bkshepherd {
+
+/**
+   @brief 4 Wire SPI transport for SSD130x displays that sends framebuffer data with DMA.
+
+   Commands are short and are sent blocking, data is handed to the SPI DMA and the
+   transport stays busy until the completion callback fires.
+*/
+class SSD130x4WireSpiDmaTransport
+{
+  public:
+    struct Config
+    {
+        struct
+        {
+            daisy::Pin dc;    /**< Data / Command select */
+            daisy::Pin reset; /**< Display reset */
+        } pin_config;
+    };
+
+    SSD130x4WireSpiDmaTransport() {}
+    ~SSD130x4WireSpiDmaTransport() {}
+
+    /** Sets up SPI 1 and the control pins, then resets the display */
+    void Init(const Config& config);
+
+    /** Sends a single command byte, blocking */
+    void SendCommand(uint8_t cmd);
+
+    /** Starts sending data with DMA, the buffer must be in DMA_BUFFER_MEM_SECTION memory
+    \return false if the previous transfer hasn't finished yet
+    */
+    bool SendDataDma(uint8_t* buff, size_t size);
+
+    /** Returns true while a DMA transfer is in progress */
+    bool IsBusy() const { return busy_; }
+
+#ifdef GUITAR_PEDAL_HOST_RENDER
+    /** Host only: total bytes pushed over SPI since Init */
+    size_t BytesSent() const { return spi_.HostBytesSent(); }
+#endif
+
+  private:
+    static void DmaComplete(void* context, daisy::SpiHandle::Result result);
+
+    daisy::SpiHandle spi_;
+    daisy::GPIO      pinDc_;
+    daisy::GPIO      pinReset_;
+    volatile bool    busy_ = false;
+};
+
+/**
+   @brief SSD130x driver that only sends the pages that changed, without blocking.
+
+   Drop in replacement for libDaisy's SSD130xDriver for use with OledDisplay.  Drawing
+   goes into a framebuffer in normal RAM.  Update() compares it page by page (8 pixel
+   rows) against the copy the display is showing, copies the changed span of pages into
+   the DMA buffer and starts the transfer, then returns straight away.  If the previous
+   transfer is still running the frame is skipped, the next Update() sends the newest.  If
+   a transfer fails to start the whole frame is sent again on the next Update().
+
+   \tparam width Display width in pixels
+   \tparam height Display height in pixels, a multiple of 8
+*/
+template <size_t width, size_t height>
+class SSD130xDmaDriver
+{
+  public:
+    static constexpr size_t kNumPages = height / 8;
+    static constexpr size_t kBufferSize = width * kNumPages;
+
+    struct Config
+    {
+        SSD130x4WireSpiDmaTransport::Config transport_config;
+        uint8_t* dma_buffer = nullptr; /**< kBufferSize bytes in DMA_BUFFER_MEM_SECTION memory */
+    };
+
+    void Init(Config config)
+    {
+        dmaBuffer_ = config.dma_buffer;
+        transport_.Init(config.transport_config);
+
+        // Display Off
+        transport_.SendCommand(0xAE);
+        // Display Clock Divide Ratio
+        transport_.SendCommand(0xD5);
+        transport_.SendCommand(0x80);
+        // Multiplex Ratio
+        transport_.SendCommand(0xA8);
+        transport_.SendCommand(height - 1);
+        // COM Pins
+        transport_.SendCommand(0xDA);
+        transport_.SendCommand(height == 64 ? 0x12 : 0x02);
+        // Display Offset
+        transport_.SendCommand(0xD3);
+        transport_.SendCommand(0x00);
+        // Start Line Address
+        transport_.SendCommand(0x40);
+        // Horizontal Addressing, so a span of pages goes out as one transfer
+        transport_.SendCommand(0x20);
+        transport_.SendCommand(0x00);
+        // Normal Display
+        transport_.SendCommand(0xA6);
+        // All On Resume
+        transport_.SendCommand(0xA4);
+        // Charge Pump
+        transport_.SendCommand(0x8D);
+        transport_.SendCommand(0x14);
+        // Set Segment Remap
+        transport_.SendCommand(0xA1);
+        // COM Output Scan Direction
+        transport_.SendCommand(0xC8);
+        // Contrast Control
+        transport_.SendCommand(0x81);
+        transport_.SendCommand(0x8F);
+        // Pre Charge
+        transport_.SendCommand(0xD9);
+        transport_.SendCommand(0x25);
+        // VCOM Detect
+        transport_.SendCommand(0xDB);
+        transport_.SendCommand(0x34);
+        // Display On
+        transport_.SendCommand(0xAF);
+
+        Fill(false);
+        panelValid_ = false;
+        framesSent_ = 0;
+    }
+
+    size_t Width() const { return width; }
+    size_t Height() const { return height; }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on)
+    {
+        if(x >= width || y >= height)
+            return;
+        if(on)
+            buffer_[x + (y / 8) * width] |= (1 << (y % 8));
+        else
+            buffer_[x + (y / 8) * width] &= ~(1 << (y % 8));
+    }
+
+    void Fill(bool on) { memset(buffer_, on ? 0xff : 0x00, sizeof(buffer_)); }
+
+    /** Starts sending the pages that changed since the last frame, never blocks */
+    void Update()
+    {
+        if(!dmaBuffer_ || transport_.IsBusy())
+            return;
+
+        // Find the span of pages that differ from what the display is showing
+        size_t first = kNumPages, last = 0;
+        for(size_t page = 0; page < kNumPages; page++)
+        {
+            if(!panelValid_
+               || memcmp(&buffer_[width * page], &dmaBuffer_[width * page], width) != 0)
+            {
+                first = page < first ? page : first;
+                last  = page;
+            }
+        }
+
+        if(first == kNumPages)
+            return;
+
+        const size_t offset = width * first;
+        const size_t size   = width * (last - first + 1);
+        memcpy(&dmaBuffer_[offset], &buffer_[offset], size);
+
+        // Column and Page Address window for the span
+        transport_.SendCommand(0x21);
+        transport_.SendCommand(0);
+        transport_.SendCommand(width - 1);
+        transport_.SendCommand(0x22);
+        transport_.SendCommand(first);
+        transport_.SendCommand(last);
+
+        // The DMA buffer now holds pages the panel hasn't got.  If the transfer didn't
+        // start it no longer matches the panel, so the next Update() sends every page.
+        if(!transport_.SendDataDma(&dmaBuffer_[offset], size))
+        {
+            panelValid_ = false;
+            return;
+        }
+
+        panelValid_ = true;
+        framesSent_++;
+    }
+
+    /** Returns true while the last frame is still being sent */
+    bool IsBusy() const { return transport_.IsBusy(); }
+
+    /** Returns the number of frames that had changes and were sent */
+    uint32_t FramesSent() const { return framesSent_; }
+
+    SSD130x4WireSpiDmaTransport& GetTransport() { return transport_; }
+
+  private:
+    SSD130x4WireSpiDmaTransport transport_;
+    uint8_t                     buffer_[kBufferSize];
+    uint8_t*                    dmaBuffer_  = nullptr;
+    bool                        panelValid_ = false;
+    uint32_t                    framesSent_ = 0;
+};
+
+using SSD130x4WireSpiDma128x64Driver = SSD130xDmaDriver<128, 64>;
+
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,62 @@
+#include "tempo_page.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+bool TempoPage::OnOkayButton(uint8_t numberOfPresses, bool isRetriggering)
+{
+    if(numberOfPresses == 1 && !isRetriggering)
+    {
+        Close();
+    }
+    return true;
+}
+
+bool TempoPage::OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution)
+{
+    // Nothing to navigate on this page
+    return true;
+}
+
+void TempoPage::Draw(const UiCanvasDescriptor& canvas)
+{
+    MyOledDisplay& display = *((MyOledDisplay*)(canvas.handle_));
+
+    display.SetCursor(0, 0);
+    display.WriteString("Tempo", Font_7x10, true);
+
+    if(tapTempo_ == nullptr || midiClock_ == nullptr)
+        return;
+
+    char  line[32];
+    float tempo = 0.0f;
+    if(midiClock_->Running())
+    {
+        tempo = midiClock_->Tempo();
+        sprintf(line, "MIDI %s", MidiClockSync::DivisionName(midiClock_->GetDivision()));
+    }
+    else if(tapTempo_->Active())
+    {
+        tempo = tapTempo_->Tempo();
+        sprintf(line, "Tap, %lu taps", (unsigned long)tapTempo_->TapCount());
+    }
+    else
+    {
+        sprintf(line, "Rate Knob");
+    }
+    display.SetCursor(0, 14);
+    display.WriteString(line, Font_6x8, true);
+
+    if(tempo <= 0.0f)
+    {
+        display.SetCursor(0, 34);
+        display.WriteString("Tap Footswitch 2", Font_6x8, true);
+        return;
+    }
+
+    // Tenths of a beat per minute, printf on the Daisy Seed has no float support.
+    const unsigned tenths = (unsigned)(tempo * 10.0f + 0.5f);
+    sprintf(line, "%u.%u BPM", tenths / 10, tenths % 10);
+    display.SetCursor(0, 32);
+    display.WriteString(line, Font_11x18, true);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef TEMPO_PAGE_H
+#define TEMPO_PAGE_H /**< & */
+
+#include "guitar_pedal_125b.h"
+#include "tap_tempo.h"
+#include "midi_clock_sync.h"
+
+namespace bkshepherd {
+
+/**
+   @brief OLED page showing the tempo the Tremolo follows.
+
+   MIDI clock comes first while it is running, then a tempo tapped on the second
+   footswitch, otherwise the rate knob sets the Tremolo frequency and there is no tempo
+   to show.  The page opens by itself when the footswitch is tapped.  Press the encoder
+   to close the page.
+*/
+class TempoPage : public UiPage
+{
+  public:
+    /** Initialize the page
+    \param tapTempo Tap tempo run by the Audio Callback
+    \param midiClock MIDI clock followed by the Audio Callback
+    */
+    void Init(const TapTempo* tapTempo, const MidiClockSync* midiClock)
+    {
+        tapTempo_  = tapTempo;
+        midiClock_ = midiClock;
+    }
+
+    /** Returns true while the page is open */
+    bool IsActive() const { return active_; }
+
+    bool OnOkayButton(uint8_t numberOfPresses, bool isRetriggering) override;
+    bool OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution) override;
+    void OnShow() override { active_ = true; }
+    void OnHide() override { active_ = false; }
+    void Draw(const UiCanvasDescriptor& canvas) override;
+
+  private:
+    const TapTempo*      tapTempo_  = nullptr;
+    const MidiClockSync* midiClock_ = nullptr;
+    bool                 active_    = false;
+};
+} // namespace bkshepherd
+#endif
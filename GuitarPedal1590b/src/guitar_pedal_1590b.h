@@ -3,17 +3,17 @@
 #define GUITAR_PEDAL_1590B_H /**< & */
 
 #include "daisy_seed.h"
+#include "guitar_pedal.h"
 
 using namespace daisy;
 
 namespace bkshepherd {
 
 /**
-   @brief Helpers and hardware definitions for a 1590B sized Guitar Pedal based on the Daisy Seed.
+   @brief Hardware definitions for a 1590B sized Guitar Pedal based on the Daisy Seed.
 */
-class GuitarPedal1590B
+struct GuitarPedal1590BBoard
 {
-  public:
     /** Switches */
     enum SwitchIndex
     {
@@ -32,6 +32,12 @@ class GuitarPedal1590B
         KNOB_LAST, /**< & */
     };
 
+    /** No encoders */
+    enum EncoderIndex
+    {
+        ENCODER_LAST, /**< & */
+    };
+
     /**  Status LEDs */
     enum LedIndex
     {
@@ -40,129 +46,28 @@ class GuitarPedal1590B
         LED_LAST, /**< & */
     };
 
-    /** Constructor */
-    GuitarPedal1590B() {}
-    /** Destructor */
-    ~GuitarPedal1590B() {}
-
-    /** Initialize the pedal */
-    void Init(bool boost = false);
-
-    /**
-       Wait before moving on.
-       \param del Delay time in ms.
-     */
-    void DelayMs(size_t del);
-
-
-    /** Starts the callback
-    \param cb Interleaved callback function
-    */
-    void StartAudio(AudioHandle::InterleavingAudioCallback cb);
-
-    /** Starts the callback
-    \param cb multichannel callback function
-    */
-    void StartAudio(AudioHandle::AudioCallback cb);
-
-    /**
-       Switch callback functions
-       \param cb New interleaved callback function.
-    */
-    void ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb);
-
-    /**
-       Switch callback functions
-       \param cb New multichannel callback function.
-    */
-    void ChangeAudioCallback(AudioHandle::AudioCallback cb);
-
-    /** Stops the audio if it is running. */
-    void StopAudio();
-
-    /** Updates the Audio Sample Rate, and reinitializes.
-     ** Audio must be stopped for this to work.
-     */
-    void SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate);
-
-    /** Returns the audio sample rate in Hz as a floating point number.
-     */
-    float AudioSampleRate();
-
-    /** Sets the number of samples processed per channel by the audio callback.
-       \param size Audio block size
-     */
-    void SetAudioBlockSize(size_t size);
-
-    /** Returns the number of samples per channel in a block of audio. */
-    size_t AudioBlockSize();
+    static constexpr uint8_t kSwitchPins[SWITCH_LAST] = {6, 5};
+    static constexpr uint8_t kKnobPins[KNOB_LAST]     = {15, 16, 17, 18};
+    static constexpr uint8_t kLedPins[LED_LAST]       = {22, 23};
 
-    /** Returns the rate in Hz that the Audio callback is called */
-    float AudioCallbackRate();
+    // MIDI on the UART's default pins
+    static constexpr int kMidiRxPin = -1;
+    static constexpr int kMidiTxPin = -1;
 
-    /** Start analog to digital conversion. */
-    void StartAdc();
+    static constexpr Pin kBypassPin = seed::D1;
+    static constexpr Pin kMutePin   = seed::D12;
 
-    /** Stops Transfering data from the ADC */
-    void StopAdc();
+    static constexpr size_t                        kBlockSize  = 4;
+    static constexpr SaiHandle::Config::SampleRate kSampleRate = SaiHandle::Config::SampleRate::SAI_48KHZ;
 
-    /** Call at the same frequency as controls are read for stable readings.*/
-    void ProcessAnalogControls();
-
-    /** Process Analog and Digital Controls */
-    inline void ProcessAllControls()
-    {
-        ProcessAnalogControls();
-        ProcessDigitalControls();
-    }
-
-    /** Get value per knob.
-    \param k Which knob to get
-    \return Floating point knob position.
-    */
-    float GetKnobValue(KnobIndex k);
-
-    /** Process digital controls */
-    void ProcessDigitalControls();
-
-    /** Toggle the Hardware Audio Bypass (if applicable) */
-    void SetAudioBypass(bool enabled);
-
-        /** Toggle the Hardware Audio Mute (if applicable) */
-    void SetAudioMute(bool enabled);
-
-    /** Turn all leds off */
-    void ClearLeds();
-
-    /**
-       Set Led
-       \param idx Led Index
-       \param bright Brightness
-     */
-    void SetLed(LedIndex idx, float bright);
-
-    /** Updates all the LEDs based on their values */
-    void UpdateLeds();
-
-    DaisySeed seed;    /**< & */
-    AnalogControl knobs[KNOB_LAST]; /**< & */
-    Switch        switches[SWITCH_LAST] /**< & */;
-    Led           leds[LED_LAST]; /**< & */
-    MidiUartHandler midi;
-    GPIO audioBypassTrigger;
-    bool audioBypass;
-    GPIO audioMuteTrigger;
-    bool audioMute;
-
-  private:
-    void SetHidUpdateRates();
-    void InitSwitches();
-    void InitLeds();
-    void InitAnalogControls();
-    void InitMidi();
+    using Display = NoDisplay;
+};
 
-    inline uint16_t* adc_ptr(const uint8_t chn) { return seed.adc.GetPtr(chn); }
+/**
+   @brief Helpers and hardware definitions for a 1590B sized Guitar Pedal based on the Daisy Seed.
+*/
+using GuitarPedal1590B = GuitarPedal<GuitarPedal1590BBoard>;
 
-};
+extern template class GuitarPedal<GuitarPedal1590BBoard>;
 } // namespace bkshepherd
 #endif
@@ -1,6 +1,17 @@
 #include <string.h>
 #include "guitar_pedal_1590b.h"
 #include "daisysp.h"
+#include "audio_load_meter.h"
+#include "block_tremolo.h"
+#include "wavetable_lfo.h"
+#include "control_rate.h"
+#include "deferred_log.h"
+#include "sample_clock.h"
+#include "midi_param_map.h"
+#include "switch_timestamps.h"
+#include "midi_clock_sync.h"
+#include "tap_tempo.h"
+#include "control_task.h"
 
 using namespace daisy;
 using namespace daisysp;
@@ -13,142 +24,369 @@ bool relayBypassEnabled = true;
 float led2Brightness = 0.0f;
 
 uint32_t lastTimeStampUS;
+uint32_t lastLoadReportMs;
+const uint32_t loadReportIntervalMs = 1000;
+
 int samplesSinceEnableToggled;
 bool crossFading = false;
 bool crossFadingToEffectOn = false;
-float crossFadingWetFactor;
-float crossFadingDryFactor;
 float crossFadingTransitionTimeInSeconds = 0.25f;
 int crossFadingTransitionTimeInSamples;
 
+// Audio Callback Load Measurement
+AudioLoadMeter loadMeter;
+
+// Messages from the Audio Callback are recorded here and printed by the main loop
+typedef DeferredLog<32> AudioLog;
+AudioLog audioLog;
+
+// Knobs are read at a fixed control rate, and only cause recalculation when they really move
+const float controlUpdateRate = 1000.0f;
+const float knobDeadBand = 0.002f;
+ControlRateScheduler controlRate;
+uint32_t appliedKnobVersions[GuitarPedal1590B::KNOB_LAST];
+uint32_t appliedKnobsVersion = 0;
+
+// MIDI Control Changes are mapped onto these parameters and applied at the sample they arrived at
+enum MidiParam
+{
+    MIDI_PARAM_TREM_RATE,
+    MIDI_PARAM_TREM_DEPTH,
+    MIDI_PARAM_TREM_WAVEFORM,
+    MIDI_PARAM_BYPASS,
+};
+
+const MidiCcMapping midiCcMappings[] = {
+    {MidiParamMap::kOmni, 14, MIDI_PARAM_TREM_RATE},
+    {MidiParamMap::kOmni, 15, MIDI_PARAM_TREM_DEPTH},
+    {MidiParamMap::kOmni, 16, MIDI_PARAM_TREM_WAVEFORM},
+    {MidiParamMap::kOmni, 102, MIDI_PARAM_BYPASS}, // 64 - 127 bypasses the effect
+};
+
+SampleClock sampleClock;
+MidiParamMap midiParamMap;
+
+// Footswitch presses are stamped by a timer task at the control rate, off the Audio
+// Callback, so a press lands at the offset in the block it happened at
+SwitchTimestamps switchTimestamps;
+ControlTask controlTask;
+
+// The Tremolo follows MIDI clock while it's running, the rate then picks the note division
+MidiClockSync midiClock;
+bool tremSynced = false;
+
+// The Second Footswitch taps a tempo, the Tremolo then runs a cycle per beat until the
+// rate knob is turned well away from where it was or MIDI sets the rate.
+TapTempo tapTempo;
+const float tapKnobTakeover = 0.05f;
+float tapRateKnob = 0.0f;
+
 // Effect
-Tremolo    treml, tremr;
-Oscillator freq_osc;
+BlockTremolo tremolo;
+WavetableLfo freq_osc; // Modulates the tremolo rate, runs at the control rate
 int  waveform;
 float osc_freq;
-Parameter osc_freq_knob;
+float tremRate = 0.0f;    // Set by the knob or MIDI, 0.0 to 1.0
+float tremRateMod = 1.0f; // Last value of the frequency modulation oscillator
 
-static void AudioCallback(AudioHandle::InputBuffer  in,
-                     AudioHandle::OutputBuffer out,
-                     size_t                    size)
+// Sets the Tremolo frequency from the rate and the frequency modulation.
+void UpdateTremoloFreq()
 {
-    // Handle Inputs
-    hardware.ProcessAnalogControls();
-    hardware.ProcessDigitalControls();
+    midiClock.SetDivision((MidiClockSync::Division)(tremRate * (MidiClockSync::DIVISION_LAST - 1) + 0.5f));
+    if (midiClock.Running())
+    {
+        return;
+    }
+
+    if (tapTempo.Active())
+    {
+        tremolo.SetFreq(tapTempo.CycleFreq());
+        return;
+    }
 
-    // Handle knobs Tremelo
     float tremFreqMin = 1.0f;
-    float tremFreqMax = hardware.knobs[0].Process() * 20.f; //0 - 20 Hz
-    treml.SetDepth(hardware.knobs[1].Process());
-    tremr.SetDepth(hardware.knobs[1].Value());
+    float tremFreqMax = tremRate * 20.f; //0 - 20 Hz
+    tremolo.SetFreq(tremFreqMin + tremFreqMax * tremRateMod);
+}
 
-    //float w = hardware.knobs[3].Process();
-    //int numChoices = Oscillator::WAVE_LAST;
-    //waveform = w * numChoices;
-    freq_osc.SetWaveform(waveform);
-    float knob2Value = osc_freq_knob.Process();
-    float freq_osc_min = 0.01f;
-    freq_osc.SetFreq(freq_osc_min + (knob2Value * 3.0f)); //0 - 20 Hz
+// Returns true once for every new value of a knob
+bool KnobChanged(size_t knob)
+{
+    if (appliedKnobVersions[knob] == hardware.knobs.Version(knob))
+    {
+        return false;
+    }
+    appliedKnobVersions[knob] = hardware.knobs.Version(knob);
+    return true;
+}
+
+// The rate modulation knob is on an exponential curve
+float OscFreqKnob()
+{
+    float value = hardware.knobs.Value(2);
+    return value * value;
+}
+
+// Maps the knobs onto the Tremolo, called at the control rate.
+void UpdateTremoloControls(size_t rampSamples)
+{
+    // The knob front end reads the ADC, averages the readings and debounces them
+    hardware.ProcessAnalogControls();
+
+    // While nobody touches a knob only the rate modulation below has anything to do
+    bool rateChanged = false;
+    bool oscFreqChanged = false;
+    if (hardware.knobs.Version() != appliedKnobsVersion)
+    {
+        appliedKnobsVersion = hardware.knobs.Version();
 
-    float mod = freq_osc.Process();
+        if (KnobChanged(1))
+        {
+            tremolo.SetDepth(hardware.knobs.Value(1), rampSamples);
+        }
 
-    if (knob2Value < 0.01) {
-        mod = 1.0f;
+        rateChanged = KnobChanged(0);
+        if (rateChanged)
+        {
+            tremRate = hardware.knobs.Value(0);
+            if (fabsf(tremRate - tapRateKnob) > tapKnobTakeover)
+            {
+                tapTempo.Cancel();
+            }
+        }
+
+        oscFreqChanged = KnobChanged(2);
+        float freq_osc_min = 0.01f;
+
+        if (oscFreqChanged)
+        {
+            freq_osc.SetFreq(freq_osc_min + (OscFreqKnob() * 3.0f));
+        }
     }
 
-    treml.SetFreq(tremFreqMin + tremFreqMax * mod); 
-    tremr.SetFreq(tremFreqMin + tremFreqMax * mod);
+    // The Tremolo frequency only needs recalculating while it's being modulated or when a knob moved
+    bool modulating = OscFreqKnob() >= 0.01f;
+    if (modulating || rateChanged || oscFreqChanged)
+    {
+        tremRateMod = modulating ? freq_osc.Process() : 1.0f;
+        UpdateTremoloFreq();
+    }
+}
 
-    //If the First Footswitch button is pressed, toggle the effect enabled
-    bool oldEffectOn = effectOn;
-    effectOn ^= hardware.switches[0].RisingEdge();
+// Setup Effect Crossfade to happen over a specified number of samples based on the time config
+void StartCrossfade(uint32_t sample)
+{
+    samplesSinceEnableToggled = 0;
+    crossFading = true;
+    crossFadingToEffectOn = effectOn;
 
-    if (relayBypassEnabled)
-    { 
-        hardware.SetAudioBypass(!effectOn);
+    if (effectOn)
+    {
+        audioLog.Log(sample, "Crossfade to EffectOn over %d samples", crossFadingTransitionTimeInSamples);
     }
     else
     {
-        hardware.SetAudioBypass(false);
+        audioLog.Log(sample, "Crossfade to EffectOff over %d samples", crossFadingTransitionTimeInSamples);
     }
-    
-    // Handle Effect State being Toggled.
-    if (effectOn != oldEffectOn)
+}
+
+// Applies a MIDI mapped parameter change, called from the Audio Callback at the sample it is due.
+void ApplyMidiParam(const ParamEvent& event)
+{
+    switch(event.param)
     {
-        // Setup Effect Crossfade to happen over a specified number of samples based on the time config
-        samplesSinceEnableToggled = 0;
-        crossFading = true;
+        case MIDI_PARAM_TREM_RATE:
+            tremRate = event.value;
+            tapTempo.Cancel();
+            UpdateTremoloFreq();
+            break;
+        case MIDI_PARAM_TREM_DEPTH:
+            tremolo.SetDepth(event.value, controlRate.RampSamples());
+            break;
+        case MIDI_PARAM_TREM_WAVEFORM:
+            tremolo.SetWaveform((int)(event.value * 4.0f + 0.5f)); // Sine, Triangle, Saw, Ramp, Square
+            break;
+        case MIDI_PARAM_BYPASS:
+            if (effectOn != (event.value < 0.5f))
+            {
+                effectOn = !effectOn;
+                StartCrossfade(event.sample);
+            }
+            break;
+        default: break;
+    }
+}
 
-        if (effectOn)
-        {
-            crossFadingToEffectOn = true;
-            hardware.seed.PrintLine("Crossfade to EffectOn over %d samples", crossFadingTransitionTimeInSamples);
-        }
-        else
+// Applies a footswitch press or release, called from the Audio Callback at the sample it is due.
+void ApplySwitchEvent(const SwitchEvent& event)
+{
+    // The First Footswitch toggles the effect enabled
+    if (event.index == GuitarPedal1590B::SWITCH_1 && event.pressed)
+    {
+        effectOn = !effectOn;
+        StartCrossfade(event.sample);
+    }
+
+    // The Second Footswitch taps the tempo, unless the Tremolo follows MIDI clock
+    if (event.index == GuitarPedal1590B::SWITCH_2 && event.pressed && !midiClock.Running())
+    {
+        tapTempo.Tap(event.sample);
+        tapRateKnob = hardware.knobs.Value(0);
+    }
+}
+
+// Starts a tapped tempo with a new cycle, called from the Audio Callback on the beat.
+void ApplyTempoBeat(uint32_t sample)
+{
+    tapTempo.ApplyBeat();
+    if (!midiClock.Running())
+    {
+        tremolo.ResetPhase(0.0f);
+        UpdateTremoloFreq();
+    }
+
+    // Tenths of a beat per minute, printf on the Daisy Seed has no float support.
+    int tenths = (int)(tapTempo.Tempo() * 10.0f + 0.5f);
+    audioLog.Log(sample, "Tapped tempo %d.%d BPM", tenths / 10, tenths % 10);
+}
+
+// Processes part of the block with the current effect settings.
+void ProcessAudio(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t start, size_t count)
+{
+    const float* segmentIn[2] = {in[0] + start, in[1] + start};
+    float* segmentOut[2] = {out[0] + start, out[1] + start};
+
+    if (crossFading)
+    {
+        // Wet amount for each sample of the crossfade, 0.0 is fully dry and 1.0 fully wet
+        float wet[kMaxAudioBlockSize];
+        const float wetOffset = crossFadingToEffectOn ? 0.0f : 1.0f;
+        const float wetScale = crossFadingToEffectOn ? 1.0f : -1.0f;
+
+        for(size_t i = 0; i < count; i++)
         {
-            crossFadingToEffectOn = false;
-            hardware.seed.PrintLine("Crossfade to EffectOff over %d samples", crossFadingTransitionTimeInSamples);
+            float fadeFactor = fminf((float)(samplesSinceEnableToggled + i) / (float)crossFadingTransitionTimeInSamples, 1.0f);
+            wet[i] = wetOffset + wetScale * fadeFactor;
         }
+
+        // Increment the Sample Count
+        samplesSinceEnableToggled += count;
+        crossFading = samplesSinceEnableToggled < crossFadingTransitionTimeInSamples;
+
+        // Tremelo, blended with the dry signal
+        float gain[kMaxAudioBlockSize];
+        tremolo.ProcessGain(gain, count);
+        led2Brightness = effectOn ? tremolo.Level() : 0.0f;
+        CrossfadeGainBlock(gain, wet, count);
+        MultiplyBlock(segmentOut[0], segmentIn[0], gain, count);
+        MultiplyBlock(segmentOut[1], segmentIn[1], gain, count);
+    }
+    else if(effectOn)
+    {
+        // Tremelo
+        led2Brightness = tremolo.Process(segmentIn, segmentOut, 2, count);
     }
+    else
+    {
+        CopyBlock(segmentOut[0], segmentIn[0], count);
+        CopyBlock(segmentOut[1], segmentIn[1], count);
+        led2Brightness = 0.0f;
+    }
+}
 
-    // Process Audio
-    for(size_t i = 0; i < size; i++)
+// Scans the footswitches, called from the control timer at the control rate.  A change
+// is stamped with the sample position the audio is at when the scan sees it and takes
+// effect one block later, at the same offset.
+void ScanSwitches()
+{
+    const uint32_t switchSample = sampleClock.Now() + sampleClock.BlockSize();
+    for (size_t i = 0; i < GuitarPedal1590B::SWITCH_LAST; i++)
     {
-        if (crossFading)
-        {
-            if (samplesSinceEnableToggled < crossFadingTransitionTimeInSamples)
-            {
-                float fadeFactor = (float)samplesSinceEnableToggled / (float)crossFadingTransitionTimeInSamples;
-                
-                if (crossFadingToEffectOn)
-                {
-                    crossFadingDryFactor = 1.0f - fadeFactor;
-                    crossFadingWetFactor = fadeFactor;
-                }
-                else
-                {
-                    crossFadingDryFactor = fadeFactor;
-                    crossFadingWetFactor = 1.0f - fadeFactor;
-                }
-            }
-            else
-            {
-                crossFading = false;
-            }
+        switchTimestamps.Poll(i, hardware.switches[i].RawState(), switchSample);
+    }
+}
 
-            // Tremelo
-            led2Brightness = treml.Process(1.0f);
-            out[0][i] = (in[0][i] * crossFadingDryFactor) + (in[0][i] * led2Brightness * crossFadingWetFactor);
-            out[1][i] = (in[1][i] * crossFadingDryFactor) + (tremr.Process(in[1][i]) * crossFadingWetFactor);
+static void AudioCallback(AudioHandle::InputBuffer  in,
+                     AudioHandle::OutputBuffer out,
+                     size_t                    size)
+{
+    loadMeter.OnBlockStart();
+    sampleClock.OnBlockStart(size);
 
-            if (!effectOn)
-            {
-                led2Brightness = 0.0f;
-            }
+    // Follow MIDI clock while it's running
+    bool synced = midiClock.Update(sampleClock.BlockStart());
 
-            // Increment the Sample Count
-            samplesSinceEnableToggled += 1;
+    // Read the knobs and update the Tremolo at the control rate, independent of the block size
+    if (controlRate.Tick(size))
+    {
+        UpdateTremoloControls(controlRate.RampSamples());
+    }
+
+    if (synced)
+    {
+        tremolo.SyncPhase(midiClock.CycleFreq(), midiClock.CyclePhase(sampleClock.BlockStart()));
+    }
+    else if (tremSynced)
+    {
+        // The clock stopped, back to the rate knob
+        UpdateTremoloFreq();
+    }
+    tremSynced = synced;
+
+    // Process Audio, split at the sample positions of any MIDI parameter changes, footswitch
+    // presses and the beat a tapped tempo starts on.  On the same sample MIDI goes first.
+    ParamEvent midiEvent;
+    SwitchEvent switchEvent;
+    size_t midiOffset, switchOffset, beatOffset;
+    size_t processed = 0;
+    bool midiDue = midiParamMap.PopDueEvent(sampleClock.BlockStart(), size, midiEvent, midiOffset);
+    bool switchDue = switchTimestamps.PopDueEvent(sampleClock.BlockStart(), size, switchEvent, switchOffset);
+    bool beatDue = tapTempo.NextBeat(sampleClock.BlockStart(), size, beatOffset);
+    while (midiDue || switchDue || beatDue)
+    {
+        bool midiFirst = midiDue && (!switchDue || midiOffset <= switchOffset) && (!beatDue || midiOffset <= beatOffset);
+        bool switchFirst = !midiFirst && switchDue && (!beatDue || switchOffset <= beatOffset);
+        size_t offset = midiFirst ? midiOffset : (switchFirst ? switchOffset : beatOffset);
+        if (offset > processed)
+        {
+            ProcessAudio(in, out, processed, offset - processed);
+            processed = offset;
+        }
+
+        if (midiFirst)
+        {
+            ApplyMidiParam(midiEvent);
+            midiDue = midiParamMap.PopDueEvent(sampleClock.BlockStart(), size, midiEvent, midiOffset);
+        }
+        else if (switchFirst)
+        {
+            ApplySwitchEvent(switchEvent);
+            switchDue = switchTimestamps.PopDueEvent(sampleClock.BlockStart(), size, switchEvent, switchOffset);
         }
         else
         {
-            out[0][i] = in[0][i];
-            out[1][i] = in[1][i];
-            led2Brightness = 0.0f;
-
-            if(effectOn)
-            {
-                // Tremelo
-                led2Brightness = treml.Process(1.0f);
-                out[0][i] = in[0][i] * led2Brightness;
-                out[1][i] = tremr.Process(in[1][i]);
-            }
+            ApplyTempoBeat(sampleClock.BlockStart() + (uint32_t)offset);
         }
+        beatDue = tapTempo.NextBeat(sampleClock.BlockStart(), size, beatOffset);
+    }
+    ProcessAudio(in, out, processed, size - processed);
+
+    // The relay follows the effect state the block ended with
+    if (relayBypassEnabled)
+    { 
+        hardware.SetAudioBypass(!effectOn);
+    }
+    else
+    {
+        hardware.SetAudioBypass(false);
     }
 
     //LED stuff
     hardware.SetLed((GuitarPedal1590B::LedIndex)0, effectOn);
     hardware.SetLed((GuitarPedal1590B::LedIndex)1, led2Brightness);
     hardware.UpdateLeds();
+
+    loadMeter.OnBlockEnd();
 }
 
 int GetNumberOfSamplesForTime(float time)
@@ -157,80 +395,59 @@ int GetNumberOfSamplesForTime(float time)
     return (int)(hardware.AudioSampleRate() * time);
 }
 
-// Typical Switch case for Message Type.
-void HandleMidiMessage(MidiEvent m)
+// Clock and transport messages drive the tempo sync, mapped Control Changes are scheduled
+// for the Audio Callback, other messages are ignored.
+void HandleMidiMessage(const MidiEvent& m)
 {
-    switch(m.type)
+    if (!midiClock.HandleMidiEvent(m))
     {
-        case NoteOn:
-        {
-            NoteOnEvent p = m.AsNoteOn();
-            char        buff[512];
-            sprintf(buff,
-                    "Note Received:\t%d\t%d\t%d\r\n",
-                    m.channel,
-                    m.data[0],
-                    m.data[1]);
-            //hareware.seed.usb_handle.TransmitInternal((uint8_t *)buff, strlen(buff));
-            // This is to avoid Max/MSP Note outs for now..
-            if(m.data[1] != 0)
-            {
-                p = m.AsNoteOn();
-                //led2Brightness = ((float)p.velocity / 127.0f);
-                //osc.SetFreq(mtof(p.note));
-                //osc.SetAmp((p.velocity / 127.0f));
-            }
-        }
-        break;
-        case ControlChange:
-        {
-            ControlChangeEvent p = m.AsControlChange();
-            switch(p.control_number)
-            {
-                case 1:
-                    // CC 1 for cutoff.
-                    //filt.SetFreq(mtof((float)p.value));
-                    break;
-                case 2:
-                    // CC 2 for res.
-                    //filt.SetRes(((float)p.value / 127.0f));
-                    break;
-                default: 
-                    //led2Brightness = ((float)p.value / 127.0f);
-                break;
-            }
-            break;
-        }
-        default: break;
+        midiParamMap.HandleMidiEvent(m);
     }
 }
 
-int main(void)
+// Initializes the hardware and the effect, then starts the audio callback.
+void InitPedal()
 {
     // Initialize the Hardware
     hardware.Init();
     hardware.SetAudioBlockSize(4);
     hardware.SetAudioSampleRate(SaiHandle::Config::SampleRate::SAI_48KHZ);
 
+    // Measure the Audio Callback against the time available per block
+    loadMeter.Init(hardware.AudioCallbackRate());
+
     // Set the number of samples to use for the crossfade based on the hardware sample rate
     crossFadingTransitionTimeInSamples = GetNumberOfSamplesForTime(crossFadingTransitionTimeInSeconds);
 
-    // Setup the Tremolo Effect
+    // Read the knobs at a fixed control rate, the knob front end averages the readings
+    // over that many updates and the frequency modulation oscillator runs at that rate too.
     float sample_rate = hardware.AudioSampleRate();
-    treml.Init(sample_rate);
-    tremr.Init(sample_rate);
-    treml.SetWaveform(Oscillator::WAVE_SIN);
-    tremr.SetWaveform(Oscillator::WAVE_SIN);
+    controlRate.Init(sample_rate, controlUpdateRate);
+    float control_rate = controlRate.UpdateRate(hardware.AudioBlockSize());
+    hardware.knobs.Init(knobDeadBand);
+
+    // Timestamp MIDI parameter changes against the audio
+    sampleClock.Init(sample_rate);
+    midiParamMap.Init(midiCcMappings, sizeof(midiCcMappings) / sizeof(midiCcMappings[0]), &sampleClock);
+    midiClock.Init(sample_rate, &sampleClock);
+    switchTimestamps.Init(GuitarPedal1590B::SWITCH_LAST, sample_rate);
+    tapTempo.Init(sample_rate);
+
+    // Scan the footswitches from a timer at the control rate
+    controlTask.Init(controlUpdateRate, ScanSwitches);
+
+    // Setup the Tremolo Effect
+    tremolo.Init(sample_rate);
+    tremolo.SetWaveform(Oscillator::WAVE_SIN);
     waveform = 0;
     osc_freq = 0.0f;
-    freq_osc.Init(sample_rate);
+    freq_osc.Init(control_rate);
     freq_osc.SetWaveform(waveform);
-    freq_osc.SetAmp(1.0f);
     freq_osc.SetFreq(osc_freq);
-    osc_freq_knob.Init(hardware.knobs[2], 0.0, 1.0f, Parameter::Curve::EXPONENTIAL);
  
     // Start the Audio Callback
     hardware.StartAdc();
+    controlTask.Start();
     hardware.StartAudio(AudioCallback);
 
     // Setup Midi Receiving
@@ -246,20 +463,59 @@ int main(void)
     // Setup Logging
     hardware.seed.StartLog();
     lastTimeStampUS = System::GetUs();
+    lastLoadReportMs = System::GetNow();
+}
+
+// A single pass of the main loop, everything here runs outside the audio callback.
+void ProcessMainLoop()
+{
+    // Handle Time
+    uint32_t currentTimeStampUS = System::GetUs();
+    //uint32_t elapsedTimeStampUS = currentTimeStampUS - lastTimeStampUS;
+    lastTimeStampUS = currentTimeStampUS;
+
+    // Print anything the Audio Callback logged, tagged with the sample it happened at
+    audioLog.Drain([](const AudioLog::Record& record) {
+        hardware.seed.Print("[%u] ", (unsigned int)record.timestamp);
+        hardware.seed.PrintLine(record.format, record.args[0], record.args[1], record.args[2], record.args[3]);
+    });
+
+    uint32_t droppedLogRecords = audioLog.TakeDroppedCount();
+    if (droppedLogRecords > 0)
+    {
+        hardware.seed.PrintLine("%d Audio Callback log messages dropped", (int)droppedLogRecords);
+    }
+
+    // Periodically report the Audio Callback Load
+    if (System::GetNow() - lastLoadReportMs >= loadReportIntervalMs)
+    {
+        lastLoadReportMs = System::GetNow();
+        hardware.seed.PrintLine("CPU Load: min %d%% avg %d%% max %d%% (%d of %d blocks missed the deadline)",
+                                (int)(loadMeter.MinLoad() * 100.0f),
+                                (int)(loadMeter.AvgLoad() * 100.0f),
+                                (int)(loadMeter.MaxLoad() * 100.0f),
+                                (int)loadMeter.DeadlineMisses(),
+                                (int)loadMeter.BlockCount());
+    }
+    
+    // Handle MIDI Events
+    hardware.midi.Listen();
+
+    while(hardware.midi.HasEvents())
+    {
+        HandleMidiMessage(hardware.midi.PopEvent());
+    }
+}
+
+// The HostRender tools provide their own main and drive the two functions above.
+#ifndef GUITAR_PEDAL_HOST_RENDER
+int main(void)
+{
+    InitPedal();
 
     while(1)
     {
-        // Handle Time
-        uint32_t currentTimeStampUS = System::GetUs();
-        //uint32_t elapsedTimeStampUS = currentTimeStampUS - lastTimeStampUS;
-        lastTimeStampUS = currentTimeStampUS;
-        
-        // Handle MIDI Events
-        hardware.midi.Listen();
-
-        while(hardware.midi.HasEvents())
-        {
-            HandleMidiMessage(hardware.midi.PopEvent());
-        }
+        ProcessMainLoop();
     }
 }
+#endif
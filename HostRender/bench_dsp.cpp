@@ -0,0 +1,1182 @@
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "daisysp.h"
+#include "block_tremolo.h"
+#include "block_overdrive.h"
+#include "block_delay.h"
+#include "effect_chain.h"
+#include "effect_switcher.h"
+#include "control_rate.h"
+#include "knob_front_end.h"
+#include "midi_clock_sync.h"
+#include "tap_tempo.h"
+#include "latency_probe.h"
+#include "midi_param_map.h"
+#include "mute_relay_scheduler.h"
+#include "preset_store.h"
+#include "switch_timestamps.h"
+#include "wavetable_lfo.h"
+
+using namespace daisysp;
+using namespace bkshepherd;
+
+// Benchmarks the DSP kernels used by the pedal programs on the host.
+
+static const float  kSampleRate     = 48000.0f;
+static const size_t kSamplesPerRun  = 48000 * 20;
+
+// Keeps the optimizer from throwing the benchmarked work away.
+static volatile float sink;
+
+// Number of checks that failed, the run exits non-zero if any did.
+static size_t failedChecks = 0;
+
+// Counts a failed check, the benchmarks carry on so the whole report is printed.
+static void Check(bool pass, const char* what)
+{
+    if(pass)
+        return;
+    failedChecks++;
+    printf("FAIL     %s\n", what);
+}
+
+template <typename Kernel>
+static double NsPerSample(size_t blockSize, Kernel kernel)
+{
+    std::vector<float> inLeft(blockSize, 0.5f), inRight(blockSize, 0.25f);
+    std::vector<float> outLeft(blockSize), outRight(blockSize);
+    const float*       in[2]  = {inLeft.data(), inRight.data()};
+    float*             out[2] = {outLeft.data(), outRight.data()};
+
+    const size_t numBlocks = kSamplesPerRun / blockSize;
+    auto         begin     = std::chrono::steady_clock::now();
+    for(size_t b = 0; b < numBlocks; b++)
+    {
+        kernel(in, out, blockSize);
+        sink = out[1][blockSize - 1];
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - begin).count()
+           / double(numBlocks * blockSize);
+}
+
+static void BenchTremolo(size_t blockSize)
+{
+    // The per-sample loop the pedal programs used: two daisysp::Tremolo instances.
+    Tremolo treml, tremr;
+    treml.Init(kSampleRate);
+    tremr.Init(kSampleRate);
+    treml.SetFreq(5.0f);
+    tremr.SetFreq(5.0f);
+    treml.SetDepth(0.8f);
+    tremr.SetDepth(0.8f);
+    bool effectOn = true;
+
+    double perSample = NsPerSample(blockSize, [&](const float* const* in, float** out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[0][i] = in[0][i];
+            out[1][i] = in[1][i];
+            if(effectOn)
+            {
+                out[0][i] = in[0][i] * treml.Process(1.0f);
+                out[1][i] = tremr.Process(in[1][i]);
+            }
+        }
+    });
+
+    BlockTremolo tremolo;
+    tremolo.Init(kSampleRate);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+
+    double block = NsPerSample(blockSize, [&](const float* const* in, float** out, size_t size) {
+        tremolo.Process(in, out, 2, size);
+    });
+
+    printf("tremolo  block %3zu   per-sample %6.2f ns   block %6.2f ns   %.2fx\n",
+           blockSize,
+           perSample,
+           block,
+           perSample / block);
+}
+
+// The waveforms of daisysp::Oscillator, worked out in double precision from the sample number
+static double ExactWaveform(int waveform, double freq, size_t sample, double offset = 0.0)
+{
+    double phase = freq * double(sample) / kSampleRate + offset;
+    phase -= floor(phase);
+    switch(waveform)
+    {
+        case Oscillator::WAVE_TRI: return 2.0 * (fabs(2.0 * phase - 1.0) - 0.5);
+        case Oscillator::WAVE_SAW: return 1.0 - 2.0 * phase;
+        case Oscillator::WAVE_RAMP: return 2.0 * phase - 1.0;
+        case Oscillator::WAVE_SQUARE: return phase < 0.5 ? 1.0 : -1.0;
+        default: return sin(2.0 * M_PI * phase);
+    }
+}
+
+// Times the wavetable LFO against daisysp::Oscillator and compares their outputs for every
+// waveform, and against the exact waveforms since the Oscillator's single precision phase
+// drifts.  The band-limited tables differ from the naive waveforms around the edges on
+// purpose, the largest step between samples shows the clicks they take out.
+static void BenchWavetableLfo(size_t blockSize)
+{
+    const float freq = 5.0f;
+
+    Oscillator osc;
+    osc.Init(kSampleRate);
+    osc.SetAmp(1.0f);
+    osc.SetFreq(freq);
+    double oscNs = NsPerSample(blockSize, [&](const float* const*, float** out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[1][i] = osc.Process();
+        }
+    });
+
+    WavetableLfo lfo;
+    lfo.Init(kSampleRate, 16);
+    lfo.SetFreq(freq);
+    double lfoNs = NsPerSample(blockSize, [&](const float* const*, float** out, size_t size) {
+        lfo.ProcessBlock(out[1], size);
+    });
+
+    printf("lfo      block %3zu   oscillator %6.2f ns   wavetable %6.2f ns   %.2fx\n",
+           blockSize,
+           oscNs,
+           lfoNs,
+           oscNs / lfoNs);
+
+    const char* names[] = {"sine", "triangle", "saw", "ramp", "square"};
+    for(int waveform = 0; waveform < 5; waveform++)
+    {
+        osc.Init(kSampleRate);
+        osc.SetAmp(1.0f);
+        osc.SetFreq(freq);
+        osc.SetWaveform(waveform);
+        lfo.Init(kSampleRate, 16);
+        lfo.SetFreq(freq);
+        lfo.SetWaveform(waveform);
+
+        std::vector<float> block(blockSize);
+        double             errorPower = 0.0;
+        float              maxError = 0.0f, exactError = 0.0f, oscStep = 0.0f, lfoStep = 0.0f;
+        float              lastOsc = 0.0f, lastLfo = 0.0f;
+        const size_t       numSamples = 96000;
+        for(size_t done = 0; done < numSamples; done += blockSize)
+        {
+            lfo.ProcessBlock(block.data(), blockSize);
+            for(size_t i = 0; i < blockSize; i++)
+            {
+                const float expected = osc.Process();
+                const float error    = block[i] - expected;
+                errorPower += error * error;
+                maxError = fmaxf(maxError, fabsf(error));
+                exactError
+                    = fmaxf(exactError, fabs(block[i] - ExactWaveform(waveform, freq, done + i)));
+                if(done + i > 0)
+                {
+                    oscStep = fmaxf(oscStep, fabsf(expected - lastOsc));
+                    lfoStep = fmaxf(lfoStep, fabsf(block[i] - lastLfo));
+                }
+                lastOsc = expected;
+                lastLfo = block[i];
+            }
+        }
+        printf("lfo      %-8s   vs oscillator rms %.1e  max %.1e   vs exact max %.1e   largest step  "
+               "oscillator %.4f  wavetable %.4f\n",
+               names[waveform],
+               sqrt(errorPower / numSamples),
+               maxError,
+               exactError,
+               oscStep,
+               lfoStep);
+    }
+}
+
+// Times the harmonic tremolo against the simple one, and checks that the two crossover
+// bands add back up to a flat response by running sines through it at zero depth.
+static void BenchHarmonicTremolo(size_t blockSize)
+{
+    BlockTremolo tremolo;
+    tremolo.Init(kSampleRate);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+
+    double simple = NsPerSample(blockSize, [&](const float* const* in, float** out, size_t size) {
+        tremolo.Process(in, out, 2, size);
+    });
+
+    tremolo.SetMode(BlockTremolo::MODE_HARMONIC);
+    double harmonic = NsPerSample(blockSize, [&](const float* const* in, float** out, size_t size) {
+        tremolo.Process(in, out, 2, size);
+    });
+
+    float worstDb = 0.0f;
+    const float testFreqs[] = {50.0f, 400.0f, 800.0f, 1600.0f, 8000.0f};
+    for(float freq : testFreqs)
+    {
+        tremolo.Init(kSampleRate);
+        tremolo.SetMode(BlockTremolo::MODE_HARMONIC);
+        tremolo.SetDepth(0.0f);
+
+        // Skip the filters settling, then compare the output level with the input
+        double inPower = 0.0, outPower = 0.0;
+        float  in[4], out[4];
+        for(size_t i = 0; i < 48000; i += 4)
+        {
+            for(size_t j = 0; j < 4; j++)
+            {
+                in[j] = sinf(6.2831853f * freq * float(i + j) / kSampleRate);
+            }
+            const float* inPtr  = in;
+            float*       outPtr = out;
+            tremolo.Process(&inPtr, &outPtr, 1, 4);
+            for(size_t j = 0; i >= 4800 && j < 4; j++)
+            {
+                inPower += in[j] * in[j];
+                outPower += out[j] * out[j];
+            }
+        }
+        const float db = 10.0f * log10f(float(outPower / inPower));
+        worstDb        = fabsf(db) > fabsf(worstDb) ? db : worstDb;
+    }
+
+    printf("harmonic block %3zu   simple %6.2f ns   harmonic %6.2f ns   %.2fx   band sum flat within %.4f dB\n",
+           blockSize,
+           simple,
+           harmonic,
+           harmonic / simple,
+           worstDb);
+}
+
+// Times the stereo phase offsets, and checks the right channel against the exact waveform
+// at the offset phase.
+static void BenchStereoTremolo(size_t blockSize)
+{
+    const float  offsets[] = {0.0f, 0.25f, 0.5f};
+    const char*  names[]   = {"mono", "wide", "ping-pong"};
+    printf("stereo   block %3zu ", blockSize);
+    for(size_t mode = 0; mode < 3; mode++)
+    {
+        BlockTremolo tremolo;
+        tremolo.Init(kSampleRate);
+        tremolo.SetFreq(5.0f);
+        tremolo.SetDepth(0.8f);
+        tremolo.SetStereoPhase(offsets[mode]);
+        double ns = NsPerSample(blockSize, [&](const float* const* in, float** out, size_t size) {
+            tremolo.Process(in, out, 2, size);
+        });
+
+        // Two seconds of a unity input, so the output is the gain curve
+        tremolo.Init(kSampleRate);
+        tremolo.SetFreq(5.0f);
+        tremolo.SetDepth(0.8f);
+
+        std::vector<float> ones(blockSize, 1.0f), left(blockSize), right(blockSize);
+        const float*       in[2]    = {ones.data(), ones.data()};
+        float*             out[2]   = {left.data(), right.data()};
+        float              maxError = 0.0f;
+        for(size_t done = 0; done < 96000; done += blockSize)
+        {
+            tremolo.Process(in, out, 2, blockSize);
+            for(size_t i = 0; i < blockSize; i++)
+            {
+                const double expected
+                    = 0.6 + ExactWaveform(Oscillator::WAVE_SIN, 5.0, done + i, offsets[mode]) * 0.4;
+                maxError = fmaxf(maxError, fabs(right[i] - expected));
+            }
+        }
+        printf("  %s %6.2f ns (error %.1e)", names[mode], ns, maxError);
+    }
+    printf("\n");
+}
+
+// Delay lines for the chain benchmark, a second at 48kHz
+static float delayBuffer[2][65536];
+
+// Runs overdrive -> tremolo -> delay through an EffectChain and times each slot on its
+// own, with the other slots bypassed, and the whole chain.
+static void BenchEffectChain(size_t blockSize)
+{
+    BlockOverdrive overdrive;
+    overdrive.Init();
+    overdrive.SetDrive(0.6f);
+
+    BlockTremolo tremolo;
+    tremolo.Init(kSampleRate);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+
+    BlockDelay delay;
+    float*     delayBuffers[2] = {delayBuffer[0], delayBuffer[1]};
+    delay.Init(kSampleRate, delayBuffers, 2, 65536);
+    delay.SetTime(0.35f);
+    delay.SetFeedback(0.5f);
+
+    const size_t       kSlots = 3;
+    EffectChain<kSlots> chain;
+    chain.Init();
+    chain.SetSlot(0, &overdrive);
+    chain.SetSlot(1, &tremolo);
+    chain.SetSlot(2, &delay);
+
+    auto process = [&](const float* const* in, float** out, size_t size) {
+        chain.Process(in, out, 2, size);
+    };
+
+    printf("chain    block %3zu ", blockSize);
+    for(size_t slot = 0; slot < kSlots; slot++)
+    {
+        for(size_t other = 0; other < kSlots; other++)
+        {
+            chain.SetBypass(other, other != slot);
+        }
+        printf("  %s %6.2f ns", chain.GetSlot(slot)->Name(), NsPerSample(blockSize, process));
+    }
+
+    for(size_t slot = 0; slot < kSlots; slot++)
+    {
+        chain.SetBypass(slot, false);
+    }
+    const double all = NsPerSample(blockSize, process);
+
+    for(size_t slot = 0; slot < kSlots; slot++)
+    {
+        chain.SetBypass(slot, true);
+    }
+    printf("   all %6.2f ns   empty %6.2f ns\n", all, NsPerSample(blockSize, process));
+}
+
+static const char* SwitchModeName(EffectSwitcher::SwitchMode mode)
+{
+    switch(mode)
+    {
+        case EffectSwitcher::SWITCH_CROSSFADE: return "crossfade";
+        case EffectSwitcher::SWITCH_DIP: return "dip";
+        default: return "refused";
+    }
+}
+
+// Flips the polarity, the most different program there is from the dry signal
+class InvertEffect : public EffectBlock
+{
+  public:
+    void ProcessBlock(const float* const* in, float** out, size_t numChannels, size_t size) override
+    {
+        for(size_t ch = 0; ch < numChannels; ch++)
+            for(size_t i = 0; i < size; i++)
+                out[ch][i] = -in[ch][i];
+    }
+    const char* Name() const override { return "Invert"; }
+};
+
+// Largest sample to sample step in the output around a switch from the dry signal to its
+// inverse, at the peak of a 50Hz sine that only steps by 0.002 itself.  A hard switch (a
+// fade of 2 samples) jumps by twice the amplitude.
+static float SwitchStep(size_t fadeSamples, bool sharesState)
+{
+    const size_t blockSize = 4;
+    InvertEffect invert;
+
+    EffectSwitcher switcher;
+    switcher.Init(nullptr, nullptr);
+
+    float        inLeft[blockSize], outLeft[blockSize], outRight[blockSize];
+    const float* in[2]  = {inLeft, inLeft};
+    float*       out[2] = {outLeft, outRight};
+
+    float  previous = 0.0f, maxStep = 0.0f;
+    size_t sample   = 0;
+    for(size_t block = 0; block < 4800 / blockSize; block++)
+    {
+        if(block == 240 / blockSize)
+            switcher.Switch(&invert, fadeSamples, sharesState, blockSize);
+
+        for(size_t i = 0; i < blockSize; i++, sample++)
+            inLeft[i] = 0.25f * sinf(6.2831853f * 50.0f * sample / kSampleRate);
+        switcher.Process(in, out, 2, blockSize);
+
+        for(size_t i = 0; i < blockSize; i++)
+        {
+            if(sample > blockSize)
+                maxStep = fmaxf(maxStep, fabsf(outLeft[i] - previous));
+            previous = outLeft[i];
+        }
+    }
+    return maxStep;
+}
+
+// Switches between two chains that don't share effects, times the crossfade against
+// running one chain and shows what the budget check decides for budgets around the
+// cost of the two chains.
+static void BenchEffectSwitch(size_t blockSize)
+{
+    BlockOverdrive overdrive;
+    overdrive.Init();
+    overdrive.SetDrive(0.6f);
+    BlockTremolo tremolo;
+    tremolo.Init(kSampleRate);
+    tremolo.SetFreq(5.0f);
+
+    EffectChain<1> chainA, chainB;
+    chainA.Init();
+    chainA.SetSlot(0, &overdrive);
+    chainB.Init();
+    chainB.SetSlot(0, &tremolo);
+
+    // One chain, then both running as they do during a crossfade that never ends
+    EffectSwitcher switcher;
+    switcher.Init(nullptr, &chainA);
+    const double single = NsPerSample(blockSize, [&](const float* const* in, float** out, size_t size) {
+        switcher.Process(in, out, 2, size);
+    });
+    switcher.Switch(&chainB, ~(size_t)0, false, blockSize);
+    const double both = NsPerSample(blockSize, [&](const float* const* in, float** out, size_t size) {
+        switcher.Process(in, out, 2, size);
+    });
+
+    // Budgets with room for both chains, for the new chain, and not even for that.  The
+    // callback does nothing else, the meter has no blocks yet.
+    const float costA     = chainA.CostPerSample() * blockSize;
+    const float costB     = chainB.CostPerSample() * blockSize;
+    const float budgets[] = {1.1f * (costA + costB), 1.1f * costB, 0.5f * costB};
+    printf("switch   block %3zu   one chain %6.2f ns   crossfading %6.2f ns   budget for both",
+           blockSize,
+           single,
+           both);
+    for(float budget : budgets)
+    {
+        // The check allows EffectSwitcher::kMaxLoad of the budget
+        AudioLoadMeter meter;
+        meter.Init(1000000000.0f * EffectSwitcher::kMaxLoad / budget);
+        EffectSwitcher check;
+        check.Init(&meter, &chainA);
+        printf(" %s", SwitchModeName(check.Switch(&chainB, 480, false, blockSize)));
+        if(budget == budgets[0])
+            printf(", new only");
+        else if(budget == budgets[1])
+            printf(", too small");
+    }
+    printf("\n");
+}
+
+// Ideal position in MIDI clock ticks for a clock that starts at tickStart, runs at
+// tempo1 and changes to tempo2 at changeTime without a phase jump.
+struct ClockTimeline
+{
+    double tickStart, changeTime, rate1, rate2;
+
+    ClockTimeline(double start, double change, double tempo1, double tempo2)
+    : tickStart(start * kSampleRate),
+      changeTime(change * kSampleRate),
+      rate1(tempo1 * 24.0 / 60.0 / kSampleRate),
+      rate2(tempo2 * 24.0 / 60.0 / kSampleRate)
+    {
+    }
+
+    double Position(double sample) const
+    {
+        if(sample < changeTime)
+            return (sample - tickStart) * rate1;
+        return (changeTime - tickStart) * rate1 + (sample - changeTime) * rate2;
+    }
+
+    double TickTime(uint32_t tick) const
+    {
+        const double changeTick = (changeTime - tickStart) * rate1;
+        if(tick < changeTick)
+            return tickStart + tick / rate1;
+        return changeTime + (tick - changeTick) / rate2;
+    }
+};
+
+// Feeds MidiClockSync a clock that arrives up to maxDelayMs late at random, locks the
+// tremolo LFO to it and measures how far the LFO phase is from the ideal beat phase.
+static void BenchClockSync(float maxDelayMs)
+{
+    const size_t        blockSize = 4;
+    const double        seconds   = 20.0;
+    const double        change    = 10.0;
+    const ClockTimeline timeline(0.1, change, 120.0, 140.0);
+
+    MidiClockSync sync;
+    sync.Init(kSampleRate, nullptr);
+    sync.SetDivision(MidiClockSync::DIVISION_QUARTER);
+    sync.OnTransport(daisy::Start);
+
+    BlockTremolo tremolo;
+    tremolo.Init(kSampleRate);
+    float gain[blockSize];
+
+    uint32_t random = 12345;
+    uint32_t tick   = 0;
+    double   nextArrival = timeline.TickTime(0);
+
+    double steadySum = 0.0, steadySquares = 0.0, steadyMax = 0.0, changeMax = 0.0;
+    size_t steadyCount = 0;
+
+    for(uint32_t start = 0; start < seconds * kSampleRate; start += blockSize)
+    {
+        // Ticks that arrived while the previous block played
+        while(nextArrival < start)
+        {
+            sync.OnTick((uint32_t)nextArrival);
+            tick++;
+            random      = random * 1664525u + 1013904223u;
+            nextArrival = timeline.TickTime(tick)
+                          + (random >> 8) / 16777216.0 * maxDelayMs * kSampleRate / 1000.0;
+        }
+
+        if(sync.Update(start))
+        {
+            tremolo.SyncPhase(sync.CycleFreq(), sync.CyclePhase(start));
+
+            const double ideal = timeline.Position(start) / 24.0;
+            double error = tremolo.Phase() - (ideal - floor(ideal));
+            error -= floor(error + 0.5);
+            const double degrees = fabs(error) * 360.0;
+
+            // Let the loop settle after the clock starts and after the tempo change
+            const double time = start / kSampleRate;
+            if(time > change && time < change + 2.0)
+            {
+                changeMax = fmax(changeMax, degrees);
+            }
+            else if(time > 2.0)
+            {
+                steadySum += error * 360.0;
+                steadySquares += degrees * degrees;
+                steadyMax = fmax(steadyMax, degrees);
+                steadyCount++;
+            }
+        }
+        tremolo.ProcessGain(gain, blockSize);
+    }
+
+    printf("clock    delay %4.1f ms   phase error  mean %6.2f  rms %6.2f  max %6.2f deg   "
+           "120 -> 140 bpm max %6.2f deg\n",
+           maxDelayMs,
+           steadySum / steadyCount,
+           sqrt(steadySquares / steadyCount),
+           steadyMax,
+           changeMax);
+}
+
+// A sequence of footswitch taps and the tempo it should end up at
+struct TapSequence
+{
+    const char* name;
+    float       tempo;    /**< Beats per minute */
+    size_t      count;
+    float       taps[8];  /**< Seconds */
+};
+
+// Feeds TapTempo a sequence of taps at block size 4 and drives the tremolo LFO the way
+// the pedals do, new tempos start with a phase reset on the beat.  A tap is stamped at
+// the first switch scan after it, every scanSamples: every 1 ms for the control task the
+// pedals scan from, every 4 samples to compare.  The tapped tempo has to come out at the sequence's
+// tempo and the LFO has to stay on the beats after the last tempo started, the phase is
+// compared at the start of every block.
+static void BenchTapTempo(const TapSequence& sequence, size_t blockSize, uint32_t scanSamples)
+{
+    auto scanned = [&](size_t tap) {
+        const uint32_t sample = (uint32_t)(sequence.taps[tap] * kSampleRate + 0.5f);
+        return (sample + scanSamples - 1) / scanSamples * scanSamples;
+    };
+
+    TapTempo tapTempo;
+    tapTempo.Init(kSampleRate);
+
+    BlockTremolo tremolo;
+    tremolo.Init(kSampleRate);
+    tremolo.SetFreq(3.0f);
+    float gain[kMaxAudioBlockSize];
+
+    const uint32_t lastTap = scanned(sequence.count - 1);
+    const float    seconds = 4.0f;
+    const uint32_t end     = lastTap + (uint32_t)(seconds * kSampleRate);
+
+    size_t tap      = 0;
+    bool   settled  = false;
+    double maxError = 0.0;
+
+    for(uint32_t start = 0; start < end; start += blockSize)
+    {
+        // Split the block at the taps and the beat a new tempo starts on
+        size_t processed = 0;
+        while(true)
+        {
+            size_t     beatOffset;
+            const bool beatDue = tapTempo.NextBeat(start, blockSize, beatOffset);
+            const uint32_t tapSample = tap < sequence.count ? scanned(tap) : 0;
+            const bool tapDue = tap < sequence.count && tapSample < start + blockSize;
+            if(!beatDue && !tapDue)
+                break;
+
+            const size_t offset = tapDue && (!beatDue || tapSample - start < beatOffset) ? tapSample - start
+                                                                                         : beatOffset;
+            tremolo.ProcessGain(gain, offset - processed);
+            processed = offset;
+
+            if(offset == beatOffset && beatDue)
+            {
+                tapTempo.ApplyBeat();
+                tremolo.ResetPhase(0.0f);
+                tremolo.SetFreq(tapTempo.CycleFreq());
+                settled = start + offset > lastTap;
+            }
+            else
+            {
+                tapTempo.Tap(tapSample);
+                tap++;
+            }
+        }
+        tremolo.ProcessGain(gain, blockSize - processed);
+
+        if(settled)
+        {
+            double error = tremolo.Phase() - tapTempo.CyclePhase(start + blockSize);
+            error -= floor(error + 0.5);
+            maxError = fmax(maxError, fabs(error) * 360.0);
+        }
+    }
+
+    printf("tap      %-8s %zu taps   scan %4.2f ms   tempo %6.2f bpm (%6.2f)   period %8.1f samples   phase error max %5.3f deg over %.1f s\n",
+           sequence.name,
+           sequence.count,
+           scanSamples * 1000.0f / kSampleRate,
+           tapTempo.Tempo(),
+           sequence.tempo,
+           tapTempo.Period(),
+           maxError,
+           seconds);
+    Check(fabsf(tapTempo.Tempo() - sequence.tempo) <= 0.5f, "tapped tempo is off");
+    Check(maxError <= 0.5, "LFO drifts off the tapped beats");
+}
+
+// Restarts the sample clock the way the 125B's Audio menu does, with a footswitch press
+// on switch 2 and a Control Change still queued from the old timeline.  Both have to be
+// dropped, and a press on switch 1 and a Control Change after the restart have to be
+// applied where they were stamped.
+static void BenchRestart()
+{
+    const size_t        blockSize  = 48;
+    const MidiCcMapping mappings[] = {{MidiParamMap::kOmni, 15, 0}};
+
+    SampleClock      clock;
+    SwitchTimestamps switches;
+    MidiParamMap     midiMap;
+    clock.Init(kSampleRate);
+    switches.Init(2, kSampleRate);
+    midiMap.Init(mappings, 1, &clock);
+
+    daisy::MidiEvent controlChange;
+    controlChange.type    = daisy::ControlChange;
+    controlChange.data[0] = 15;
+
+    // Ten seconds in, both events are stamped one block ahead and the audio stops
+    for(uint32_t start = 0; start < 10 * (uint32_t)kSampleRate; start += blockSize)
+        clock.OnBlockStart(blockSize);
+    switches.Poll(1, true, clock.BlockStart() + blockSize);
+    controlChange.data[1] = 16;
+    midiMap.HandleMidiEvent(controlChange);
+
+    clock.Init(kSampleRate);
+    switches.Init(2, kSampleRate);
+    midiMap.Init(mappings, 1, &clock);
+
+    const uint32_t pressSample = 1000;
+    switches.Poll(0, true, pressSample);
+    controlChange.data[1] = 96;
+    midiMap.HandleMidiEvent(controlChange);
+
+    size_t   stale = 0;
+    long     pressApplied = -1, changeApplied = -1;
+    for(uint32_t start = 0; start < 2 * (uint32_t)kSampleRate; start += blockSize)
+    {
+        clock.OnBlockStart(blockSize);
+        SwitchEvent switchEvent;
+        ParamEvent  paramEvent;
+        size_t      offset;
+        while(switches.PopDueEvent(start, blockSize, switchEvent, offset))
+        {
+            stale += switchEvent.index != 0 ? 1 : 0;
+            pressApplied = switchEvent.index == 0 ? (long)(start + offset) : pressApplied;
+        }
+        while(midiMap.PopDueEvent(start, blockSize, paramEvent, offset))
+        {
+            stale += paramEvent.value < 0.5f ? 1 : 0;
+            changeApplied = paramEvent.value >= 0.5f ? (long)(start + offset) : changeApplied;
+        }
+    }
+
+    printf("restart  block %3zu   %zu stale events applied   press at %ld (%u)   control change at %ld (0)\n",
+           blockSize,
+           stale,
+           pressApplied,
+           pressSample,
+           changeApplied);
+    Check(stale == 0 && pressApplied == (long)pressSample && changeApplied == 0,
+          "events queued before an audio restart hold up the ones after it");
+}
+
+// The 125B's per-sample mute and relay countdown, as it was before MuteRelayScheduler
+struct MuteRelayCountdown
+{
+    bool muteOn = false, bypassOn = false;
+    int  samplesTilMuteOff = 0, samplesTilBypassToggle = 0;
+
+    void Start(int muteSamples, int relaySamples, size_t offset)
+    {
+        muteOn                 = true;
+        samplesTilMuteOff      = muteSamples + (int)offset;
+        samplesTilBypassToggle = relaySamples + (int)offset;
+    }
+
+    void Process(bool effectOn, size_t size)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            if(muteOn)
+            {
+                samplesTilMuteOff -= 1;
+                samplesTilBypassToggle -= 1;
+                if(samplesTilMuteOff < 0)
+                    muteOn = false;
+                if(samplesTilBypassToggle < 0)
+                    bypassOn = !effectOn;
+            }
+        }
+    }
+};
+
+// Times the mute and relay timing per block against the per-sample countdown it
+// replaced, with the effect toggled every 100 ms at odd offsets.  Both have to switch
+// the outputs in the same blocks.
+static void BenchMuteRelay(size_t blockSize)
+{
+    const float  muteSeconds = 0.02f, relaySeconds = 0.01f;
+    const int    muteSamples  = (int)(kSampleRate * muteSeconds);
+    const int    relaySamples = (int)(kSampleRate * relaySeconds);
+    const size_t togglePeriod = 4801;
+
+    MuteRelayCountdown countdown;
+    MuteRelayScheduler scheduler;
+    scheduler.Init(kSampleRate, muteSeconds, relaySeconds);
+
+    size_t mismatches = 0;
+    bool   effectOn   = false;
+    for(uint32_t start = 0; start < kSampleRate * 20; start += blockSize)
+    {
+        const size_t offset = togglePeriod - start % togglePeriod;
+        if(offset < blockSize)
+        {
+            effectOn = !effectOn;
+            countdown.Start(muteSamples, relaySamples, offset);
+            scheduler.Start(start + offset, !effectOn);
+        }
+
+        countdown.Process(effectOn, blockSize);
+        while(scheduler.NextChange(start, blockSize))
+        {
+            scheduler.ApplyChange();
+        }
+        mismatches += countdown.muteOn != scheduler.MuteOn()
+                      || countdown.bypassOn != scheduler.BypassOn();
+    }
+
+    uint32_t start     = 0;
+    double   perSample = NsPerSample(blockSize, [&](const float* const*, float** out, size_t size) {
+        if(start % togglePeriod < size)
+            countdown.Start(muteSamples, relaySamples, 0);
+        countdown.Process(true, size);
+        out[1][size - 1] = countdown.muteOn ? 1.0f : 0.0f;
+        start += size;
+    });
+    start            = 0;
+    double perBlock  = NsPerSample(blockSize, [&](const float* const*, float** out, size_t size) {
+        if(start % togglePeriod < size)
+            scheduler.Start(start, false);
+        while(scheduler.NextChange(start, size))
+        {
+            scheduler.ApplyChange();
+        }
+        out[1][size - 1] = scheduler.MuteOn() ? 1.0f : 0.0f;
+        start += size;
+    });
+
+    printf("mute     block %3zu   per-sample %6.3f ns   scheduled %6.3f ns   %zu mismatched blocks\n",
+           blockSize,
+           perSample,
+           perBlock,
+           mismatches);
+    Check(mismatches == 0, "mute and relay scheduled in different blocks than the countdown");
+}
+
+// ADC readings of a knob with roughly gaussian noise, the sum of four uniform values
+struct NoisyAdc
+{
+    uint32_t random = 12345;
+
+    uint16_t Read(float position, float noise)
+    {
+        float sum = 0.0f;
+        for(int i = 0; i < 4; i++)
+        {
+            random = random * 1664525u + 1013904223u;
+            sum += (float)(random >> 8) / 16777216.0f - 0.5f;
+        }
+        const float value = position + noise * sum / 0.57735f;
+        return (uint16_t)(fminf(fmaxf(value, 0.0f), 1.0f) * 65535.0f);
+    }
+};
+
+// The hysteresis the programs read AnalogControl through before the knob front end,
+// only reports a reading that moved further than the threshold
+struct KnobHysteresis
+{
+    float threshold = 0.0f;
+    float value     = 0.0f;
+    bool  primed    = false;
+
+    bool Update(float reading)
+    {
+        if(primed && fabsf(reading - value) <= threshold)
+            return false;
+
+        value  = reading;
+        primed = true;
+        return true;
+    }
+};
+
+// What a knob reports over a stretch of scans
+struct KnobReport
+{
+    size_t changes  = 0;
+    float  minValue = 1.0f, maxValue = 0.0f, maxError = 0.0f, value = 0.0f;
+
+    void Add(bool changed, float reported, float position)
+    {
+        changes += changed;
+        value    = reported;
+        minValue = fminf(minValue, reported);
+        maxValue = fmaxf(maxValue, reported);
+        maxError = fmaxf(maxError, fabsf(reported - position));
+    }
+};
+
+// Feeds noisy readings of one knob at the 1kHz control rate to the knob handling the
+// programs had, AnalogControl's slew filter read through a KnobHysteresis, and to the
+// knob front end.  An untouched knob shouldn't report changes or jitter, a knob turned
+// from end to end in a second should follow closely and reach both ends.
+static void BenchKnobs(float noise)
+{
+    const float controlRate = 1000.0f, threshold = 0.002f;
+
+    uint16_t      raw = 0;
+    daisy::AnalogControl control;
+    control.Init(&raw, controlRate);
+    KnobHysteresis hysteresis;
+    hysteresis.threshold = threshold;
+    KnobFrontEnd<1> frontEnd;
+    frontEnd.Init(threshold);
+
+    NoisyAdc   adc;
+    KnobReport slewIdle, slewSweep, frontIdle, frontSweep;
+    uint32_t   version = 0;
+    float      ends[2] = {0.0f, 0.0f};
+
+    // Settle on the idle position, then 10 seconds untouched, then turned down to 0 and up
+    // to 1 over a second each, holding at the ends for half a second
+    for(size_t scan = 0; scan < 14000; scan++)
+    {
+        float position = 0.37f;
+        if(scan >= 11000 && scan < 11500)
+            position = 0.37f * (1.0f - (scan - 11000) / 500.0f);
+        else if(scan >= 11500 && scan < 12000)
+            position = 0.0f;
+        else if(scan >= 12000 && scan < 13000)
+            position = (scan - 12000) / 1000.0f;
+        else if(scan >= 13000)
+            position = 1.0f;
+
+        raw = adc.Read(position, noise);
+        control.Process();
+        const bool slewChanged = hysteresis.Update(control.Value());
+        frontEnd.Process(&raw);
+        const bool frontChanged = frontEnd.Version() != version;
+        version                 = frontEnd.Version();
+
+        if(scan >= 1000 && scan < 11000)
+        {
+            slewIdle.Add(slewChanged, hysteresis.value, position);
+            frontIdle.Add(frontChanged, frontEnd.Value(0), position);
+        }
+        else if(scan >= 11000)
+        {
+            slewSweep.Add(slewChanged, hysteresis.value, position);
+            frontSweep.Add(frontChanged, frontEnd.Value(0), position);
+        }
+        if(scan == 11999)
+        {
+            ends[0] = hysteresis.value;
+            ends[1] = frontEnd.Value(0);
+        }
+    }
+
+    printf("knobs    noise %.4f   idle changes %4zu / %zu  jitter %.4f / %.4f   turned changes %4zu / %zu  "
+           "error %.4f / %.4f   ends %.4f %.4f / %.4f %.4f\n",
+           noise,
+           slewIdle.changes,
+           frontIdle.changes,
+           slewIdle.maxValue - slewIdle.minValue,
+           frontIdle.maxValue - frontIdle.minValue,
+           slewSweep.changes,
+           frontSweep.changes,
+           slewSweep.maxError,
+           frontSweep.maxError,
+           ends[0],
+           slewSweep.value,
+           ends[1],
+           frontSweep.value);
+
+    // Up to the noise of the Seed's ADC, about 0.001, an untouched knob has to stay
+    // quiet.  Up to twice that a turned knob has to follow and reach both ends.
+    if(noise <= 0.001f)
+        Check(frontIdle.changes <= 20, "knob front end reports an untouched knob as turned");
+    if(noise <= 0.002f)
+    {
+        Check(frontSweep.maxError <= 0.01f, "knob front end lags a turned knob");
+        Check(fabsf(ends[1]) <= 0.001f && fabsf(1.0f - frontSweep.value) <= 0.001f,
+              "knob front end doesn't reach the ends");
+    }
+}
+
+// Latencies measured by the probe in BenchLatencyProbe()
+static std::vector<uint32_t> probeLatencies;
+
+// Runs the latency probe through a simulated patch cable: a delay, the converters'
+// filtering as a one pole lowpass, noise and optionally an inverted signal.  Every marker
+// has to come back with exactly the cable's delay.
+static void BenchLatencyProbe(uint32_t delay, float noise, bool invert)
+{
+    const size_t   blockSize  = 4;
+    const uint32_t numSamples = (uint32_t)(kSampleRate * 10);
+
+    LatencyProbe probe;
+    probe.Init(kSampleRate);
+    probeLatencies.clear();
+    LatencyProbe::HostSetObserver([](uint32_t latency) { probeLatencies.push_back(latency); });
+
+    // Everything played, the cable returns it delay samples later, delay >= blockSize
+    std::vector<float> played(numSamples, 0.0f);
+    float              in[blockSize];
+    float              lowpass = 0.0f;
+    uint32_t           random  = 12345;
+
+    for(uint32_t start = 0; start < numSamples; start += blockSize)
+    {
+        for(size_t i = 0; i < blockSize; i++)
+        {
+            random = random * 1664525u + 1013904223u;
+            const float hiss = noise * ((float)(random >> 8) / 8388608.0f - 1.0f);
+            in[i]            = (start + i >= delay ? played[start + i - delay] : 0.0f) + hiss;
+        }
+        probe.Process(in, &played[start], blockSize);
+
+        for(size_t i = 0; i < blockSize; i++)
+        {
+            lowpass += (played[start + i] - lowpass) * 0.7f;
+            played[start + i] = invert ? -lowpass : lowpass;
+        }
+    }
+    LatencyProbe::HostSetObserver(nullptr);
+
+    size_t wrong = 0;
+    for(uint32_t latency : probeLatencies)
+    {
+        wrong += latency != delay;
+    }
+
+    printf("latency  cable %4u  noise %.2f%s   %3u markers, %u lost   min %4u avg %6.1f max %4u "
+           "samples (%.0f us)   %zu wrong\n",
+           delay,
+           noise,
+           invert ? " inverted" : "         ",
+           probe.Count(),
+           probe.Timeouts(),
+           probe.MinSamples(),
+           probe.AvgSamples(),
+           probe.MaxSamples(),
+           probe.AvgSamples() * 1e6 / kSampleRate,
+           wrong);
+    Check(probe.Count() > 0 && probe.Timeouts() == 0 && wrong == 0,
+          "latency markers lost or measured with the wrong delay");
+}
+
+// Saves a counter to a fresh store, cutting the power part way through the last save.
+// Returns the counter that loads afterwards, or -1 if nothing valid was found.
+static int PresetAfterPowerCut(size_t saves, long cutAfterBytes)
+{
+    const uint32_t offset = 0x7FC000;
+    const size_t   sectors = 4;
+
+    daisy::QSPIHandle qspi;
+    PresetStore       store;
+    store.Init(&qspi, offset, sectors);
+    for(uint32_t value = 0; value + 1 < saves; value++)
+        store.Save(&value, sizeof(value), 1);
+
+    qspi.HostCutPowerAfter(cutAfterBytes);
+    const uint32_t last = saves - 1;
+    store.Save(&last, sizeof(last), 1);
+    qspi.HostCutPowerAfter(-1);
+
+    // Power up again, the store has to carry on saving after whatever the cut left.
+    PresetStore rebooted;
+    rebooted.Init(&qspi, offset, sectors);
+    uint32_t loaded;
+    uint8_t  version;
+    if(rebooted.Load(&loaded, sizeof(loaded), version) != sizeof(loaded) || version != 1)
+        return -1;
+
+    const uint32_t next = 1000;
+    PresetStore    again;
+    if(!rebooted.Save(&next, sizeof(next), 1))
+        return -1;
+    again.Init(&qspi, offset, sectors);
+    uint32_t check = 0;
+    again.Load(&check, sizeof(check), version);
+    return check == next ? (int)loaded : -1;
+}
+
+// Checks the preset log recovers from a power cut at every byte of a save, in the
+// middle of a sector and when the save has to erase the next sector first, then times
+// loading a full log at startup.
+static void BenchPresetStore()
+{
+    const size_t slotsPerSector = 4096 / PresetStore::kSlotSize;
+    const size_t saveCounts[]   = {1, 40, slotsPerSector + 1, 4 * slotsPerSector + 1};
+    const long   recordSize     = PresetStore::kHeaderSize + sizeof(uint32_t);
+
+    size_t cuts = 0, failures = 0;
+    for(size_t saves : saveCounts)
+    {
+        for(long cut = 0; cut <= recordSize; cut++)
+        {
+            // Until the whole record is written the previous one has to load.
+            const int expected = cut == recordSize ? (int)saves - 1 : (int)saves - 2;
+            const int loaded   = PresetAfterPowerCut(saves, cut);
+            failures += (loaded != expected && !(expected < 0 && loaded < 0)) ? 1 : 0;
+            cuts++;
+        }
+    }
+
+    // A full log, every slot of every sector has been used at least once.
+    daisy::QSPIHandle qspi;
+    PresetStore       store;
+    store.Init(&qspi, 0x7FC000, 4);
+    for(uint32_t value = 0; value < 5 * slotsPerSector; value++)
+        store.Save(&value, sizeof(value), 1);
+
+    const int runs  = 1000;
+    auto      begin = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; i++)
+    {
+        store.Init(&qspi, 0x7FC000, 4);
+        sink = (float)store.Sequence();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    printf("preset   %zu power cuts, %zu bad loads   load %zu slots in %.1f us   %zu erases for %zu saves\n",
+           cuts,
+           failures,
+           store.SlotsScanned(),
+           std::chrono::duration<double, std::micro>(end - begin).count() / runs,
+           qspi.HostEraseCount(),
+           5 * slotsPerSector);
+    Check(failures == 0, "preset loaded wrong after a power cut");
+}
+
+int main(int argc, char** argv)
+{
+    const size_t blockSizes[] = {1, 4, 16, 48, 256};
+    for(size_t blockSize : blockSizes)
+    {
+        BenchTremolo(blockSize);
+    }
+    BenchWavetableLfo(4);
+    BenchHarmonicTremolo(4);
+    BenchStereoTremolo(4);
+
+    for(size_t blockSize : blockSizes)
+    {
+        BenchEffectChain(blockSize);
+    }
+
+    for(size_t blockSize : blockSizes)
+    {
+        BenchEffectSwitch(blockSize);
+    }
+    printf("switch   largest step at the switch   hard %.3f   dip %.3f   crossfade %.3f\n",
+           SwitchStep(2, false),
+           SwitchStep(1440, true),
+           SwitchStep(1440, false));
+
+    const float clockDelaysMs[] = {0.0f, 1.0f, 2.0f, 5.0f};
+    for(float delayMs : clockDelaysMs)
+    {
+        BenchClockSync(delayMs);
+    }
+
+    // Steady taps, taps a few ms off, a tap well off the beat and the one after it, a
+    // bounce, a change of tempo without a pause and a new tempo after a pause
+    const TapSequence tapSequences[] = {
+        {"steady", 120.0f, 4, {0.5f, 1.0f, 1.5f, 2.0f}},
+        {"jitter", 100.0f, 6, {0.5f, 1.108f, 1.693f, 2.305f, 2.898f, 3.5f}},
+        {"late", 90.0f, 6, {0.5f, 1.1667f, 1.8333f, 2.7f, 3.1667f, 3.8333f}},
+        {"bounce", 120.0f, 5, {0.5f, 0.58f, 1.0f, 1.5f, 2.0f}},
+        {"change", 80.0f, 7, {0.5f, 1.0f, 1.5f, 2.0f, 2.75f, 3.5f, 4.25f}},
+        {"pause", 150.0f, 6, {0.5f, 1.0f, 1.5f, 5.0f, 5.4f, 5.8f}},
+    };
+    // Scanned every 4 samples and every 1 ms, as the control task does
+    const uint32_t tapScans[] = {4, 48};
+    for(uint32_t scanSamples : tapScans)
+    {
+        for(const TapSequence& sequence : tapSequences)
+        {
+            BenchTapTempo(sequence, 4, scanSamples);
+        }
+    }
+
+    for(size_t blockSize : blockSizes)
+    {
+        BenchMuteRelay(blockSize);
+    }
+
+    const float knobNoise[] = {0.0005f, 0.001f, 0.002f, 0.004f};
+    for(float noise : knobNoise)
+    {
+        BenchKnobs(noise);
+    }
+
+    BenchLatencyProbe(8, 0.0f, false);
+    BenchLatencyProbe(107, 0.05f, false);
+    BenchLatencyProbe(555, 0.1f, true);
+
+    BenchRestart();
+    BenchPresetStore();
+
+    if(failedChecks > 0)
+    {
+        printf("%zu checks failed\n", failedChecks);
+        return 1;
+    }
+    return 0;
+}
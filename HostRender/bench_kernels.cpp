@@ -0,0 +1,707 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "daisy_seed.h"
+#include "daisysp.h"
+#include "audio_block.h"
+#include "block_tremolo.h"
+#include "block_overdrive.h"
+#include "block_delay.h"
+#include "control_rate.h"
+#include "effect_chain.h"
+#include "effect_switcher.h"
+#include "knob_front_end.h"
+#include "mute_relay_scheduler.h"
+#include "sample_clock.h"
+#include "wavetable_lfo.h"
+
+using namespace daisy;
+using namespace daisysp;
+using namespace bkshepherd;
+
+// Sweeps the DSP kernels used by the pedal programs over block sizes and sample rates.
+//
+// Every kernel is run on its own and as part of the 125B callback's audio path, with a
+// warm-up pass and a number of timed repeats for each block size and sample rate.  The
+// table shows the median, the spread and the throughput, -o writes the same numbers as
+// CSV so runs from different commits can be kept side by side, and -c compares a run
+// with one of those files and fails if a kernel got slower.
+
+static const size_t kBlockSizes[]  = {1, 2, 4, 8, 16, 32, 48, 64, 128, 256};
+static const float  kSampleRates[] = {32000.0f, 48000.0f, 96000.0f};
+
+// Keeps the optimizer from throwing the benchmarked work away.
+static volatile float sink;
+
+struct SweepOptions
+{
+    size_t              repeats        = 7;
+    float               warmupSeconds  = 0.25f; /**< Audio time run before timing */
+    float               repeatSeconds  = 1.0f;  /**< Audio time per timed repeat */
+    std::vector<size_t> blockSizes;
+    std::vector<float>  sampleRates;
+    std::vector<std::string> kernels; /**< Empty runs every kernel */
+};
+
+/** Statistics over the repeats of one measurement, in ns per sample */
+struct Measurement
+{
+    double median, min, max, stddev;
+};
+
+// Guitar-like test input, a decaying 110Hz note with some noise, long enough that the
+// kernels don't see the same samples every block.
+static std::vector<float> inputLeft, inputRight;
+
+static void MakeInput(float sampleRate)
+{
+    const size_t length = (size_t)sampleRate + kMaxAudioBlockSize;
+    inputLeft.resize(length);
+    inputRight.resize(length);
+    uint32_t noise = 1;
+    for(size_t i = 0; i < length; i++)
+    {
+        noise          = noise * 1664525u + 1013904223u;
+        const float t  = float(i) / sampleRate;
+        const float n  = (float(noise >> 8) / 8388608.0f - 1.0f) * 0.01f;
+        inputLeft[i]   = 0.5f * expf(-2.0f * t) * sinf(6.2831853f * 110.0f * t) + n;
+        inputRight[i]  = 0.5f * expf(-2.0f * t) * sinf(6.2831853f * 110.0f * t + 0.5f) - n;
+    }
+}
+
+/** Runs a kernel over a number of samples, one block at a time */
+template <typename Kernel>
+static double RunBlocks(size_t blockSize, size_t numSamples, size_t& position, Kernel& kernel)
+{
+    float        outLeft[kMaxAudioBlockSize], outRight[kMaxAudioBlockSize];
+    float*       out[2]    = {outLeft, outRight};
+    const size_t numBlocks = (numSamples + blockSize - 1) / blockSize;
+    const size_t wrap      = inputLeft.size() - kMaxAudioBlockSize;
+
+    auto begin = std::chrono::steady_clock::now();
+    for(size_t b = 0; b < numBlocks; b++)
+    {
+        const float* in[2] = {&inputLeft[position], &inputRight[position]};
+        kernel(in, out, blockSize);
+        sink     = out[1][blockSize - 1];
+        position = (position + blockSize) % wrap;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - begin).count()
+           / double(numBlocks * blockSize);
+}
+
+/** Times a kernel after a warm-up pass, every repeat runs the same amount of audio */
+template <typename Kernel>
+static Measurement Measure(const SweepOptions& options, float sampleRate, size_t blockSize, Kernel kernel)
+{
+    size_t position = 0;
+    RunBlocks(blockSize, (size_t)(options.warmupSeconds * sampleRate), position, kernel);
+
+    std::vector<double> runs;
+    for(size_t r = 0; r < options.repeats; r++)
+    {
+        runs.push_back(RunBlocks(blockSize, (size_t)(options.repeatSeconds * sampleRate), position, kernel));
+    }
+    std::sort(runs.begin(), runs.end());
+
+    double mean = 0.0, variance = 0.0;
+    for(double run : runs)
+        mean += run / runs.size();
+    for(double run : runs)
+        variance += (run - mean) * (run - mean) / runs.size();
+
+    const size_t middle = runs.size() / 2;
+    Measurement  result;
+    result.median = runs.size() % 2 ? runs[middle] : 0.5 * (runs[middle - 1] + runs[middle]);
+    result.min    = runs.front();
+    result.max    = runs.back();
+    result.stddev = sqrt(variance);
+    return result;
+}
+
+// Delay lines for the delay kernels, a second at 96kHz
+static float delayBuffer[2][131072];
+
+static void InitDelay(BlockDelay& delay, float sampleRate)
+{
+    float* buffers[2] = {delayBuffer[0], delayBuffer[1]};
+    delay.Init(sampleRate, buffers, 2, 131072);
+    delay.SetTime(0.35f);
+    delay.SetFeedback(0.5f);
+}
+
+static Measurement BenchTremolo(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockTremolo tremolo;
+    tremolo.Init(sampleRate);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        tremolo.Process(in, out, 2, size);
+    });
+}
+
+static Measurement BenchHarmonicTremolo(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockTremolo tremolo;
+    tremolo.Init(sampleRate);
+    tremolo.SetMode(BlockTremolo::MODE_HARMONIC);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        tremolo.Process(in, out, 2, size);
+    });
+}
+
+// The per-sample daisysp::Oscillator, the 125B's rate modulation and the old tremolo LFO
+static Measurement BenchOscillator(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    Oscillator osc;
+    osc.Init(sampleRate);
+    osc.SetAmp(1.0f);
+    osc.SetFreq(5.0f);
+    return Measure(options, sampleRate, blockSize, [&](const float* const*, float** out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[1][i] = osc.Process();
+        }
+    });
+}
+
+static Measurement BenchWavetable(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    WavetableLfo lfo;
+    lfo.Init(sampleRate, 16);
+    lfo.SetFreq(5.0f);
+    return Measure(options, sampleRate, blockSize, [&](const float* const*, float** out, size_t size) {
+        lfo.ProcessBlock(out[1], size);
+    });
+}
+
+// One daisy::Parameter curve per sample, reading a knob through the AnalogControl slew
+static uint16_t parameterAdc = 40000;
+
+static Measurement BenchParameter(const SweepOptions& options, float sampleRate, size_t blockSize, Parameter::Curve curve)
+{
+    AnalogControl control;
+    control.Init(&parameterAdc, sampleRate);
+    Parameter parameter;
+    parameter.Init(control, 0.01f, 20.0f, curve);
+    return Measure(options, sampleRate, blockSize, [&](const float* const*, float** out, size_t size) {
+        for(size_t i = 0; i < size; i++)
+        {
+            out[1][i] = parameter.Process();
+        }
+    });
+}
+
+static Measurement BenchParameterLinear(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    return BenchParameter(options, sampleRate, blockSize, Parameter::LINEAR);
+}
+
+static Measurement BenchParameterExp(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    return BenchParameter(options, sampleRate, blockSize, Parameter::EXPONENTIAL);
+}
+
+static Measurement BenchParameterLog(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    return BenchParameter(options, sampleRate, blockSize, Parameter::LOGARITHMIC);
+}
+
+static Measurement BenchParameterCube(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    return BenchParameter(options, sampleRate, blockSize, Parameter::CUBE);
+}
+
+// The 1590B's dry / wet crossfade on a tremolo gain curve, fading over and over
+static Measurement BenchCrossfade(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockTremolo tremolo;
+    tremolo.Init(sampleRate);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+
+    const size_t fadeSamples = (size_t)(0.25f * sampleRate);
+    size_t       position    = 0;
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        float wet[kMaxAudioBlockSize], gain[kMaxAudioBlockSize];
+        for(size_t i = 0; i < size; i++)
+        {
+            wet[i] = fminf((float)(position + i) / (float)fadeSamples, 1.0f);
+        }
+        position = (position + size) % fadeSamples;
+
+        tremolo.ProcessGain(gain, size);
+        CrossfadeGainBlock(gain, wet, size);
+        MultiplyBlock(out[0], in[0], gain, size);
+        MultiplyBlock(out[1], in[1], gain, size);
+    });
+}
+
+static Measurement BenchOverdrive(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockOverdrive overdrive;
+    overdrive.Init();
+    overdrive.SetDrive(0.6f);
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        overdrive.ProcessBlock(in, out, 2, size);
+    });
+}
+
+static Measurement BenchDelay(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockDelay delay;
+    InitDelay(delay, sampleRate);
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        delay.ProcessBlock(in, out, 2, size);
+    });
+}
+
+// The 125B's overdrive -> tremolo -> delay chain
+static Measurement BenchChain(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockOverdrive overdrive;
+    overdrive.Init();
+    overdrive.SetDrive(0.6f);
+    BlockTremolo tremolo;
+    tremolo.Init(sampleRate);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+    BlockDelay delay;
+    InitDelay(delay, sampleRate);
+
+    EffectChain<3> chain;
+    chain.Init();
+    chain.SetSlot(0, &overdrive);
+    chain.SetSlot(1, &tremolo);
+    chain.SetSlot(2, &delay);
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        chain.Process(in, out, 2, size);
+    });
+}
+
+// An EffectSwitcher crossfading between two chains for as long as it runs
+static Measurement BenchSwitch(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockOverdrive overdrive;
+    overdrive.Init();
+    overdrive.SetDrive(0.6f);
+    BlockTremolo tremolo;
+    tremolo.Init(sampleRate);
+    tremolo.SetFreq(5.0f);
+
+    EffectChain<1> chainA, chainB;
+    chainA.Init();
+    chainA.SetSlot(0, &overdrive);
+    chainB.Init();
+    chainB.SetSlot(0, &tremolo);
+
+    EffectSwitcher switcher;
+    switcher.Init(nullptr, &chainA);
+    switcher.Switch(&chainB, ~(size_t)0, false, blockSize);
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        switcher.Process(in, out, 2, size);
+    });
+}
+
+// The audio path of the 125B callback: the sample clock, the 1kHz control updates with
+// the knobs moving, the modulated tremolo rate, the effect chain behind its switcher and
+// the mute and relay deadlines, with the footswitch toggled twice a second.  The menus,
+// MIDI and the GPIOs are left out, they cost next to nothing per block.
+static Measurement BenchCallback(const SweepOptions& options, float sampleRate, size_t blockSize)
+{
+    BlockOverdrive overdrive;
+    overdrive.Init();
+    overdrive.SetDrive(0.6f);
+    BlockTremolo tremolo;
+    tremolo.Init(sampleRate);
+    tremolo.SetFreq(5.0f);
+    tremolo.SetDepth(0.8f);
+    BlockDelay delay;
+    InitDelay(delay, sampleRate);
+
+    EffectChain<3> chain;
+    chain.Init();
+    chain.SetSlot(0, &overdrive);
+    chain.SetSlot(1, &tremolo);
+    chain.SetSlot(2, &delay);
+    EffectSwitcher switcher;
+    switcher.Init(nullptr, &chain);
+
+    Oscillator freqOsc;
+    freqOsc.Init(sampleRate);
+    freqOsc.SetAmp(0.5f);
+    freqOsc.SetFreq(1.0f);
+
+    SampleClock          sampleClock;
+    ControlRateScheduler controlRate;
+    MuteRelayScheduler   muteRelay;
+    KnobFrontEnd<4>      knobs; // Depth, rate, drive and time
+    uint32_t             appliedVersions[4] = {};
+    sampleClock.Init(sampleRate);
+    controlRate.Init(sampleRate, 1000.0f);
+    muteRelay.Init(sampleRate, 0.02f, 0.01f);
+    knobs.Init(0.002f);
+    auto knobChanged = [&](size_t knob) {
+        const bool changed    = knobs.Version(knob) != appliedVersions[knob];
+        appliedVersions[knob] = knobs.Version(knob);
+        return changed;
+    };
+
+    const uint32_t togglePeriod = (uint32_t)(0.5f * sampleRate);
+    uint32_t       nextToggle   = togglePeriod;
+    bool           effectOn     = true;
+    return Measure(options, sampleRate, blockSize, [&](const float* const* in, float** out, size_t size) {
+        sampleClock.OnBlockStart(size);
+        const uint32_t blockStart = sampleClock.BlockStart();
+
+        if(controlRate.Tick(size))
+        {
+            // Knobs turned slowly back and forth through the knob front end, a new value
+            // every few updates
+            const float    seconds     = float(blockStart) / sampleRate;
+            const float    reading     = 0.5f + 0.5f * sinf(6.2831853f * 0.25f * seconds);
+            const uint16_t adc         = (uint16_t)(reading * 65535.0f);
+            const uint16_t readings[4] = {adc, adc, (uint16_t)(65535 - adc), adc};
+            const size_t   ramp        = controlRate.RampSamples();
+            knobs.Process(readings);
+            if(knobChanged(0))
+                tremolo.SetDepth(knobs.Value(0), ramp);
+            if(knobChanged(2))
+                overdrive.SetDrive(knobs.Value(2), ramp);
+            if(knobChanged(3))
+                delay.SetTime(0.05f + knobs.Value(3) * 0.95f, ramp);
+            tremolo.SetFreq((0.2f + knobs.Value(1) * 15.8f) * (1.0f + freqOsc.Process()));
+        }
+
+        if(effectOn)
+        {
+            switcher.Process(in, out, 2, size);
+        }
+        else
+        {
+            CopyBlock(out[0], in[0], size);
+            CopyBlock(out[1], in[1], size);
+        }
+
+        if((int32_t)(blockStart + size - nextToggle) > 0)
+        {
+            effectOn = !effectOn;
+            muteRelay.Start(nextToggle, !effectOn);
+            nextToggle += togglePeriod;
+        }
+        while(muteRelay.NextChange(blockStart, size))
+        {
+            muteRelay.ApplyChange();
+        }
+        sink = muteRelay.MuteOn() ? 0.0f : 1.0f;
+    });
+}
+
+typedef Measurement (*KernelBench)(const SweepOptions& options, float sampleRate, size_t blockSize);
+
+struct Kernel
+{
+    const char* name;
+    KernelBench bench;
+};
+
+static const Kernel kKernels[] = {
+    {"tremolo", BenchTremolo},
+    {"tremolo-harmonic", BenchHarmonicTremolo},
+    {"oscillator", BenchOscillator},
+    {"wavetable", BenchWavetable},
+    {"param-linear", BenchParameterLinear},
+    {"param-exp", BenchParameterExp},
+    {"param-log", BenchParameterLog},
+    {"param-cube", BenchParameterCube},
+    {"crossfade", BenchCrossfade},
+    {"overdrive", BenchOverdrive},
+    {"delay", BenchDelay},
+    {"chain", BenchChain},
+    {"switch", BenchSwitch},
+    {"callback", BenchCallback},
+};
+
+/** One row of the results, the same fields as the CSV file */
+struct Result
+{
+    std::string kernel;
+    float       sampleRate;
+    size_t      blockSize;
+    Measurement ns;
+};
+
+static const char* kCsvHeader
+    = "label,kernel,sample_rate,block_size,repeats,ns_median,ns_min,ns_max,ns_stddev,msamples_per_s,"
+      "realtime_pct\n";
+
+static void WriteCsv(FILE* file, const char* label, size_t repeats, const std::vector<Result>& results)
+{
+    fputs(kCsvHeader, file);
+    for(const Result& result : results)
+    {
+        fprintf(file,
+                "%s,%s,%.0f,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.4f\n",
+                label,
+                result.kernel.c_str(),
+                result.sampleRate,
+                result.blockSize,
+                repeats,
+                result.ns.median,
+                result.ns.min,
+                result.ns.max,
+                result.ns.stddev,
+                1000.0 / result.ns.median,
+                result.ns.median * result.sampleRate / 1e7);
+    }
+}
+
+/** Reads the results back from a CSV file written by -o
+\return false if the file can't be read
+*/
+static bool ReadCsv(const char* path, std::vector<Result>& results)
+{
+    FILE* file = fopen(path, "r");
+    if(!file)
+        return false;
+
+    char line[512];
+    while(fgets(line, sizeof(line), file))
+    {
+        char   label[128], kernel[64];
+        Result result;
+        if(sscanf(line,
+                  "%127[^,],%63[^,],%f,%zu,%*u,%lf,%lf,%lf,%lf",
+                  label,
+                  kernel,
+                  &result.sampleRate,
+                  &result.blockSize,
+                  &result.ns.median,
+                  &result.ns.min,
+                  &result.ns.max,
+                  &result.ns.stddev)
+           == 8)
+        {
+            result.kernel = kernel;
+            results.push_back(result);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+/** Compares the medians with a baseline run, prints every kernel that got slower
+\return number of results more than tolerancePct slower than the baseline
+*/
+static size_t CompareBaseline(FILE*                      report,
+                              const std::vector<Result>& results,
+                              const std::vector<Result>& baseline,
+                              float                      tolerancePct)
+{
+    size_t matched = 0, slower = 0;
+    for(const Result& result : results)
+    {
+        for(const Result& base : baseline)
+        {
+            if(base.kernel != result.kernel || base.sampleRate != result.sampleRate
+               || base.blockSize != result.blockSize)
+                continue;
+
+            matched++;
+            const double change = 100.0 * (result.ns.median / base.ns.median - 1.0);
+            if(change > tolerancePct)
+            {
+                slower++;
+                fprintf(report,
+                        "slower   %-16s %6.0f Hz  block %3zu   %8.2f ns -> %8.2f ns   %+.1f%%\n",
+                       result.kernel.c_str(),
+                       result.sampleRate,
+                       result.blockSize,
+                       base.ns.median,
+                       result.ns.median,
+                       change);
+            }
+            break;
+        }
+    }
+    fprintf(report,
+            "Baseline compare: %zu of %zu results matched, %zu more than %.1f%% slower\n",
+           matched,
+           results.size(),
+           slower,
+           tolerancePct);
+    return slower;
+}
+
+template <typename T>
+static std::vector<T> ParseList(const char* list)
+{
+    std::vector<T> values;
+    for(const char* p = list; *p;)
+    {
+        values.push_back((T)strtod(p, nullptr));
+        p = strchr(p, ',');
+        if(!p)
+            break;
+        p++;
+    }
+    return values;
+}
+
+static void Usage()
+{
+    fprintf(stderr,
+            "usage: bench_kernels [-r repeats] [-w warmup s] [-s repeat s] [-b sizes] [-f rates]\n"
+            "                     [-k kernel]... [-o results.csv] [-l label] [-c baseline.csv]\n"
+            "                     [-x percent]\n"
+            "  -b 1,4,48      block sizes to sweep, 1 - %zu\n"
+            "  -f 48000       sample rates to sweep\n"
+            "  -k name        only run this kernel, can be repeated:\n           ",
+            kMaxAudioBlockSize);
+    for(const Kernel& kernel : kKernels)
+        fprintf(stderr, " %s", kernel.name);
+    fprintf(stderr,
+            "\n  -o file        write the results as CSV, - for stdout instead of the table\n"
+            "  -l label       label for the CSV rows, the commit hash for example\n"
+            "  -c file        compare with a CSV file from an earlier run\n"
+            "  -x percent     slowdown -c accepts, default 10\n");
+}
+
+int main(int argc, char** argv)
+{
+    SweepOptions options;
+    const char*  outputPath   = nullptr;
+    const char*  baselinePath = nullptr;
+    const char*  label        = "";
+    float        tolerancePct = 10.0f;
+
+    for(int i = 1; i < argc; i++)
+    {
+        const char* arg   = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(arg[0] != '-' || strlen(arg) != 2 || !value)
+        {
+            Usage();
+            return 1;
+        }
+        i++;
+        switch(arg[1])
+        {
+            case 'r': options.repeats = (size_t)atoi(value); break;
+            case 'w': options.warmupSeconds = (float)atof(value); break;
+            case 's': options.repeatSeconds = (float)atof(value); break;
+            case 'b': options.blockSizes = ParseList<size_t>(value); break;
+            case 'f': options.sampleRates = ParseList<float>(value); break;
+            case 'k': options.kernels.push_back(value); break;
+            case 'o': outputPath = value; break;
+            case 'l': label = value; break;
+            case 'c': baselinePath = value; break;
+            case 'x': tolerancePct = (float)atof(value); break;
+            default: Usage(); return 1;
+        }
+    }
+
+    if(options.blockSizes.empty())
+        options.blockSizes.assign(std::begin(kBlockSizes), std::end(kBlockSizes));
+    if(options.sampleRates.empty())
+        options.sampleRates.assign(std::begin(kSampleRates), std::end(kSampleRates));
+    options.repeats = options.repeats > 0 ? options.repeats : 1;
+
+    for(size_t blockSize : options.blockSizes)
+    {
+        if(blockSize < 1 || blockSize > kMaxAudioBlockSize)
+        {
+            fprintf(stderr, "bench_kernels: block size %zu is out of range\n", blockSize);
+            return 1;
+        }
+    }
+    for(const std::string& name : options.kernels)
+    {
+        bool known = false;
+        for(const Kernel& kernel : kKernels)
+            known = known || name == kernel.name;
+        if(!known)
+        {
+            fprintf(stderr, "bench_kernels: unknown kernel %s\n", name.c_str());
+            Usage();
+            return 1;
+        }
+    }
+
+    // The table goes to stdout unless the CSV does
+    const bool table = !outputPath || strcmp(outputPath, "-") != 0;
+    if(table)
+        printf("kernel           rate     block  median ns    min ns    max ns  stddev  Msamples/s  realtime\n");
+
+    std::vector<Result> results;
+    for(float sampleRate : options.sampleRates)
+    {
+        MakeInput(sampleRate);
+        for(const Kernel& kernel : kKernels)
+        {
+            if(!options.kernels.empty()
+               && std::find(options.kernels.begin(), options.kernels.end(), kernel.name)
+                      == options.kernels.end())
+                continue;
+
+            for(size_t blockSize : options.blockSizes)
+            {
+                Result result;
+                result.kernel     = kernel.name;
+                result.sampleRate = sampleRate;
+                result.blockSize  = blockSize;
+                result.ns         = kernel.bench(options, sampleRate, blockSize);
+                results.push_back(result);
+
+                // Realtime is the share of one host core the kernel needs at this rate
+                if(table)
+                    printf("%-16s %6.0f  %5zu  %9.2f %9.2f %9.2f  %5.1f%%  %10.1f  %7.3f%%\n",
+                           kernel.name,
+                           sampleRate,
+                           blockSize,
+                           result.ns.median,
+                           result.ns.min,
+                           result.ns.max,
+                           100.0 * result.ns.stddev / result.ns.median,
+                           1000.0 / result.ns.median,
+                           result.ns.median * sampleRate / 1e7);
+            }
+        }
+    }
+
+    if(outputPath)
+    {
+        FILE* file = strcmp(outputPath, "-") == 0 ? stdout : fopen(outputPath, "w");
+        if(!file)
+        {
+            fprintf(stderr, "bench_kernels: can't write %s\n", outputPath);
+            return 1;
+        }
+        WriteCsv(file, label, options.repeats, results);
+        if(file != stdout)
+            fclose(file);
+    }
+
+    if(baselinePath)
+    {
+        std::vector<Result> baseline;
+        if(!ReadCsv(baselinePath, baseline))
+        {
+            fprintf(stderr, "bench_kernels: can't read %s\n", baselinePath);
+            return 1;
+        }
+        if(CompareBaseline(table ? stdout : stderr, results, baseline, tolerancePct) > 0)
+            return 3;
+    }
+    return 0;
+}
@@ -0,0 +1,508 @@
+#pragma once
+#ifndef HOST_DAISY_SEED_H
+#define HOST_DAISY_SEED_H /**< & */
+
+/** Host stand-in for the parts of libDaisy used by the pedal code.
+ *
+ *  This header is found ahead of the real libDaisy "daisy_seed.h" when building
+ *  the HostRender tools.  It keeps the same class names and method signatures so
+ *  the pedal hardware classes and the example programs compile unchanged on Linux,
+ *  while the knobs, switches and GPIO outputs become plain variables that the
+ *  render harness can script and inspect.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <initializer_list>
+#include "per/qspi.h"
+#include "per/tim.h"
+
+/** Large buffers go in the external SDRAM on the Daisy Seed, plain memory on the host */
+#ifndef DSY_SDRAM_BSS
+#define DSY_SDRAM_BSS
+#endif
+
+namespace daisy
+{
+/** Pin description, matches the layout of libDaisy's Pin / dsy_gpio_pin */
+struct Pin
+{
+    uint8_t port;
+    uint8_t pin;
+
+    constexpr Pin() : port(0), pin(0) {}
+    constexpr Pin(uint8_t pt, uint8_t pn) : port(pt), pin(pn) {}
+};
+using dsy_gpio_pin = Pin;
+
+namespace seed
+{
+    constexpr Pin D0{0, 0};
+    constexpr Pin D1{0, 1};
+    constexpr Pin D2{0, 2};
+    constexpr Pin D3{0, 3};
+    constexpr Pin D4{0, 4};
+    constexpr Pin D5{0, 5};
+    constexpr Pin D6{0, 6};
+    constexpr Pin D7{0, 7};
+    constexpr Pin D8{0, 8};
+    constexpr Pin D9{0, 9};
+    constexpr Pin D10{0, 10};
+    constexpr Pin D11{0, 11};
+    constexpr Pin D12{0, 12};
+    constexpr Pin D13{0, 13};
+    constexpr Pin D14{0, 14};
+    constexpr Pin D15{0, 15};
+    constexpr Pin D16{0, 16};
+    constexpr Pin D17{0, 17};
+    constexpr Pin D18{0, 18};
+    constexpr Pin D19{0, 19};
+    constexpr Pin D20{0, 20};
+    constexpr Pin D21{0, 21};
+    constexpr Pin D22{0, 22};
+    constexpr Pin D23{0, 23};
+    constexpr Pin D24{0, 24};
+    constexpr Pin D25{0, 25};
+    constexpr Pin D26{0, 26};
+    constexpr Pin D27{0, 27};
+    constexpr Pin D28{0, 28};
+    constexpr Pin D29{0, 29};
+    constexpr Pin D30{0, 30};
+} // namespace seed
+
+/** System time stand-in.  Time only moves when the harness advances it, so UI
+ *  timing follows the rendered audio rather than the speed of the host.
+ */
+class System
+{
+  public:
+    static uint32_t GetNow() { return static_cast<uint32_t>(now_us_ / 1000); }
+    static uint32_t GetUs() { return static_cast<uint32_t>(now_us_); }
+    static void     Delay(uint32_t delay_ms) { HostAdvanceUs(uint64_t(delay_ms) * 1000); }
+
+    /** Host only: move system time forward, running any timer callbacks due on the way */
+    static void HostAdvanceUs(uint64_t us) { TimerHandle::HostAdvance(now_us_, now_us_ + us); }
+
+  private:
+    static inline uint64_t now_us_ = 0;
+};
+
+class GPIO
+{
+  public:
+    enum class Mode
+    {
+        INPUT,
+        OUTPUT,
+        OPEN_DRAIN,
+        ANALOG,
+    };
+
+    enum class Pull
+    {
+        NOPULL,
+        PULLUP,
+        PULLDOWN,
+    };
+
+    void Init(Pin p, Mode m = Mode::INPUT, Pull pu = Pull::NOPULL)
+    {
+        pin_   = p;
+        mode_  = m;
+        state_ = false;
+        (void)pu;
+    }
+
+    bool Read() { return state_; }
+    void Write(bool state) { state_ = state; }
+    void Toggle() { state_ = !state_; }
+
+  private:
+    Pin  pin_;
+    Mode mode_;
+    bool state_ = false;
+};
+
+struct AdcChannelConfig
+{
+    void InitSingle(dsy_gpio_pin pin) { pin_ = pin; }
+
+    Pin pin_;
+};
+
+/** ADC stand-in.  Readings live in a static table the harness writes into. */
+class AdcHandle
+{
+  public:
+    static constexpr size_t kMaxChannels = 16;
+
+    enum OverSampling
+    {
+        OVS_NONE,
+        OVS_4,
+        OVS_8,
+        OVS_16,
+        OVS_32,
+        OVS_64,
+        OVS_128,
+        OVS_256,
+        OVS_512,
+        OVS_1024,
+        OVS_LAST,
+    };
+
+    void Init(AdcChannelConfig* cfg, size_t num_channels, OverSampling ovs = OVS_32)
+    {
+        (void)cfg;
+        (void)ovs;
+        num_channels_ = num_channels;
+    }
+
+    void Start() {}
+    void Stop() {}
+
+    uint16_t* GetPtr(uint8_t chn) { return &values_[chn % kMaxChannels]; }
+    uint16_t  Get(uint8_t chn) const { return values_[chn % kMaxChannels]; }
+    float     GetFloat(uint8_t chn) const { return Get(chn) / 65536.0f; }
+
+    /** Host only: set the raw reading of a channel from a 0.0 to 1.0 value */
+    static void SetFloat(uint8_t chn, float value)
+    {
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        values_[chn % kMaxChannels] = static_cast<uint16_t>(value * 65535.0f);
+    }
+
+  private:
+    size_t                 num_channels_ = 0;
+    static inline uint16_t values_[kMaxChannels] = {};
+};
+
+class AnalogControl
+{
+  public:
+    void Init(uint16_t* adcptr,
+              float     sr,
+              bool      flip         = false,
+              bool      invert       = false,
+              float     slew_seconds = 0.002f)
+    {
+        raw_          = adcptr;
+        flip_         = flip;
+        invert_       = invert;
+        slew_seconds_ = slew_seconds;
+        val_          = 0.0f;
+        SetSampleRate(sr);
+    }
+
+    float Process()
+    {
+        float t = static_cast<float>(*raw_) * (1.0f / 65536.0f);
+        if(flip_)
+            t = 1.0f - t;
+        if(invert_)
+            t = -t;
+        val_ += coeff_ * (t - val_);
+        return val_;
+    }
+
+    float Value() const { return val_; }
+
+    void SetSampleRate(float sample_rate)
+    {
+        coeff_ = 1.0f / (slew_seconds_ * sample_rate * 0.5f);
+        if(coeff_ > 1.0f)
+            coeff_ = 1.0f;
+    }
+
+    uint16_t GetRawValue() { return *raw_; }
+    float    GetRawFloat() { return static_cast<float>(*raw_) * (1.0f / 65536.0f); }
+
+  private:
+    uint16_t* raw_          = nullptr;
+    float     coeff_        = 1.0f;
+    float     slew_seconds_ = 0.002f;
+    float     val_          = 0.0f;
+    bool      flip_         = false;
+    bool      invert_       = false;
+};
+
+/** Debounced switch stand-in.  The harness drives SetPressed(). */
+class Switch
+{
+  public:
+    void Init(dsy_gpio_pin pin, float update_rate = 0.0f)
+    {
+        (void)pin;
+        (void)update_rate;
+    }
+
+    void Debounce()
+    {
+        previous_ = current_;
+        current_  = input_;
+        if(current_ && !previous_)
+            rising_edge_time_ = System::GetNow();
+    }
+
+    bool RisingEdge() const { return current_ && !previous_; }
+    bool FallingEdge() const { return !current_ && previous_; }
+    bool Pressed() const { return current_; }
+    bool RawState() { return input_; }
+
+    float TimeHeldMs() const
+    {
+        return Pressed() ? static_cast<float>(System::GetNow() - rising_edge_time_)
+                         : 0.0f;
+    }
+
+    /** Host only: set the physical state of the switch */
+    void SetPressed(bool pressed) { input_ = pressed; }
+
+  private:
+    bool     input_            = false;
+    bool     current_          = false;
+    bool     previous_         = false;
+    uint32_t rising_edge_time_ = 0;
+};
+
+/** Rotary encoder with push button stand-in. */
+class Encoder
+{
+  public:
+    void Init(dsy_gpio_pin a, dsy_gpio_pin b, dsy_gpio_pin click, float update_rate = 0.0f)
+    {
+        (void)a;
+        (void)b;
+        sw_.Init(click, update_rate);
+    }
+
+    void Debounce()
+    {
+        inc_         = pending_inc_;
+        pending_inc_ = 0;
+        sw_.Debounce();
+    }
+
+    int32_t Increment() const { return inc_; }
+    bool    RisingEdge() const { return sw_.RisingEdge(); }
+    bool    FallingEdge() const { return sw_.FallingEdge(); }
+    bool    Pressed() const { return sw_.Pressed(); }
+    float   TimeHeldMs() const { return sw_.TimeHeldMs(); }
+
+    /** Host only: queue a number of detents to be reported on the next Debounce */
+    void Turn(int32_t increments) { pending_inc_ += increments; }
+
+    /** Host only: set the physical state of the push button */
+    void SetPressed(bool pressed) { sw_.SetPressed(pressed); }
+
+  private:
+    Switch  sw_;
+    int32_t inc_         = 0;
+    int32_t pending_inc_ = 0;
+};
+
+class Led
+{
+  public:
+    void Init(dsy_gpio_pin pin, bool invert, float samplerate = 1000.0f)
+    {
+        (void)pin;
+        (void)invert;
+        (void)samplerate;
+    }
+
+    void Set(float val) { bright_ = val; }
+    void Update() { output_ = bright_; }
+    void SetSampleRate(float sample_rate) { (void)sample_rate; }
+
+    /** Host only: brightness applied at the last Update() */
+    float Brightness() const { return output_; }
+
+  private:
+    float bright_ = 0.0f;
+    float output_ = 0.0f;
+};
+
+class SaiHandle
+{
+  public:
+    struct Config
+    {
+        enum class SampleRate
+        {
+            SAI_8KHZ,
+            SAI_16KHZ,
+            SAI_32KHZ,
+            SAI_48KHZ,
+            SAI_96KHZ,
+        };
+    };
+};
+
+class AudioHandle
+{
+  public:
+    typedef const float* const* InputBuffer;
+    typedef float**             OutputBuffer;
+    typedef void (*AudioCallback)(InputBuffer in, OutputBuffer out, size_t size);
+
+    typedef const float* InterleavingInputBuffer;
+    typedef float*       InterleavingOutputBuffer;
+    typedef void (*InterleavingAudioCallback)(InterleavingInputBuffer  in,
+                                              InterleavingOutputBuffer out,
+                                              size_t                   size);
+};
+
+/** Daisy Seed stand-in.  Audio is not started on a timer, instead the harness
+ *  pulls the registered callback and calls it block by block.
+ */
+class DaisySeed
+{
+  public:
+    void Configure() {}
+    void Init(bool boost = false) { (void)boost; }
+    void DelayMs(size_t del) { (void)del; }
+
+    dsy_gpio_pin GetPin(uint8_t pin_idx) { return Pin(0, pin_idx); }
+
+    void StartAudio(AudioHandle::InterleavingAudioCallback cb)
+    {
+        interleaved_callback_ = cb;
+        callback_             = nullptr;
+    }
+
+    void StartAudio(AudioHandle::AudioCallback cb)
+    {
+        callback_             = cb;
+        interleaved_callback_ = nullptr;
+    }
+
+    void ChangeAudioCallback(AudioHandle::InterleavingAudioCallback cb) { StartAudio(cb); }
+    void ChangeAudioCallback(AudioHandle::AudioCallback cb) { StartAudio(cb); }
+
+    void StopAudio()
+    {
+        callback_             = nullptr;
+        interleaved_callback_ = nullptr;
+    }
+
+    void SetAudioSampleRate(SaiHandle::Config::SampleRate samplerate)
+    {
+        switch(samplerate)
+        {
+            case SaiHandle::Config::SampleRate::SAI_8KHZ: sample_rate_ = 8000.0f; break;
+            case SaiHandle::Config::SampleRate::SAI_16KHZ: sample_rate_ = 16000.0f; break;
+            case SaiHandle::Config::SampleRate::SAI_32KHZ: sample_rate_ = 32000.0f; break;
+            case SaiHandle::Config::SampleRate::SAI_48KHZ: sample_rate_ = 48000.0f; break;
+            case SaiHandle::Config::SampleRate::SAI_96KHZ: sample_rate_ = 96000.0f; break;
+        }
+    }
+
+    float  AudioSampleRate() { return sample_rate_; }
+    void   SetAudioBlockSize(size_t size) { block_size_ = host_block_size_ > 0 ? host_block_size_ : size; }
+    size_t AudioBlockSize() { return block_size_; }
+    float  AudioCallbackRate() { return sample_rate_ / static_cast<float>(block_size_); }
+
+    /** Host only: every SetAudioBlockSize() uses this size instead, 0 lets the program pick */
+    static void HostForceBlockSize(size_t size) { host_block_size_ = size; }
+
+    void SetLed(bool state) { (void)state; }
+
+    static void StartLog(bool wait_for_pc = false) { (void)wait_for_pc; }
+
+    static void PrintLine(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+        fputc('\n', stderr);
+    }
+
+    static void Print(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+    }
+
+    /** Host only: the callback registered with StartAudio */
+    AudioHandle::AudioCallback HostAudioCallback() const { return callback_; }
+
+    AdcHandle  adc;
+    QSPIHandle qspi;
+
+  private:
+    AudioHandle::AudioCallback             callback_             = nullptr;
+    AudioHandle::InterleavingAudioCallback interleaved_callback_ = nullptr;
+    float                                  sample_rate_          = 48000.0f;
+    size_t                                 block_size_           = 48;
+    static inline size_t                   host_block_size_      = 0;
+};
+
+/** Parameter mapping of an AnalogControl, same curves as libDaisy */
+class Parameter
+{
+  public:
+    enum Curve
+    {
+        LINEAR,
+        EXPONENTIAL,
+        LOGARITHMIC,
+        CUBE,
+        LAST,
+    };
+
+    void Init(AnalogControl input, float min, float max, Curve curve)
+    {
+        in_    = input;
+        pmin_  = min;
+        pmax_  = max;
+        pcurve_ = curve;
+        lmin_  = logf(min < 0.0000001f ? 0.0000001f : min);
+        lmax_  = logf(max);
+    }
+
+    float Process()
+    {
+        switch(pcurve_)
+        {
+            case LINEAR: val_ = (in_.Process() * (pmax_ - pmin_)) + pmin_; break;
+            case EXPONENTIAL:
+                val_ = in_.Process();
+                val_ = ((val_ * val_) * (pmax_ - pmin_)) + pmin_;
+                break;
+            case LOGARITHMIC:
+                val_ = expf((in_.Process() * (lmax_ - lmin_)) + lmin_);
+                break;
+            case CUBE:
+                val_ = in_.Process();
+                val_ = ((val_ * (val_ * val_)) * (pmax_ - pmin_)) + pmin_;
+                break;
+            default: break;
+        }
+        return val_;
+    }
+
+    float Value() { return val_; }
+
+  private:
+    AnalogControl in_;
+    float         pmin_, pmax_;
+    float         lmin_, lmax_;
+    Curve         pcurve_;
+    float         val_ = 0.0f;
+};
+
+} // namespace daisy
+
+#include "per/spi.h"
+#include "host_midi.h"
+#include "host_ui.h"
+
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+#ifndef HOST_OLED_SSD130X_H
+#define HOST_OLED_SSD130X_H /**< & */
+
+/** Host stand-in for libDaisy's SSD130x drivers.
+ *
+ *  The driver keeps a real 1 bit framebuffer so drawing code behaves the same,
+ *  Update() hands the buffer to a transport that only counts the bytes sent.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "hid/disp/oled_display.h"
+
+namespace daisy
+{
+class SSD130x4WireSpiTransport
+{
+  public:
+    struct Config
+    {
+        struct
+        {
+            Pin dc;
+            Pin reset;
+        } pin_config;
+    };
+
+    void Init(const Config& config) { (void)config; }
+
+    void SendCommand(uint8_t cmd)
+    {
+        (void)cmd;
+        bytes_sent_ += 1;
+    }
+
+    void SendData(uint8_t* buff, size_t size)
+    {
+        (void)buff;
+        bytes_sent_ += size;
+    }
+
+    /** Host only: total bytes pushed over SPI since Init */
+    size_t BytesSent() const { return bytes_sent_; }
+
+  private:
+    size_t bytes_sent_ = 0;
+};
+
+template <size_t width, size_t height, typename Transport>
+class SSD130xDriver
+{
+  public:
+    struct Config
+    {
+        typename Transport::Config transport_config;
+    };
+
+    void Init(Config config)
+    {
+        transport_.Init(config.transport_config);
+        Fill(false);
+    }
+
+    size_t Width() const { return width; }
+    size_t Height() const { return height; }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on)
+    {
+        if(x >= width || y >= height)
+            return;
+        if(on)
+            buffer_[x + (y / 8) * width] |= (1 << (y % 8));
+        else
+            buffer_[x + (y / 8) * width] &= ~(1 << (y % 8));
+    }
+
+    void Fill(bool on) { memset(buffer_, on ? 0xff : 0x00, sizeof(buffer_)); }
+
+    void Update()
+    {
+        for(size_t page = 0; page < height / 8; page++)
+        {
+            transport_.SendCommand(0xB0 + page);
+            transport_.SendCommand(0x00);
+            transport_.SendCommand(0x10);
+            transport_.SendData(&buffer_[width * page], width);
+        }
+    }
+
+    Transport& GetTransport() { return transport_; }
+
+  protected:
+    Transport transport_;
+    uint8_t   buffer_[width * height / 8];
+};
+
+using SSD130x4WireSpi128x64Driver = SSD130xDriver<128, 64, SSD130x4WireSpiTransport>;
+
+} // namespace daisy
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef HOST_DISPLAY_H
+#define HOST_DISPLAY_H /**< & */
+
+/** Host stand-in for libDaisy's fonts and OneBitGraphicsDisplay interface.
+ *
+ *  The UI pages draw through this interface without knowing the display type,
+ *  the same way libDaisy's menus do.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace daisy
+{
+struct FontDef
+{
+    uint8_t         FontWidth;
+    uint8_t         FontHeight;
+    const uint16_t* data;
+};
+
+static const FontDef Font_6x8   = {6, 8, nullptr};
+static const FontDef Font_7x10  = {7, 10, nullptr};
+static const FontDef Font_11x18 = {11, 18, nullptr};
+static const FontDef Font_16x26 = {16, 26, nullptr};
+
+class OneBitGraphicsDisplay
+{
+  public:
+    virtual ~OneBitGraphicsDisplay() {}
+
+    virtual uint16_t Width() const                                      = 0;
+    virtual uint16_t Height() const                                     = 0;
+    virtual void     Fill(bool on)                                      = 0;
+    virtual void     DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on) = 0;
+    virtual void     SetCursor(uint16_t x, uint16_t y)                  = 0;
+    virtual char     WriteString(const char* str, FontDef font, bool on) = 0;
+};
+
+} // namespace daisy
+
+#endif
@@ -0,0 +1,117 @@
+#pragma once
+#ifndef HOST_OLED_DISPLAY_H
+#define HOST_OLED_DISPLAY_H /**< & */
+
+/** Host stand-in for libDaisy's OledDisplay.
+ *
+ *  Draws into whichever driver it is given, the driver holds the framebuffer and
+ *  sends it to the display.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hid/disp/display.h"
+
+namespace daisy
+{
+template <typename DisplayDriver>
+class OledDisplay : public OneBitGraphicsDisplay
+{
+  public:
+    struct Config
+    {
+        typename DisplayDriver::Config driver_config;
+    };
+
+    void Init(Config config) { driver_.Init(config.driver_config); }
+
+    uint16_t Width() const override { return driver_.Width(); }
+    uint16_t Height() const override { return driver_.Height(); }
+
+    void DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on) override { driver_.DrawPixel(x, y, on); }
+    void Fill(bool on) override { driver_.Fill(on); }
+    void Update() { driver_.Update(); }
+
+    void SetCursor(uint16_t x, uint16_t y) override
+    {
+        cursor_x_ = x;
+        cursor_y_ = y;
+    }
+
+    /** Host glyphs are a bit pattern of the character code, enough to make
+     *  different strings produce different framebuffer contents.
+     */
+    char WriteChar(char ch, FontDef font, bool on)
+    {
+        for(uint8_t x = 0; x < font.FontWidth - 1; x++)
+        {
+            for(uint8_t y = 0; y < font.FontHeight; y++)
+            {
+                const bool bit = (uint8_t(ch) >> ((x + y) % 8)) & 1;
+                DrawPixel(cursor_x_ + x, cursor_y_ + y, bit ? on : !on);
+            }
+        }
+        cursor_x_ += font.FontWidth;
+        return ch;
+    }
+
+    char WriteString(const char* str, FontDef font, bool on) override
+    {
+        while(*str)
+        {
+            WriteChar(*str, font, on);
+            str++;
+        }
+        return *str;
+    }
+
+    void DrawLine(uint_fast8_t x1, uint_fast8_t y1, uint_fast8_t x2, uint_fast8_t y2, bool on)
+    {
+        int dx = x2 > x1 ? x2 - x1 : x1 - x2;
+        int dy = y2 > y1 ? y2 - y1 : y1 - y2;
+        int sx = x1 < x2 ? 1 : -1;
+        int sy = y1 < y2 ? 1 : -1;
+        int err = dx - dy;
+        int x = x1, y = y1;
+        while(true)
+        {
+            DrawPixel(x, y, on);
+            if(x == x2 && y == y2)
+                break;
+            int e2 = err * 2;
+            if(e2 > -dy)
+            {
+                err -= dy;
+                x += sx;
+            }
+            if(e2 < dx)
+            {
+                err += dx;
+                y += sy;
+            }
+        }
+    }
+
+    void DrawRect(uint_fast8_t x1, uint_fast8_t y1, uint_fast8_t x2, uint_fast8_t y2, bool on, bool fill = false)
+    {
+        for(uint_fast8_t x = x1; x <= x2; x++)
+        {
+            for(uint_fast8_t y = y1; y <= y2; y++)
+            {
+                if(fill || x == x1 || x == x2 || y == y1 || y == y2)
+                    DrawPixel(x, y, on);
+            }
+        }
+    }
+
+    DisplayDriver& GetDriver() { return driver_; }
+
+  private:
+    DisplayDriver driver_;
+    uint16_t      cursor_x_ = 0;
+    uint16_t      cursor_y_ = 0;
+};
+
+} // namespace daisy
+
+#endif
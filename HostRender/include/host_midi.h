@@ -0,0 +1,244 @@
+#pragma once
+#ifndef HOST_MIDI_H
+#define HOST_MIDI_H /**< & */
+
+/** Host stand-in for libDaisy's MIDI types and MidiUartHandler.
+ *
+ *  Bytes handed to HostReceive() are parsed by Listen() exactly like the UART
+ *  handler would parse them, including running status and real-time messages
+ *  interleaved inside other messages.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace daisy
+{
+enum MidiMessageType
+{
+    NoteOff,
+    NoteOn,
+    PolyphonicKeyPressure,
+    ControlChange,
+    ProgramChange,
+    ChannelPressure,
+    PitchBend,
+    SystemCommon,
+    SystemRealTime,
+    ChannelMode,
+    MessageLast,
+};
+
+enum SystemRealTimeType
+{
+    TimingClock,
+    SRTUndefined0,
+    Start,
+    Continue,
+    Stop,
+    SRTUndefined1,
+    ActiveSensing,
+    Reset,
+    SystemRealTimeLast,
+};
+
+struct NoteOnEvent
+{
+    int     channel;
+    uint8_t note;
+    uint8_t velocity;
+};
+
+struct NoteOffEvent
+{
+    int     channel;
+    uint8_t note;
+    uint8_t velocity;
+};
+
+struct ControlChangeEvent
+{
+    int     channel;
+    uint8_t control_number;
+    uint8_t value;
+};
+
+struct ProgramChangeEvent
+{
+    int     channel;
+    uint8_t program;
+};
+
+struct MidiEvent
+{
+    MidiMessageType    type     = MessageLast;
+    int                channel  = 0;
+    uint8_t            data[2]  = {0, 0};
+    SystemRealTimeType srt_type = SystemRealTimeLast;
+
+    NoteOnEvent AsNoteOn()
+    {
+        NoteOnEvent m;
+        m.channel  = channel;
+        m.note     = data[0];
+        m.velocity = data[1];
+        return m;
+    }
+
+    NoteOffEvent AsNoteOff()
+    {
+        NoteOffEvent m;
+        m.channel  = channel;
+        m.note     = data[0];
+        m.velocity = data[1];
+        return m;
+    }
+
+    ControlChangeEvent AsControlChange()
+    {
+        ControlChangeEvent m;
+        m.channel        = channel;
+        m.control_number = data[0];
+        m.value          = data[1];
+        return m;
+    }
+
+    ProgramChangeEvent AsProgramChange()
+    {
+        ProgramChangeEvent m;
+        m.channel = channel;
+        m.program = data[0];
+        return m;
+    }
+};
+
+class MidiUartHandler
+{
+  public:
+    struct Config
+    {
+        struct TransportConfig
+        {
+            Pin rx;
+            Pin tx;
+        };
+
+        TransportConfig transport_config;
+    };
+
+    void Init(Config config) { (void)config; }
+    void StartReceive() { receiving_ = true; }
+
+    /** Parses every received byte into the event queue */
+    void Listen()
+    {
+        while(rx_read_ != rx_write_)
+        {
+            Parse(rx_[rx_read_]);
+            rx_read_ = (rx_read_ + 1) % kRxSize;
+        }
+    }
+
+    bool HasEvents() const { return event_read_ != event_write_; }
+
+    MidiEvent PopEvent()
+    {
+        MidiEvent m = events_[event_read_];
+        event_read_ = (event_read_ + 1) % kEventQueueSize;
+        return m;
+    }
+
+    void SendMessage(uint8_t* bytes, size_t size)
+    {
+        (void)bytes;
+        (void)size;
+    }
+
+    /** Host only: bytes arriving on the MIDI input */
+    void HostReceive(const uint8_t* bytes, size_t size)
+    {
+        if(!receiving_)
+            return;
+
+        for(size_t i = 0; i < size; i++)
+        {
+            size_t next = (rx_write_ + 1) % kRxSize;
+            if(next == rx_read_)
+                return;
+            rx_[rx_write_] = bytes[i];
+            rx_write_      = next;
+        }
+    }
+
+  private:
+    static constexpr size_t kRxSize         = 256;
+    static constexpr size_t kEventQueueSize = 256;
+
+    void Push(const MidiEvent& m)
+    {
+        size_t next = (event_write_ + 1) % kEventQueueSize;
+        if(next == event_read_)
+            return;
+        events_[event_write_] = m;
+        event_write_          = next;
+    }
+
+    void Parse(uint8_t byte)
+    {
+        if(byte >= 0xF8)
+        {
+            MidiEvent m;
+            m.type     = SystemRealTime;
+            m.srt_type = static_cast<SystemRealTimeType>(byte & 0x07);
+            Push(m);
+            return;
+        }
+
+        if(byte & 0x80)
+        {
+            if(byte >= 0xF0)
+            {
+                // System common and sysex messages are not used by the pedal.
+                running_status_ = 0;
+                return;
+            }
+            running_status_ = byte;
+            data_count_     = 0;
+            return;
+        }
+
+        if(running_status_ == 0)
+            return;
+
+        pending_.data[data_count_++] = byte;
+
+        const uint8_t status = running_status_ & 0xF0;
+        const size_t  needed = (status == 0xC0 || status == 0xD0) ? 1 : 2;
+        if(data_count_ < needed)
+            return;
+
+        pending_.channel = running_status_ & 0x0F;
+        pending_.type    = static_cast<MidiMessageType>((status >> 4) - 8);
+        if(pending_.type == ControlChange && pending_.data[0] > 119)
+            pending_.type = ChannelMode;
+        if(needed == 1)
+            pending_.data[1] = 0;
+        Push(pending_);
+        data_count_ = 0;
+    }
+
+    uint8_t   rx_[kRxSize];
+    size_t    rx_read_   = 0;
+    size_t    rx_write_  = 0;
+    MidiEvent events_[kEventQueueSize];
+    size_t    event_read_     = 0;
+    size_t    event_write_    = 0;
+    MidiEvent pending_;
+    uint8_t   running_status_ = 0;
+    size_t    data_count_     = 0;
+    bool      receiving_      = false;
+};
+
+} // namespace daisy
+
+#endif
@@ -0,0 +1,551 @@
+#pragma once
+#ifndef HOST_UI_H
+#define HOST_UI_H /**< & */
+
+/** Host stand-in for libDaisy's UI framework (UI, UiPage, menus, mapped values).
+ *
+ *  Only the behaviour the pedal programs rely on is modelled: encoder turns move
+ *  the menu selection or edit a value, the okay button activates an item, and
+ *  canvases are cleared / drawn / flushed at their configured update rate.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "hid/disp/display.h"
+#include <stddef.h>
+#include <initializer_list>
+
+namespace daisy
+{
+class UI;
+class UiPage;
+
+struct UiCanvasDescriptor
+{
+    typedef void (*ClearFuncPtr)(const UiCanvasDescriptor& canvasDescriptor);
+    typedef void (*FlushFuncPtr)(const UiCanvasDescriptor& canvasDescriptor);
+
+    uint8_t      id_                = 0;
+    void*        handle_            = nullptr;
+    uint32_t     updateRateMs_      = 50;
+    uint32_t     screenSaverTimeOut = 0;
+    bool         screenSaverOn      = false;
+    ClearFuncPtr clearFunction_     = nullptr;
+    FlushFuncPtr flushFunction_     = nullptr;
+};
+
+class UiEventQueue
+{
+  public:
+    struct Event
+    {
+        enum class EventType
+        {
+            invalid,
+            buttonPressed,
+            buttonReleased,
+            encoderTurned,
+        };
+
+        EventType type       = EventType::invalid;
+        uint16_t  id         = 0;
+        int16_t   increments = 0;
+        uint16_t  numPresses = 0;
+    };
+
+    void AddButtonPressed(uint16_t buttonID, uint16_t numSuccessivePresses, bool isRetriggering = false)
+    {
+        (void)isRetriggering;
+        Event e;
+        e.type       = Event::EventType::buttonPressed;
+        e.id         = buttonID;
+        e.numPresses = numSuccessivePresses;
+        Push(e);
+    }
+
+    void AddButtonReleased(uint16_t buttonID)
+    {
+        Event e;
+        e.type = Event::EventType::buttonReleased;
+        e.id   = buttonID;
+        Push(e);
+    }
+
+    void AddEncoderTurned(uint16_t encoderID, int16_t increments, uint16_t stepsPerRev)
+    {
+        (void)stepsPerRev;
+        Event e;
+        e.type       = Event::EventType::encoderTurned;
+        e.id         = encoderID;
+        e.increments = increments;
+        Push(e);
+    }
+
+    Event GetAndRemoveNextEvent()
+    {
+        if(IsQueueEmpty())
+            return Event();
+        Event e = events_[read_];
+        read_   = (read_ + 1) % kQueueSize;
+        return e;
+    }
+
+    bool IsQueueEmpty() const { return read_ == write_; }
+
+  private:
+    static constexpr size_t kQueueSize = 256;
+
+    void Push(const Event& e)
+    {
+        size_t next = (write_ + 1) % kQueueSize;
+        if(next == read_)
+            return;
+        events_[write_] = e;
+        write_          = next;
+    }
+
+    Event  events_[kQueueSize];
+    size_t read_  = 0;
+    size_t write_ = 0;
+};
+
+class UiPage
+{
+  public:
+    virtual ~UiPage() {}
+
+    virtual bool IsOpaque(const UiCanvasDescriptor& display)
+    {
+        (void)display;
+        return true;
+    }
+
+    bool IsActive() { return parent_ != nullptr; }
+    void Close();
+
+    virtual bool OnOkayButton(uint8_t numberOfPresses, bool isRetriggering)
+    {
+        (void)numberOfPresses;
+        (void)isRetriggering;
+        return true;
+    }
+
+    virtual bool OnCancelButton(uint8_t numberOfPresses, bool isRetriggering)
+    {
+        (void)isRetriggering;
+        if(numberOfPresses == 1)
+            Close();
+        return true;
+    }
+
+    virtual bool OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution)
+    {
+        (void)turns;
+        (void)stepsPerRevolution;
+        return true;
+    }
+
+    virtual void OnShow() {}
+    virtual void OnHide() {}
+
+    virtual void Draw(const UiCanvasDescriptor& canvas) = 0;
+
+    UI* GetParentUI() { return parent_; }
+
+  private:
+    friend class UI;
+    UI* parent_ = nullptr;
+};
+
+class MappedValue
+{
+  public:
+    virtual ~MappedValue() {}
+    virtual void  ResetToDefault()                               = 0;
+    virtual float GetAs0to1() const                              = 0;
+    virtual void  SetFrom0to1(float normalizedValue0to1)         = 0;
+    virtual void  Step(int16_t numStepsUp, bool useCoarseStepSize) = 0;
+};
+
+class MappedStringListValue : public MappedValue
+{
+  public:
+    MappedStringListValue(const char** itemStrings, uint16_t numItems, uint16_t defaultIndex)
+    : itemStrings_(itemStrings), numItems_(numItems), index_(defaultIndex), default_(defaultIndex)
+    {
+    }
+
+    uint16_t    GetIndex() const { return index_; }
+    const char* GetString() const { return itemStrings_[index_]; }
+    void        SetIndex(uint16_t index) { index_ = index < numItems_ ? index : numItems_ - 1; }
+
+    void  ResetToDefault() override { index_ = default_; }
+    float GetAs0to1() const override
+    {
+        return numItems_ > 1 ? float(index_) / float(numItems_ - 1) : 0.0f;
+    }
+    void SetFrom0to1(float normalizedValue0to1) override
+    {
+        SetIndex(uint16_t(normalizedValue0to1 * float(numItems_ - 1) + 0.5f));
+    }
+    void Step(int16_t numStepsUp, bool useCoarseStepSize) override
+    {
+        (void)useCoarseStepSize;
+        int index = int(index_) + numStepsUp;
+        index_    = uint16_t(index < 0 ? 0 : (index >= numItems_ ? numItems_ - 1 : index));
+    }
+
+  private:
+    const char** itemStrings_;
+    uint16_t     numItems_;
+    uint16_t     index_;
+    uint16_t     default_;
+};
+
+class MappedFloatValue : public MappedValue
+{
+  public:
+    enum class Mapping
+    {
+        lin,
+        log,
+        pow2,
+    };
+
+    MappedFloatValue(float       min,
+                     float       max,
+                     float       defaultValue,
+                     Mapping     mapping     = Mapping::lin,
+                     const char* unitStr     = "",
+                     uint8_t     numDecimals = 1,
+                     bool        forceSign   = false)
+    : min_(min), max_(max), value_(defaultValue), default_(defaultValue)
+    {
+        (void)mapping;
+        (void)unitStr;
+        (void)numDecimals;
+        (void)forceSign;
+    }
+
+    float        Get() const { return value_; }
+    const float* GetPtr() const { return &value_; }
+    void Set(float newValue) { value_ = newValue < min_ ? min_ : (newValue > max_ ? max_ : newValue); }
+
+    void  ResetToDefault() override { value_ = default_; }
+    float GetAs0to1() const override { return (value_ - min_) / (max_ - min_); }
+    void  SetFrom0to1(float normalizedValue0to1) override
+    {
+        Set(min_ + normalizedValue0to1 * (max_ - min_));
+    }
+    void Step(int16_t numStepsUp, bool useCoarseStepSize) override
+    {
+        const float step = useCoarseStepSize ? 0.05f : 0.01f;
+        SetFrom0to1(GetAs0to1() + step * numStepsUp);
+    }
+
+  private:
+    float min_, max_, value_, default_;
+};
+
+class MappedIntValue : public MappedValue
+{
+  public:
+    MappedIntValue(int         min,
+                   int         max,
+                   int         defaultValue,
+                   int         stepSizeFine,
+                   int         stepSizeCoarse,
+                   const char* unitStr   = "",
+                   bool        forceSign = false)
+    : min_(min),
+      max_(max),
+      value_(defaultValue),
+      default_(defaultValue),
+      stepSizeFine_(stepSizeFine),
+      stepSizeCoarse_(stepSizeCoarse)
+    {
+        (void)unitStr;
+        (void)forceSign;
+    }
+
+    int        Get() const { return value_; }
+    const int* GetPtr() const { return &value_; }
+    void Set(int newValue) { value_ = newValue < min_ ? min_ : (newValue > max_ ? max_ : newValue); }
+
+    void  ResetToDefault() override { value_ = default_; }
+    float GetAs0to1() const override { return float(value_ - min_) / float(max_ - min_); }
+    void  SetFrom0to1(float normalizedValue0to1) override
+    {
+        Set(min_ + int(normalizedValue0to1 * float(max_ - min_) + 0.5f));
+    }
+    void Step(int16_t numStepsUp, bool useCoarseStepSize) override
+    {
+        Set(value_ + numStepsUp * (useCoarseStepSize ? stepSizeCoarse_ : stepSizeFine_));
+    }
+
+  private:
+    int min_, max_, value_, default_, stepSizeFine_, stepSizeCoarse_;
+};
+
+class AbstractMenu : public UiPage
+{
+  public:
+    enum class ItemType
+    {
+        callbackFunctionItem,
+        checkboxItem,
+        valueItem,
+        openUiPageItem,
+        closeMenuItem,
+        customItem,
+    };
+
+    struct ItemConfig
+    {
+        ItemType    type = ItemType::closeMenuItem;
+        const char* text = "";
+        struct
+        {
+            void (*callbackFunction)(void* context) = nullptr;
+            void* context                           = nullptr;
+        } asCallbackFunctionItem;
+        struct
+        {
+            bool* valueToModify = nullptr;
+        } asCheckboxItem;
+        struct
+        {
+            MappedValue* valueToModify = nullptr;
+        } asMappedValueItem;
+        struct
+        {
+            UiPage* pageToOpen = nullptr;
+        } asOpenUiPageItem;
+    };
+
+    uint16_t GetNumItems() const { return numItems_; }
+    int16_t  GetSelectedItemIdx() const { return selectedItemIdx_; }
+
+    bool OnOkayButton(uint8_t numberOfPresses, bool isRetriggering) override;
+    bool OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution) override;
+
+  protected:
+    void InitItems(const ItemConfig* items, uint16_t numItems)
+    {
+        items_           = items;
+        numItems_        = numItems;
+        selectedItemIdx_ = 0;
+        isEditing_       = false;
+    }
+
+    const ItemConfig* items_           = nullptr;
+    uint16_t          numItems_        = 0;
+    int16_t           selectedItemIdx_ = 0;
+    bool              isEditing_       = false;
+};
+
+class FullScreenItemMenu : public AbstractMenu
+{
+  public:
+    void Init(const ItemConfig* items, uint16_t numItems) { InitItems(items, numItems); }
+
+    /** Draws the selected item's name and value, close enough to libDaisy's layout to
+     *  change the same parts of the framebuffer when the menu is used.
+     */
+    void Draw(const UiCanvasDescriptor& canvas) override
+    {
+        if(numItems_ == 0)
+            return;
+
+        OneBitGraphicsDisplay& display = *static_cast<OneBitGraphicsDisplay*>(canvas.handle_);
+        const ItemConfig&      item    = items_[selectedItemIdx_];
+
+        display.SetCursor(0, 0);
+        display.WriteString(item.text, Font_11x18, true);
+
+        char value[16] = "";
+        switch(item.type)
+        {
+            case ItemType::checkboxItem:
+                snprintf(value, sizeof(value), "%s", *item.asCheckboxItem.valueToModify ? "[x]" : "[ ]");
+                break;
+            case ItemType::valueItem:
+                snprintf(value,
+                         sizeof(value),
+                         "%s%d%%",
+                         isEditing_ ? ">" : "",
+                         int(item.asMappedValueItem.valueToModify->GetAs0to1() * 100.0f));
+                break;
+            case ItemType::openUiPageItem: snprintf(value, sizeof(value), "..."); break;
+            default: break;
+        }
+        display.SetCursor(0, 32);
+        display.WriteString(value, Font_11x18, true);
+    }
+};
+
+class UI
+{
+  public:
+    static constexpr uint16_t invalidButtonId  = uint16_t(-1);
+    static constexpr uint16_t invalidEncoderId = uint16_t(-1);
+    static constexpr uint16_t invalidCanvasId  = uint16_t(-1);
+    static constexpr size_t   kMaxNumPages     = 32;
+    static constexpr size_t   kMaxNumCanvases  = 8;
+
+    struct SpecialControlIds
+    {
+        uint16_t okBttnId      = invalidButtonId;
+        uint16_t cancelBttnId  = invalidButtonId;
+        uint16_t menuEncoderId = invalidEncoderId;
+    };
+
+    void Init(UiEventQueue&                             inputQueue,
+              const SpecialControlIds&                  specialControlIds,
+              std::initializer_list<UiCanvasDescriptor> canvases,
+              uint16_t primaryOneBitGraphicsDisplayId = invalidCanvasId)
+    {
+        (void)primaryOneBitGraphicsDisplayId;
+        queue_       = &inputQueue;
+        ids_         = specialControlIds;
+        numCanvases_ = 0;
+        for(const UiCanvasDescriptor& c : canvases)
+        {
+            if(numCanvases_ < kMaxNumCanvases)
+            {
+                canvases_[numCanvases_]    = c;
+                lastDrawMs_[numCanvases_] = 0;
+                numCanvases_++;
+            }
+        }
+    }
+
+    void Process();
+
+    void OpenPage(UiPage& page)
+    {
+        if(numPages_ >= kMaxNumPages)
+            return;
+        pages_[numPages_++] = &page;
+        page.parent_        = this;
+        page.OnShow();
+    }
+
+    void ClosePage(UiPage& page)
+    {
+        for(size_t i = 0; i < numPages_; i++)
+        {
+            if(pages_[i] == &page)
+            {
+                for(size_t j = i; j + 1 < numPages_; j++)
+                    pages_[j] = pages_[j + 1];
+                numPages_--;
+                page.parent_ = nullptr;
+                page.OnHide();
+                return;
+            }
+        }
+    }
+
+    UiPage* GetTopPage() { return numPages_ > 0 ? pages_[numPages_ - 1] : nullptr; }
+
+  private:
+    UiEventQueue*      queue_ = nullptr;
+    SpecialControlIds  ids_;
+    UiPage*            pages_[kMaxNumPages];
+    size_t             numPages_ = 0;
+    UiCanvasDescriptor canvases_[kMaxNumCanvases];
+    uint32_t           lastDrawMs_[kMaxNumCanvases];
+    size_t             numCanvases_ = 0;
+};
+
+inline void UiPage::Close()
+{
+    if(parent_)
+        parent_->ClosePage(*this);
+}
+
+inline bool AbstractMenu::OnOkayButton(uint8_t numberOfPresses, bool isRetriggering)
+{
+    (void)numberOfPresses;
+    (void)isRetriggering;
+    if(numItems_ == 0)
+        return true;
+
+    const ItemConfig& item = items_[selectedItemIdx_];
+    switch(item.type)
+    {
+        case ItemType::callbackFunctionItem:
+            if(item.asCallbackFunctionItem.callbackFunction)
+                item.asCallbackFunctionItem.callbackFunction(item.asCallbackFunctionItem.context);
+            break;
+        case ItemType::checkboxItem:
+            *item.asCheckboxItem.valueToModify = !*item.asCheckboxItem.valueToModify;
+            break;
+        case ItemType::valueItem: isEditing_ = !isEditing_; break;
+        case ItemType::openUiPageItem:
+            if(GetParentUI() && item.asOpenUiPageItem.pageToOpen)
+                GetParentUI()->OpenPage(*item.asOpenUiPageItem.pageToOpen);
+            break;
+        case ItemType::closeMenuItem: Close(); break;
+        case ItemType::customItem: break;
+    }
+    return true;
+}
+
+inline bool AbstractMenu::OnMenuEncoderTurned(int16_t turns, uint16_t stepsPerRevolution)
+{
+    (void)stepsPerRevolution;
+    if(numItems_ == 0)
+        return true;
+
+    if(isEditing_ && items_[selectedItemIdx_].type == ItemType::valueItem)
+    {
+        items_[selectedItemIdx_].asMappedValueItem.valueToModify->Step(turns, false);
+        return true;
+    }
+
+    int idx          = selectedItemIdx_ + turns;
+    selectedItemIdx_ = int16_t(idx < 0 ? 0 : (idx >= numItems_ ? numItems_ - 1 : idx));
+    return true;
+}
+
+inline void UI::Process()
+{
+    while(queue_ && !queue_->IsQueueEmpty())
+    {
+        UiEventQueue::Event e    = queue_->GetAndRemoveNextEvent();
+        UiPage*             page = GetTopPage();
+        if(!page)
+            continue;
+
+        if(e.type == UiEventQueue::Event::EventType::buttonPressed && e.id == ids_.okBttnId)
+            page->OnOkayButton(uint8_t(e.numPresses), false);
+        else if(e.type == UiEventQueue::Event::EventType::buttonPressed
+                && e.id == ids_.cancelBttnId)
+            page->OnCancelButton(uint8_t(e.numPresses), false);
+        else if(e.type == UiEventQueue::Event::EventType::encoderTurned
+                && e.id == ids_.menuEncoderId)
+            page->OnMenuEncoderTurned(e.increments, 12);
+    }
+
+    const uint32_t now = System::GetNow();
+    for(size_t i = 0; i < numCanvases_; i++)
+    {
+        UiCanvasDescriptor& canvas = canvases_[i];
+        if(now - lastDrawMs_[i] < canvas.updateRateMs_)
+            continue;
+        lastDrawMs_[i] = now;
+
+        if(canvas.clearFunction_)
+            canvas.clearFunction_(canvas);
+        if(UiPage* page = GetTopPage())
+            page->Draw(canvas);
+        if(canvas.flushFunction_)
+            canvas.flushFunction_(canvas);
+    }
+}
+
+} // namespace daisy
+
+#endif
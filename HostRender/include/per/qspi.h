@@ -0,0 +1,158 @@
+#pragma once
+#ifndef HOST_PER_QSPI_H
+#define HOST_PER_QSPI_H /**< & */
+
+/** Host stand-in for libDaisy's QSPIHandle.
+ *
+ *  Behaves like the 8MB IS25LP064A NOR flash on the Daisy Seed: erasing sets 4kB
+ *  sectors to 0xFF and programming can only clear bits.  The contents live in memory
+ *  and can be backed by a file, so settings survive between runs of the host tools.
+ *  For checking recovery code the power can be cut after a number of programmed
+ *  bytes, everything written after that point is lost.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+namespace daisy
+{
+class QSPIHandle
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR,
+    };
+
+    static constexpr uint32_t kSize       = 8 * 1024 * 1024;
+    static constexpr uint32_t kSectorSize = 4096;
+
+    QSPIHandle() {}
+    ~QSPIHandle()
+    {
+        if(file_)
+            fclose(file_);
+    }
+
+    /** Erases every sector touched by the address range */
+    Result Erase(uint32_t start_addr, uint32_t end_addr)
+    {
+        if(start_addr >= end_addr || end_addr > kSize)
+            return Result::ERR;
+
+        for(uint32_t sector = start_addr & ~(kSectorSize - 1); sector < end_addr;
+            sector += kSectorSize)
+        {
+            if(EraseSector(sector) != Result::OK)
+                return Result::ERR;
+        }
+        return Result::OK;
+    }
+
+    Result EraseSector(uint32_t address)
+    {
+        if(address >= kSize || !PowerAvailable(0))
+            return Result::ERR;
+
+        const uint32_t sector = address & ~(kSectorSize - 1);
+        Memory();
+        for(uint32_t i = 0; i < kSectorSize; i++)
+            memory_[sector + i] = 0xff;
+        Persist(sector, kSectorSize);
+        erase_count_++;
+        return Result::OK;
+    }
+
+    /** Programs bytes, like NOR flash this can only turn 1 bits into 0 bits */
+    Result Write(uint32_t address, uint32_t size, uint8_t* buffer)
+    {
+        if(address + size > kSize)
+            return Result::ERR;
+
+        Memory();
+        uint32_t written = 0;
+        while(written < size && PowerAvailable(1))
+        {
+            memory_[address + written] &= buffer[written];
+            written++;
+        }
+        Persist(address, written);
+        return written == size ? Result::OK : Result::ERR;
+    }
+
+    /** Returns the memory mapped address of an offset into the flash */
+    void* GetData(uint32_t offset = 0) { return &Memory()[offset]; }
+
+    /** Host only: loads the flash contents from a file and writes every change back to
+    it, a missing file starts out erased.
+    \return false if the file can't be created
+    */
+    bool HostAttachFile(const char* path)
+    {
+        Memory();
+        file_ = fopen(path, "r+b");
+        if(file_)
+        {
+            size_t read = fread(memory_.data(), 1, kSize, file_);
+            (void)read;
+            return true;
+        }
+
+        file_ = fopen(path, "w+b");
+        if(!file_)
+            return false;
+        Persist(0, kSize);
+        return true;
+    }
+
+    /** Host only: cuts the power after this many more bytes have been programmed, later
+    writes and erases are dropped.  A negative count restores the power.
+    */
+    void HostCutPowerAfter(long bytes) { power_budget_ = bytes; }
+
+    /** Host only: true once the power has been cut */
+    bool HostPowerCut() const { return power_budget_ == 0; }
+
+    /** Host only: number of sector erases since startup, for wear checks */
+    size_t HostEraseCount() const { return erase_count_; }
+
+  private:
+    uint8_t* Memory()
+    {
+        if(memory_.empty())
+            memory_.assign(kSize, 0xff);
+        return memory_.data();
+    }
+
+    /** Takes bytes from the power budget, an erase takes none but needs power left */
+    bool PowerAvailable(long bytes)
+    {
+        if(power_budget_ < 0)
+            return true;
+        if(power_budget_ == 0 || power_budget_ < bytes)
+            return false;
+        power_budget_ -= bytes;
+        return true;
+    }
+
+    void Persist(uint32_t address, uint32_t size)
+    {
+        if(!file_ || size == 0)
+            return;
+        fseek(file_, address, SEEK_SET);
+        fwrite(&memory_[address], 1, size, file_);
+        fflush(file_);
+    }
+
+    std::vector<uint8_t> memory_;
+    FILE*                file_         = nullptr;
+    long                 power_budget_ = -1;
+    size_t               erase_count_  = 0;
+};
+
+} // namespace daisy
+
+#endif
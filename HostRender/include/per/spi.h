@@ -0,0 +1,148 @@
+#pragma once
+#ifndef HOST_PER_SPI_H
+#define HOST_PER_SPI_H /**< & */
+
+/** Host stand-in for libDaisy's SpiHandle.
+ *
+ *  Nothing is sent anywhere, the handle counts the bytes handed to it so display
+ *  and other SPI code can be checked for how much it transfers.  DMA transfers
+ *  complete straight away, the end callback runs before DmaTransmit() returns.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** DMA buffers live in a separate RAM section on the Daisy Seed, plain memory on the host */
+#ifndef DMA_BUFFER_MEM_SECTION
+#define DMA_BUFFER_MEM_SECTION
+#endif
+
+namespace daisy
+{
+class SpiHandle
+{
+  public:
+    struct Config
+    {
+        enum class Peripheral
+        {
+            SPI_1,
+            SPI_2,
+            SPI_3,
+            SPI_4,
+            SPI_5,
+            SPI_6,
+        };
+
+        enum class Mode
+        {
+            MASTER,
+            SLAVE,
+        };
+
+        enum class ClockPhase
+        {
+            ONE_EDGE,
+            TWO_EDGE,
+        };
+
+        enum class ClockPolarity
+        {
+            LOW,
+            HIGH,
+        };
+
+        enum class NSS
+        {
+            SOFT,
+            HARD_INPUT,
+            HARD_OUTPUT,
+        };
+
+        enum class Direction
+        {
+            TWO_LINES,
+            TWO_LINES_TX_ONLY,
+            TWO_LINES_RX_ONLY,
+            ONE_LINE,
+        };
+
+        enum class BaudPrescaler
+        {
+            PS_2,
+            PS_4,
+            PS_8,
+            PS_16,
+            PS_32,
+            PS_64,
+            PS_128,
+            PS_256,
+        };
+
+        struct
+        {
+            Pin sclk;
+            Pin miso;
+            Pin mosi;
+            Pin nss;
+        } pin_config;
+
+        Peripheral    periph;
+        Mode          mode;
+        Direction     direction;
+        unsigned long datasize;
+        ClockPolarity clock_polarity;
+        ClockPhase    clock_phase;
+        NSS           nss;
+        BaudPrescaler baud_prescaler;
+    };
+
+    enum class Result
+    {
+        OK,
+        ERR,
+    };
+
+    typedef void (*StartCallbackFunctionPtr)(void* context);
+    typedef void (*EndCallbackFunctionPtr)(void* context, Result result);
+
+    Result Init(const Config& config)
+    {
+        (void)config;
+        bytes_sent_ = 0;
+        return Result::OK;
+    }
+
+    Result BlockingTransmit(uint8_t* buff, size_t size, uint32_t timeout = 100)
+    {
+        (void)buff;
+        (void)timeout;
+        bytes_sent_ += size;
+        return Result::OK;
+    }
+
+    Result DmaTransmit(uint8_t*                 buff,
+                       size_t                   size,
+                       StartCallbackFunctionPtr start_callback,
+                       EndCallbackFunctionPtr   end_callback,
+                       void*                    callback_context)
+    {
+        (void)buff;
+        if(start_callback)
+            start_callback(callback_context);
+        bytes_sent_ += size;
+        if(end_callback)
+            end_callback(callback_context, Result::OK);
+        return Result::OK;
+    }
+
+    /** Host only: total bytes sent since Init */
+    size_t HostBytesSent() const { return bytes_sent_; }
+
+  private:
+    size_t bytes_sent_ = 0;
+};
+
+} // namespace daisy
+
+#endif
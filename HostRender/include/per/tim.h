@@ -0,0 +1,177 @@
+#pragma once
+#ifndef HOST_PER_TIM_H
+#define HOST_PER_TIM_H /**< & */
+
+/** Host stand-in for libDaisy's TimerHandle.
+ *
+ *  Counts like the STM32H7 general purpose timers clocked at 200MHz: the prescaler
+ *  divides the clock and the period elapsed callback fires every period + 1 ticks.
+ *  There are no interrupts on the host, System::HostAdvanceUs() steps time forward to
+ *  each due tick of every started timer in turn and calls its callback right there, so
+ *  a timer task interleaves with the rendered audio the way it would on the Seed.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** The STM32 HAL's timer interrupt numbers.  Interrupts don't preempt each other on the
+ *  host, so HAL_NVIC_SetPriority() does nothing.
+ */
+typedef enum
+{
+    TIM2_IRQn = 28,
+    TIM3_IRQn = 29,
+    TIM4_IRQn = 30,
+    TIM5_IRQn = 50,
+} IRQn_Type;
+
+inline void HAL_NVIC_SetPriority(IRQn_Type irqn, uint32_t preemptPriority, uint32_t subPriority)
+{
+    (void)irqn;
+    (void)preemptPriority;
+    (void)subPriority;
+}
+
+namespace daisy
+{
+class TimerHandle
+{
+  public:
+    struct Config
+    {
+        enum class Peripheral
+        {
+            TIM_2 = 0,
+            TIM_3,
+            TIM_4,
+            TIM_5,
+        };
+
+        enum class CounterDir
+        {
+            UP = 0,
+            DOWN,
+        };
+
+        Peripheral periph     = Peripheral::TIM_2;
+        CounterDir dir        = CounterDir::UP;
+        uint32_t   period     = 0xffffffff;
+        bool       enable_irq = false;
+    };
+
+    enum class Result
+    {
+        OK,
+        ERR,
+    };
+
+    typedef void (*PeriodElapsedCallback)(void* data);
+
+    static constexpr uint32_t kClockFreq = 200000000;
+
+    TimerHandle() {}
+    ~TimerHandle() { Stop(); }
+
+    Result Init(const Config& config)
+    {
+        config_ = config;
+        return Result::OK;
+    }
+
+    const Config& GetConfig() const { return config_; }
+
+    Result SetPeriod(uint32_t ticks)
+    {
+        config_.period = ticks;
+        return Result::OK;
+    }
+
+    Result SetPrescaler(uint32_t val)
+    {
+        prescaler_ = val;
+        return Result::OK;
+    }
+
+    /** Returns the frequency of each tick of the timer in Hz */
+    uint32_t GetFreq() const { return kClockFreq / (prescaler_ + 1); }
+
+    void SetCallback(PeriodElapsedCallback cb, void* data = nullptr)
+    {
+        callback_ = cb;
+        data_     = data;
+    }
+
+    Result Start()
+    {
+        Timers()[Index()] = this;
+        dueNs_            = nowNs_ + PeriodNs();
+        return Result::OK;
+    }
+
+    Result Stop()
+    {
+        if(Timers()[Index()] == this)
+            Timers()[Index()] = nullptr;
+        return Result::OK;
+    }
+
+    /** Host only: number of times the period elapsed since the timer was started */
+    size_t HostTickCount() const { return ticks_; }
+
+    /** Host only: moves the time from nowUs to targetUs, stopping at every due tick of
+    the started timers to run their callbacks.  Called by System::HostAdvanceUs().
+    */
+    static void HostAdvance(uint64_t& nowUs, uint64_t targetUs)
+    {
+        for(;;)
+        {
+            TimerHandle* next = nullptr;
+            for(size_t i = 0; i < 4; i++)
+            {
+                TimerHandle* timer = Timers()[i];
+                if(timer && timer->dueNs_ <= targetUs * 1000
+                   && (!next || timer->dueNs_ < next->dueNs_))
+                {
+                    next = timer;
+                }
+            }
+            if(!next)
+                break;
+
+            nowNs_ = next->dueNs_;
+            nowUs  = nowNs_ / 1000;
+            next->dueNs_ += next->PeriodNs();
+            next->ticks_++;
+            if(next->config_.enable_irq && next->callback_)
+                next->callback_(next->data_);
+        }
+        nowUs  = targetUs;
+        nowNs_ = targetUs * 1000;
+    }
+
+  private:
+    static TimerHandle** Timers()
+    {
+        static TimerHandle* timers[4] = {};
+        return timers;
+    }
+
+    size_t   Index() const { return static_cast<size_t>(config_.periph) & 3; }
+    uint64_t PeriodNs() const
+    {
+        return (uint64_t(config_.period) + 1) * 1000000000ull / GetFreq();
+    }
+
+    static inline uint64_t nowNs_ = 0; /**< Time Start() counts the first period from */
+
+    Config                config_;
+    uint32_t              prescaler_ = 0;
+    PeriodElapsedCallback callback_  = nullptr;
+    void*                 data_      = nullptr;
+    uint64_t              dueNs_     = 0;
+    size_t                ticks_     = 0;
+};
+
+} // namespace daisy
+
+#endif
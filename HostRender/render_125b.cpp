@@ -0,0 +1,64 @@
+#include "guitar_pedal_125b.h"
+#include "preset_store.h"
+#include "render_harness.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+// Provided by guitar_pedal_125b_test.cpp
+extern GuitarPedal125B hardware;
+extern PresetStore     presetStore;
+void InitPedal();
+void ProcessMainLoop();
+
+// The 125B adds the menu encoder to the script commands:
+//     <seconds> turn 0 <increments>
+//     <seconds> click 0 / unclick 0
+static bool HandleBoardEvent(GuitarPedal125B& pedal, const ScriptEvent& event)
+{
+    if(event.index < 0 || event.index >= GuitarPedal125B::ENCODER_LAST)
+        return false;
+
+    if(event.command == "turn")
+    {
+        pedal.encoders[event.index].Turn(static_cast<int32_t>(event.value));
+        return true;
+    }
+    if(event.command == "click" || event.command == "unclick")
+    {
+        pedal.encoders[event.index].SetPressed(event.command == "click");
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    RenderHarness<GuitarPedal125B> harness(hardware, InitPedal, ProcessMainLoop);
+    harness.SetBoardEventHandler(HandleBoardEvent);
+    int result = harness.Run("render_125b", argc, argv);
+    if(result != 0)
+        return result;
+
+    // The display only sends pages that changed, show what that saved over full frames.
+    auto&        driver  = hardware.display.GetDriver();
+    const size_t bytes   = driver.GetTransport().BytesSent();
+    const size_t frames  = driver.FramesSent();
+    const double seconds = System::GetUs() / 1000000.0;
+    printf("Display frames:     %zu sent, %zu SPI bytes, %.0f bytes per frame (full frame %zu)\n",
+           frames,
+           bytes,
+           frames > 0 ? double(bytes) / frames : 0.0,
+           SSD130x4WireSpiDma128x64Driver::kBufferSize + 6);
+    printf("Display SPI rate:   %.0f bytes/s\n", seconds > 0.0 ? bytes / seconds : 0.0);
+
+    // Settings saved while rendering, see -f to keep them between runs.
+    if(presetStore.HasRecord())
+        printf("Preset store:       record %u, %zu slots scanned at startup, %zu sector erases\n",
+               presetStore.Sequence(),
+               presetStore.SlotsScanned(),
+               hardware.seed.qspi.HostEraseCount());
+    else
+        printf("Preset store:       empty, %zu slots scanned at startup\n", presetStore.SlotsScanned());
+    return 0;
+}
@@ -0,0 +1,16 @@
+#include "guitar_pedal_1590b.h"
+#include "render_harness.h"
+
+using namespace daisy;
+using namespace bkshepherd;
+
+// Provided by guitar_pedal_1590b_test.cpp
+extern GuitarPedal1590B hardware;
+void InitPedal();
+void ProcessMainLoop();
+
+int main(int argc, char** argv)
+{
+    RenderHarness<GuitarPedal1590B> harness(hardware, InitPedal, ProcessMainLoop);
+    return harness.Run("render_1590b", argc, argv);
+}
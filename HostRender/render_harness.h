@@ -0,0 +1,817 @@
+#pragma once
+#ifndef RENDER_HARNESS_H
+#define RENDER_HARNESS_H /**< & */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "daisy_seed.h"
+#include "wav_file.h"
+#include "audio_block.h"
+#include "midi_param_map.h"
+#include "switch_timestamps.h"
+#include "latency_probe.h"
+
+namespace bkshepherd {
+
+/** Something that happens to the pedal controls at a point in the input file */
+struct ScriptEvent
+{
+    size_t               sample;  /**< Sample position the event happens at */
+    std::string          command; /**< knob, press, release, midi, or a board specific command */
+    int                  index;   /**< Knob, switch or encoder index */
+    float                value;   /**< Knob position or encoder increments */
+    std::vector<uint8_t> bytes;   /**< Raw MIDI bytes for the midi command */
+};
+
+/**
+   @brief Streams a wav file through a pedal's AudioCallback on the host.
+
+   The pedal program's InitPedal() sets the hardware up exactly like on the Daisy Seed
+   and registers its callback with the stand-in DaisySeed.  The harness then feeds the
+   input file through that callback one block at a time at the configured
+   SetAudioBlockSize, runs one pass of ProcessMainLoop() between blocks, applies the
+   relay bypass and hardware mute GPIO states to the output and times every callback.
+
+   Script files hold one event per line:  <seconds> <command> <args>
+       0.0   knob 0 0.75      set knob 1 to 75%
+       1.5   press 0          hold down footswitch 1
+       1.6   release 0        let go of footswitch 1
+       2.0   midi B0 01 40    raw MIDI bytes in hex
+       2.5   stall 0.2        the main loop doesn't run for 200 ms
+   Lines starting with # are ignored.
+
+   MIDI bytes and footswitch changes happen part way through a block at their exact
+   time, followed by a pass of the main loop, like the UART would deliver them while the
+   previous block plays.  A stall stops the main loop for a while, like a flash erase
+   does, the audio callback and the timers carry on.  Every MIDI mapped parameter change
+   the pedal applies is matched up with the control change it came from and has to land
+   exactly one block after the main loop read it.  Every footswitch change has to land
+   no sooner than one block after it happened and no later than one block and one
+   millisecond, the slowest the pedals scan them.  The run fails with exit code 4 otherwise.  With -p the
+   MIDI changes are also written to a text file, so the timeline for a recorded MIDI
+   stream can be looked at.
+
+   The QSPI flash starts out erased for every run.  With -f it is backed by a file so
+   saved settings carry over to the next run, and -x cuts the power after that many
+   more bytes have been written to flash, to check recovery from a torn write.
+*/
+template <typename Pedal>
+class RenderHarness
+{
+  public:
+    /** Hook for board specific script commands, returns false if the command is unknown */
+    typedef bool (*BoardEventHandler)(Pedal& hardware, const ScriptEvent& event);
+
+    RenderHarness(Pedal& hardware, void (*initPedal)(), void (*processMainLoop)())
+    : hardware_(hardware), initPedal_(initPedal), processMainLoop_(processMainLoop)
+    {
+    }
+
+    void SetBoardEventHandler(BoardEventHandler handler) { boardEventHandler_ = handler; }
+
+    /** Parses the command line, renders and prints the timing report.
+    \return process exit code
+    */
+    int Run(const char* programName, int argc, char** argv)
+    {
+        const char*        scriptPath = nullptr;
+        const char*        inputPath  = nullptr;
+        const char*        outputPath = nullptr;
+        const char*        paramsPath = nullptr;
+        const char*        flashPath  = nullptr;
+        const char*        goldenPath = nullptr;
+        long               maxUlps    = 0;
+        float              seconds    = 2.0f;
+        long               powerCut   = -1;
+        std::vector<float> knobValues(Pedal::KNOB_LAST, 0.5f);
+
+        for(int i = 1; i < argc; i++)
+        {
+            if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            {
+                scriptPath = argv[++i];
+            }
+            else if(strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+            {
+                paramsPath = argv[++i];
+            }
+            else if(strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+            {
+                flashPath = argv[++i];
+            }
+            else if(strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+            {
+                powerCut = atol(argv[++i]);
+            }
+            else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            {
+                goldenPath = argv[++i];
+            }
+            else if(strcmp(argv[i], "-u") == 0 && i + 1 < argc)
+            {
+                maxUlps = atol(argv[++i]);
+                if(maxUlps < 0)
+                    return Usage(programName);
+            }
+            else if(strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+            {
+                const long blockSize = atol(argv[++i]);
+                if(blockSize < 1 || blockSize > long(kMaxAudioBlockSize))
+                    return Usage(programName);
+                DaisySeed::HostForceBlockSize(size_t(blockSize));
+            }
+            else if(strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            {
+                seconds = atof(argv[++i]);
+                if(seconds <= 0.0f)
+                    return Usage(programName);
+            }
+            else if(strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+            {
+                loopbackDelay_ = atol(argv[++i]);
+                if(loopbackDelay_ < 0)
+                    return Usage(programName);
+            }
+            else if(strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+            {
+                int   knob;
+                float value;
+                if(sscanf(argv[++i], "%d=%f", &knob, &value) != 2 || knob < 0
+                   || knob >= Pedal::KNOB_LAST)
+                {
+                    return Usage(programName);
+                }
+                knobValues[knob] = value;
+            }
+            else if(!inputPath)
+            {
+                inputPath = argv[i];
+            }
+            else if(!outputPath)
+            {
+                outputPath = argv[i];
+            }
+            else
+            {
+                return Usage(programName);
+            }
+        }
+
+        if(!inputPath || !outputPath)
+            return Usage(programName);
+
+        WavFile input;
+        if(!GenerateInput(inputPath, seconds, input) && !input.Read(inputPath))
+        {
+            fprintf(stderr, "Unable to read wav file %s\n", inputPath);
+            return 1;
+        }
+
+        WavFile golden;
+        if(goldenPath && !golden.Read(goldenPath))
+        {
+            fprintf(stderr, "Unable to read golden file %s\n", goldenPath);
+            return 1;
+        }
+
+        // Knobs are set before InitPedal so the very first callback already reads them.
+        for(size_t k = 0; k < knobValues.size(); k++)
+        {
+            AdcHandle::SetFloat(k, knobValues[k]);
+        }
+
+        if(flashPath && !hardware_.seed.qspi.HostAttachFile(flashPath))
+        {
+            fprintf(stderr, "Unable to open flash file %s\n", flashPath);
+            return 1;
+        }
+
+        auto initBegin = std::chrono::steady_clock::now();
+        initPedal_();
+        initNs_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - initBegin)
+                      .count();
+
+        // The power cut only applies to writes made while rendering, not at startup.
+        hardware_.seed.qspi.HostCutPowerAfter(powerCut);
+
+        const float sampleRate = hardware_.AudioSampleRate();
+        std::vector<ScriptEvent> events;
+        if(scriptPath && !LoadScript(scriptPath, sampleRate, events))
+        {
+            fprintf(stderr, "Unable to read script %s\n", scriptPath);
+            return 1;
+        }
+
+        if(input.sampleRate != static_cast<uint32_t>(sampleRate))
+        {
+            fprintf(stderr,
+                    "Warning: %s is %u Hz, the pedal runs at %.0f Hz (no resampling)\n",
+                    inputPath,
+                    input.sampleRate,
+                    sampleRate);
+        }
+
+        if(paramsPath)
+        {
+            paramLog_ = fopen(paramsPath, "w");
+            if(!paramLog_)
+            {
+                fprintf(stderr, "Unable to write %s\n", paramsPath);
+                return 1;
+            }
+            fprintf(paramLog_, "# sample  seconds  param  value\n");
+            paramLogSampleRate_ = sampleRate;
+        }
+
+        midiScripted_.clear();
+        midiApplied_.clear();
+        MidiParamMap::HostSetObserver(RecordParamEvent);
+        switchScripted_.clear();
+        switchApplied_.clear();
+        SwitchTimestamps::HostSetObserver(RecordSwitchEvent);
+        latencies_.clear();
+        wrongLatencies_ = 0;
+        LatencyProbe::HostSetObserver(RecordLatency);
+
+        WavFile output;
+        Render(input, output, events);
+        MidiParamMap::HostSetObserver(nullptr);
+        SwitchTimestamps::HostSetObserver(nullptr);
+        LatencyProbe::HostSetObserver(nullptr);
+
+        if(paramLog_)
+        {
+            fclose(paramLog_);
+            paramLog_ = nullptr;
+        }
+        output.sampleRate = static_cast<uint32_t>(sampleRate);
+
+        if(!output.Write(outputPath))
+        {
+            fprintf(stderr, "Unable to write wav file %s\n", outputPath);
+            return 1;
+        }
+
+        const bool timingOk = PrintReport(input.NumFrames());
+        if(goldenPath && !CompareGolden(output, golden, maxUlps))
+            return 3;
+        return timingOk ? 0 : 4;
+    }
+
+  private:
+    int Usage(const char* programName)
+    {
+        fprintf(stderr,
+                "Usage: %s [-s script] [-p params.txt] [-f flash.bin [-x bytes]] [-l delay] [-k knob=value ...] "
+                "[-c golden.wav [-u ulps]] [-b size] [-t seconds] input.wav|sine:<Hz>|noise|impulses output.wav\n",
+                programName);
+        return 2;
+    }
+
+    /** Fills a test signal instead of reading a file, the same every run
+    \param spec sine:<Hz>, noise or impulses (every 100 ms)
+    \return false if spec doesn't name a test signal
+    */
+    static bool GenerateInput(const char* spec, float seconds, WavFile& wav)
+    {
+        const double sampleRate = wav.sampleRate;
+        const size_t numFrames  = static_cast<size_t>(seconds * sampleRate);
+        double       freq;
+        if(sscanf(spec, "sine:%lf", &freq) == 1)
+        {
+            wav.channelData.assign(1, std::vector<float>(numFrames));
+            for(size_t i = 0; i < numFrames; i++)
+                wav.channelData[0][i] = static_cast<float>(0.5 * sin(2.0 * M_PI * freq * i / sampleRate));
+            return true;
+        }
+        if(strcmp(spec, "noise") == 0)
+        {
+            // Stereo, so the two channels differ
+            uint32_t random = 12345;
+            wav.channelData.assign(2, std::vector<float>(numFrames));
+            for(size_t i = 0; i < numFrames; i++)
+            {
+                for(size_t ch = 0; ch < 2; ch++)
+                {
+                    random                 = random * 1664525u + 1013904223u;
+                    wav.channelData[ch][i] = 0.5f * ((float)(random >> 8) / 8388608.0f - 1.0f);
+                }
+            }
+            return true;
+        }
+        if(strcmp(spec, "impulses") == 0)
+        {
+            const size_t period = static_cast<size_t>(sampleRate / 10);
+            wav.channelData.assign(1, std::vector<float>(numFrames, 0.0f));
+            for(size_t i = 0; i < numFrames; i += period)
+                wav.channelData[0][i] = 1.0f;
+            return true;
+        }
+        return false;
+    }
+
+    /** Maps a float onto an integer line where neighbouring floats are 1 apart */
+    static int64_t UlpIndex(float value)
+    {
+        int32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits < 0 ? -int64_t(bits & 0x7fffffff) : int64_t(bits);
+    }
+
+    /** Compares the rendered output with a golden render of the same input and script
+    \return true if every sample is within maxUlps of the golden one
+    */
+    bool CompareGolden(const WavFile& output, const WavFile& golden, long maxUlps)
+    {
+        if(golden.channelData.size() != output.channelData.size()
+           || golden.NumFrames() != output.NumFrames())
+        {
+            printf("Golden compare:     FAIL, %zu frames x %zu channels, golden %zu x %zu\n",
+                   output.NumFrames(),
+                   output.channelData.size(),
+                   golden.NumFrames(),
+                   golden.channelData.size());
+            return false;
+        }
+
+        size_t  differing = 0, firstFrame = 0;
+        int64_t worstUlps = 0;
+        float   worstDiff = 0.0f;
+        for(size_t ch = 0; ch < output.channelData.size(); ch++)
+        {
+            for(size_t i = 0; i < output.NumFrames(); i++)
+            {
+                const float   a    = output.channelData[ch][i];
+                const float   b    = golden.channelData[ch][i];
+                const int64_t ulps = llabs(UlpIndex(a) - UlpIndex(b));
+                if(ulps == 0)
+                    continue;
+
+                firstFrame = differing == 0 || i < firstFrame ? i : firstFrame;
+                differing++;
+                worstUlps = ulps > worstUlps ? ulps : worstUlps;
+                worstDiff = fabsf(a - b) > worstDiff ? fabsf(a - b) : worstDiff;
+            }
+        }
+
+        const bool pass = worstUlps <= maxUlps;
+        if(differing == 0)
+        {
+            printf("Golden compare:     bit-exact\n");
+        }
+        else
+        {
+            printf("Golden compare:     %s, %zu samples differ from %.4f s, max %lld ULP (%.2e), "
+                   "tolerance %ld ULP\n",
+                   pass ? "pass" : "FAIL",
+                   differing,
+                   firstFrame / double(output.sampleRate),
+                   static_cast<long long>(worstUlps),
+                   worstDiff,
+                   maxUlps);
+        }
+        return pass;
+    }
+
+    bool LoadScript(const char* path, float sampleRate, std::vector<ScriptEvent>& events)
+    {
+        FILE* file = fopen(path, "r");
+        if(!file)
+            return false;
+
+        char line[256];
+        while(fgets(line, sizeof(line), file))
+        {
+            float seconds;
+            char  command[32];
+            int   consumed;
+            if(line[0] == '#' || sscanf(line, "%f %31s%n", &seconds, command, &consumed) != 2)
+                continue;
+
+            ScriptEvent event;
+            event.sample  = static_cast<size_t>(seconds * sampleRate);
+            event.command = command;
+            event.index   = 0;
+            event.value   = 0.0f;
+
+            const char* args = line + consumed;
+            if(event.command == "midi")
+            {
+                unsigned int byte;
+                int          n;
+                while(sscanf(args, "%x%n", &byte, &n) == 1)
+                {
+                    event.bytes.push_back(static_cast<uint8_t>(byte));
+                    args += n;
+                }
+            }
+            else if(event.command == "stall")
+            {
+                sscanf(args, "%f", &event.value);
+            }
+            else
+            {
+                sscanf(args, "%d %f", &event.index, &event.value);
+            }
+            events.push_back(event);
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    static void RecordParamEvent(const ParamEvent& event, uint32_t appliedSample)
+    {
+        midiApplied_.push_back({appliedSample + static_cast<uint32_t>(timelineStart_), event.value, 0});
+        if(!paramLog_)
+            return;
+        fprintf(paramLog_,
+                "%u %.6f %u %.4f\n",
+                appliedSample,
+                appliedSample / paramLogSampleRate_,
+                static_cast<unsigned int>(event.param),
+                event.value);
+    }
+
+    /** Notes the control changes in raw MIDI bytes, running status included */
+    void RecordControlChanges(const std::vector<uint8_t>& bytes, size_t sample)
+    {
+        for(size_t i = 0; i < bytes.size(); i++)
+        {
+            if(bytes[i] & 0x80)
+            {
+                midiStatus_ = bytes[i];
+                continue;
+            }
+            if((midiStatus_ & 0xF0) != 0xB0 || i + 1 >= bytes.size())
+                continue;
+            midiScripted_.push_back({static_cast<uint32_t>(sample), bytes[++i] / 127.0f, 0});
+        }
+    }
+
+    /** Runs a pass of the main loop unless it is stalled
+    \param sample Sample position the pass runs at
+    */
+    void RunMainLoop(size_t sample)
+    {
+        if(sample < stallEnd_)
+            return;
+
+        // The MIDI that arrived since the last pass is read now, one block is added to it
+        for(; midiRead_ < midiScripted_.size(); midiRead_++)
+            midiScripted_[midiRead_].due = static_cast<uint32_t>(sample + blockSize_);
+        processMainLoop_();
+    }
+
+    static void RecordSwitchEvent(const SwitchEvent& event, uint32_t appliedSample)
+    {
+        (void)event;
+        switchApplied_.push_back(appliedSample + static_cast<uint32_t>(timelineStart_));
+    }
+
+    static void RecordLatency(uint32_t latencySamples)
+    {
+        latencies_.push_back(latencySamples);
+        wrongLatencies_ += long(latencySamples) != cableSamples_ ? 1 : 0;
+    }
+
+    void ApplyEvent(const ScriptEvent& event)
+    {
+        if(event.command == "knob" && event.index < Pedal::KNOB_LAST)
+        {
+            AdcHandle::SetFloat(event.index, event.value);
+        }
+        else if(event.command == "press" && event.index < Pedal::SWITCH_LAST)
+        {
+            hardware_.switches[event.index].SetPressed(true);
+            switchScripted_.push_back({event.sample, blockSize_});
+        }
+        else if(event.command == "release" && event.index < Pedal::SWITCH_LAST)
+        {
+            hardware_.switches[event.index].SetPressed(false);
+            switchScripted_.push_back({event.sample, blockSize_});
+        }
+        else if(event.command == "midi")
+        {
+            hardware_.midi.HostReceive(event.bytes.data(), event.bytes.size());
+            RecordControlChanges(event.bytes, event.sample);
+        }
+        else if(event.command == "stall")
+        {
+            stallEnd_ = event.sample + static_cast<size_t>(event.value * sampleRate_);
+        }
+        else if(!boardEventHandler_ || !boardEventHandler_(hardware_, event))
+        {
+            fprintf(stderr, "Ignoring unknown script command '%s'\n", event.command.c_str());
+        }
+    }
+
+    void Render(const WavFile& input, WavFile& output, const std::vector<ScriptEvent>& events)
+    {
+        const size_t numFrames = input.NumFrames();
+
+        // Mono files feed both inputs, like a mono cable into both jacks.  The buffers
+        // fit the largest block size, the pedal can change it while rendering.
+        std::vector<float> inLeft(kMaxAudioBlockSize), inRight(kMaxAudioBlockSize);
+        std::vector<float> outLeft(kMaxAudioBlockSize), outRight(kMaxAudioBlockSize);
+        const float*       in[2]  = {inLeft.data(), inRight.data()};
+        float*             out[2] = {outLeft.data(), outRight.data()};
+        const size_t       rightChannel = input.channelData.size() > 1 ? 1 : 0;
+
+        output.channelData.assign(2, std::vector<float>(numFrames));
+        blockTimesNs_.clear();
+        restarts_.clear();
+        restartBlock_ = 0;
+        blockSize_     = hardware_.AudioBlockSize();
+        sampleRate_    = hardware_.AudioSampleRate();
+        stallEnd_      = 0;
+        midiRead_      = 0;
+        timelineStart_ = 0;
+        cableSamples_  = 2 * long(blockSize_) + loopbackDelay_;
+
+        // Control events are applied before the block they fall into.  MIDI, stalls and
+        // the footswitches happen while it plays, at their exact time.
+        std::vector<ScriptEvent> controlEvents, midiEvents;
+        for(const ScriptEvent& event : events)
+        {
+            const bool timed = event.command == "midi" || event.command == "press"
+                               || event.command == "release" || event.command == "stall";
+            (timed ? midiEvents : controlEvents).push_back(event);
+        }
+
+        size_t nextEvent = 0, nextMidiEvent = 0;
+        for(size_t start = 0; start < numFrames; start += blockSize_)
+        {
+            while(nextEvent < controlEvents.size()
+                  && controlEvents[nextEvent].sample < start + blockSize_)
+            {
+                ApplyEvent(controlEvents[nextEvent++]);
+            }
+
+            RunMainLoop(start);
+
+            // The main loop can restart the audio with another block size or sample rate,
+            // the file carries on at the new settings without resampling.
+            if(hardware_.AudioBlockSize() != blockSize_
+               || hardware_.AudioSampleRate() != sampleRate_)
+            {
+                blockSize_  = hardware_.AudioBlockSize();
+                sampleRate_ = hardware_.AudioSampleRate();
+                restarts_.push_back(start);
+                restartBlock_  = blockTimesNs_.size();
+                timelineStart_ = start;
+                cableSamples_  = 2 * long(blockSize_) + loopbackDelay_;
+            }
+
+            AudioHandle::AudioCallback callback  = hardware_.seed.HostAudioCallback();
+            const size_t               blockSize = blockSize_;
+            const uint64_t             blockTimeUs
+                = static_cast<uint64_t>(blockSize * 1000000.0 / sampleRate_);
+
+            for(size_t i = 0; i < blockSize; i++)
+            {
+                const size_t frame = start + i;
+                inLeft[i]  = frame < numFrames ? input.channelData[0][frame] : 0.0f;
+                inRight[i] = frame < numFrames ? input.channelData[rightChannel][frame] : 0.0f;
+            }
+
+            // A patch cable from the outputs to the inputs.  What a callback writes plays
+            // during the next block and what it reads was recorded during the previous
+            // one, so the cable sees the output two blocks plus the converter delay late.
+            if(loopbackDelay_ >= 0)
+            {
+                const size_t delay = 2 * blockSize + loopbackDelay_;
+                for(size_t i = 0; i < blockSize; i++)
+                {
+                    const size_t frame = start + i;
+                    const bool   played = frame >= delay && frame - delay < numFrames;
+                    inLeft[i]  = played ? output.channelData[0][frame - delay] : 0.0f;
+                    inRight[i] = played ? output.channelData[1][frame - delay] : 0.0f;
+                }
+            }
+
+            auto begin = std::chrono::steady_clock::now();
+            if(callback)
+                callback(in, out, blockSize);
+            auto end = std::chrono::steady_clock::now();
+            blockTimesNs_.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+
+            // The relay bypass routes the input straight to the output jacks and the
+            // hardware mute silences them, both are applied after the callback.
+            for(size_t i = 0; i < blockSize && start + i < numFrames; i++)
+            {
+                float left  = hardware_.audioBypass ? inLeft[i] : outLeft[i];
+                float right = hardware_.audioBypass ? inRight[i] : outRight[i];
+                output.channelData[0][start + i] = hardware_.audioMute ? 0.0f : left;
+                output.channelData[1][start + i] = hardware_.audioMute ? 0.0f : right;
+            }
+
+            uint64_t elapsedUs = 0;
+            while(nextMidiEvent < midiEvents.size()
+                  && midiEvents[nextMidiEvent].sample < start + blockSize)
+            {
+                const ScriptEvent& event = midiEvents[nextMidiEvent++];
+                const uint64_t     eventUs
+                    = event.sample > start ? static_cast<uint64_t>(
+                          (event.sample - start) * 1000000.0 / sampleRate_ + 0.5)
+                                           : 0;
+                if(eventUs > elapsedUs)
+                {
+                    System::HostAdvanceUs(eventUs - elapsedUs);
+                    elapsedUs = eventUs;
+                }
+                ApplyEvent(event);
+                RunMainLoop(event.sample);
+            }
+
+            System::HostAdvanceUs(blockTimeUs > elapsedUs ? blockTimeUs - elapsedUs : 0);
+        }
+    }
+
+    /** Prints the timing report
+    \return false if a MIDI or footswitch change landed at the wrong time or the latency
+    probe measured something else than the loopback cable
+    */
+    bool PrintReport(size_t numFrames)
+    {
+        if(blockTimesNs_.empty())
+        {
+            printf("No audio rendered\n");
+            return true;
+        }
+
+        const double budgetNs = blockSize_ * 1e9 / sampleRate_;
+
+        // Statistics are for the blocks since the last audio restart
+        const size_t first = restartBlock_ < blockTimesNs_.size() ? restartBlock_ : 0;
+        int64_t      minNs = blockTimesNs_[first], maxNs = blockTimesNs_[first], totalNs = 0;
+        size_t       deadlineMisses = 0;
+        for(size_t i = first; i < blockTimesNs_.size(); i++)
+        {
+            const int64_t ns = blockTimesNs_[i];
+            minNs = ns < minNs ? ns : minNs;
+            maxNs = ns > maxNs ? ns : maxNs;
+            totalNs += ns;
+            deadlineMisses += ns > budgetNs ? 1 : 0;
+        }
+
+        const double avgNs      = double(totalNs) / (blockTimesNs_.size() - first);
+        const size_t firstFrame = restarts_.empty() ? 0 : restarts_.back();
+        const double audioNs    = (numFrames - firstFrame) * 1e9 / sampleRate_;
+        const double realTime   = totalNs > 0 ? audioNs / totalNs : 0.0;
+
+        printf("Sample rate:        %.0f Hz\n", sampleRate_);
+        printf("Block size:         %zu samples\n", blockSize_);
+        printf("Blocks rendered:    %zu\n", blockTimesNs_.size());
+        printf("Block budget:       %.0f ns\n", budgetNs);
+        printf("ns per block:       min %lld  avg %.0f  max %lld\n",
+               static_cast<long long>(minNs),
+               avgNs,
+               static_cast<long long>(maxNs));
+        printf("ns per sample:      %.2f\n", avgNs / blockSize_);
+        printf("Deadline misses:    %zu\n", deadlineMisses);
+        printf("Real-time factor:   %.1fx\n", realTime);
+        printf("InitPedal time:     %lld ns\n", static_cast<long long>(initNs_));
+        if(!restarts_.empty())
+        {
+            printf("Audio restarts:     %zu, the timing is for the blocks after %.3f s\n",
+                   restarts_.size(),
+                   restarts_.back() / double(hardware_.AudioSampleRate()));
+        }
+        bool timingOk = true;
+        if(!switchScripted_.empty())
+        {
+            // Stalls of the main loop mustn't delay the footswitches.  A change lands one
+            // block after the scan that saw it, at the offset it happened at, so it can't
+            // be applied sooner than a block after it happened or later than that plus the
+            // scan period.  The timers run on whole microseconds, which can round by a sample.
+            const long scanSamples = long(sampleRate_ / 1000.0f + 0.5f);
+            long       minLatency = 0, maxLatency = 0;
+            size_t     outside = 0;
+            for(size_t i = 0; i < switchApplied_.size() && i < switchScripted_.size(); i++)
+            {
+                const long latency = long(switchApplied_[i]) - long(switchScripted_[i].sample);
+                const long block   = long(switchScripted_[i].blockSize);
+                minLatency         = i == 0 || latency < minLatency ? latency : minLatency;
+                maxLatency         = i == 0 || latency > maxLatency ? latency : maxLatency;
+                outside += latency < block - 1 || latency > block + scanSamples + 1 ? 1 : 0;
+            }
+            const bool pass = switchApplied_.size() == switchScripted_.size() && outside == 0;
+            printf("Footswitch changes: %zu of %zu applied, latency min %ld max %ld samples, %zu off the scan, %s\n",
+                   switchApplied_.size(),
+                   switchScripted_.size(),
+                   minLatency,
+                   maxLatency,
+                   outside,
+                   pass ? "pass" : "FAIL");
+            timingOk = timingOk && pass;
+        }
+        if(!midiScripted_.empty())
+        {
+            // Applied changes are matched up with the control changes in the script by
+            // value, in order, skipping the ones the pedal doesn't map.  The time the main
+            // loop read them goes through System::GetUs(), which can round by a sample.
+            long   minLatency = 0, maxLatency = 0;
+            size_t matched = 0, late = 0, next = 0;
+            for(const MidiChange& applied : midiApplied_)
+            {
+                while(next < midiScripted_.size() && midiScripted_[next].value != applied.value)
+                    next++;
+                if(next == midiScripted_.size())
+                    break;
+
+                const MidiChange& arrived = midiScripted_[next++];
+                const long latency = long(applied.sample) - long(arrived.sample);
+                minLatency = matched == 0 || latency < minLatency ? latency : minLatency;
+                maxLatency = matched == 0 || latency > maxLatency ? latency : maxLatency;
+                late += labs(long(applied.sample) - long(arrived.due)) > 1 ? 1 : 0;
+                matched++;
+            }
+            const bool pass = matched == midiApplied_.size() && late == 0;
+            printf("MIDI changes:       %zu of %zu applied, latency min %ld max %ld samples, %s\n",
+                   midiApplied_.size(),
+                   midiScripted_.size(),
+                   minLatency,
+                   maxLatency,
+                   pass ? "pass" : "FAIL");
+            timingOk = timingOk && pass;
+        }
+        if(loopbackDelay_ >= 0)
+        {
+            // Checks the latency probe against the simulated cable, every marker has to
+            // come back with exactly the cable's delay at the block size it ran at
+            uint32_t minLatency = 0, maxLatency = 0;
+            double   totalLatency = 0.0;
+            for(size_t i = 0; i < latencies_.size(); i++)
+            {
+                minLatency = i == 0 || latencies_[i] < minLatency ? latencies_[i] : minLatency;
+                maxLatency = i == 0 || latencies_[i] > maxLatency ? latencies_[i] : maxLatency;
+                totalLatency += latencies_[i];
+            }
+            const bool pass = wrongLatencies_ == 0;
+            printf("Loopback latency:   %zu markers, min %u avg %.1f max %u samples, cable %ld, "
+                   "%zu wrong, %s\n",
+                   latencies_.size(),
+                   minLatency,
+                   latencies_.empty() ? 0.0 : totalLatency / latencies_.size(),
+                   maxLatency,
+                   cableSamples_,
+                   wrongLatencies_,
+                   pass ? "pass" : "FAIL");
+            timingOk = timingOk && pass;
+        }
+        if(hardware_.seed.qspi.HostPowerCut())
+            printf("Flash power cut:    yes, later flash writes were lost\n");
+        return timingOk;
+    }
+
+    Pedal&               hardware_;
+    void                 (*initPedal_)();
+    void                 (*processMainLoop_)();
+    BoardEventHandler    boardEventHandler_ = nullptr;
+    std::vector<int64_t> blockTimesNs_;
+    std::vector<size_t>  restarts_;     /**< Frames the audio restarted at */
+    size_t               restartBlock_ = 0;
+    size_t               blockSize_  = 0;
+    int64_t              initNs_     = 0;
+    float                sampleRate_ = 0.0f;
+
+    /** A MIDI control change, as scripted or as the pedal applied it */
+    struct MidiChange
+    {
+        uint32_t sample;
+        float    value;
+        uint32_t due; /**< One block after the main loop read it, where it should land */
+    };
+
+    std::vector<MidiChange> midiScripted_;
+    size_t                  midiRead_ = 0; /**< Changes the main loop has read */
+    size_t                  stallEnd_ = 0; /**< The main loop doesn't run before this sample */
+    uint8_t                 midiStatus_ = 0; /**< Running status of the scripted MIDI */
+    struct SwitchChange
+    {
+        size_t sample;
+        size_t blockSize; /**< Block size the change was made at */
+    };
+
+    std::vector<SwitchChange> switchScripted_;
+    long                    loopbackDelay_ = -1; /**< Converter delay of the patch cable, -1 without */
+
+    static inline FILE*                   paramLog_           = nullptr;
+    static inline float                   paramLogSampleRate_ = 48000.0f;
+    static inline size_t                  timelineStart_ = 0; /**< Frame the pedal's sample clock started at */
+    static inline std::vector<MidiChange> midiApplied_;
+    static inline std::vector<uint32_t>   switchApplied_;
+    static inline std::vector<uint32_t>   latencies_;
+    static inline size_t                  wrongLatencies_ = 0;
+    static inline long                    cableSamples_   = 0; /**< Delay the probe should measure */
+};
+} // namespace bkshepherd
+#endif
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef WAV_FILE_H
+#define WAV_FILE_H /**< & */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace bkshepherd {
+
+/**
+   @brief Minimal RIFF/WAVE reader and writer for the host render tools.
+
+   Reads 16, 24 and 32 bit PCM or 32 bit float files with any number of channels
+   and writes 32 bit float files, so rendered output is not re-quantized.
+*/
+class WavFile
+{
+  public:
+    /** Loads a wav file into de-interleaved float channels.
+    \param path File to read
+    \return true on success
+    */
+    bool Read(const char* path)
+    {
+        FILE* file = fopen(path, "rb");
+        if(!file)
+            return false;
+
+        uint8_t riff[12];
+        if(fread(riff, 1, 12, file) != 12 || memcmp(riff, "RIFF", 4) != 0
+           || memcmp(riff + 8, "WAVE", 4) != 0)
+        {
+            fclose(file);
+            return false;
+        }
+
+        uint16_t format = 0, channels = 0, bits = 0;
+        bool     haveFormat = false;
+        uint8_t  chunkHeader[8];
+        while(fread(chunkHeader, 1, 8, file) == 8)
+        {
+            uint32_t chunkSize = ReadU32(chunkHeader + 4);
+            if(memcmp(chunkHeader, "fmt ", 4) == 0)
+            {
+                std::vector<uint8_t> fmt(chunkSize);
+                if(fread(fmt.data(), 1, chunkSize, file) != chunkSize || chunkSize < 16)
+                    break;
+                format      = ReadU16(&fmt[0]);
+                channels    = ReadU16(&fmt[2]);
+                sampleRate  = ReadU32(&fmt[4]);
+                bits        = ReadU16(&fmt[14]);
+                haveFormat  = true;
+
+                // WAVE_FORMAT_EXTENSIBLE stores the real format in the sub format guid.
+                if(format == 0xFFFE && chunkSize >= 26)
+                    format = ReadU16(&fmt[24]);
+            }
+            else if(memcmp(chunkHeader, "data", 4) == 0 && haveFormat)
+            {
+                std::vector<uint8_t> data(chunkSize);
+                size_t               bytesRead = fread(data.data(), 1, chunkSize, file);
+                fclose(file);
+                return Decode(data.data(), bytesRead, format, channels, bits);
+            }
+            else
+            {
+                fseek(file, chunkSize + (chunkSize & 1), SEEK_CUR);
+            }
+        }
+
+        fclose(file);
+        return false;
+    }
+
+    /** Saves the channels as a 32 bit float wav file.
+    \param path File to write
+    \return true on success
+    */
+    bool Write(const char* path) const
+    {
+        FILE* file = fopen(path, "wb");
+        if(!file)
+            return false;
+
+        const uint16_t numChannels = static_cast<uint16_t>(channelData.size());
+        const uint32_t dataSize    = static_cast<uint32_t>(NumFrames() * numChannels * 4);
+
+        uint8_t header[44];
+        memcpy(header, "RIFF", 4);
+        WriteU32(header + 4, 36 + dataSize);
+        memcpy(header + 8, "WAVEfmt ", 8);
+        WriteU32(header + 16, 16);
+        WriteU16(header + 20, 3);
+        WriteU16(header + 22, numChannels);
+        WriteU32(header + 24, sampleRate);
+        WriteU32(header + 28, sampleRate * numChannels * 4);
+        WriteU16(header + 32, numChannels * 4);
+        WriteU16(header + 34, 32);
+        memcpy(header + 36, "data", 4);
+        WriteU32(header + 40, dataSize);
+        fwrite(header, 1, sizeof(header), file);
+
+        std::vector<float> frame(numChannels);
+        for(size_t i = 0; i < NumFrames(); i++)
+        {
+            for(size_t ch = 0; ch < numChannels; ch++)
+            {
+                frame[ch] = channelData[ch][i];
+            }
+            fwrite(frame.data(), sizeof(float), numChannels, file);
+        }
+
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        return ok;
+    }
+
+    /** Returns the number of samples per channel */
+    size_t NumFrames() const { return channelData.empty() ? 0 : channelData[0].size(); }
+
+    uint32_t                        sampleRate = 48000;
+    std::vector<std::vector<float>> channelData;
+
+  private:
+    static uint16_t ReadU16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+    static uint32_t ReadU32(const uint8_t* p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16)
+               | (uint32_t(p[3]) << 24);
+    }
+    static void WriteU16(uint8_t* p, uint16_t v)
+    {
+        p[0] = uint8_t(v);
+        p[1] = uint8_t(v >> 8);
+    }
+    static void WriteU32(uint8_t* p, uint32_t v)
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            p[i] = uint8_t(v >> (8 * i));
+        }
+    }
+
+    bool Decode(const uint8_t* data, size_t size, uint16_t format, uint16_t channels, uint16_t bits)
+    {
+        const bool isPcm   = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+        const bool isFloat = format == 3 && bits == 32;
+        if(channels == 0 || (!isPcm && !isFloat))
+            return false;
+
+        const size_t bytesPerSample = bits / 8;
+        const size_t numFrames      = size / (bytesPerSample * channels);
+        channelData.assign(channels, std::vector<float>(numFrames));
+
+        for(size_t i = 0; i < numFrames; i++)
+        {
+            for(size_t ch = 0; ch < channels; ch++)
+            {
+                const uint8_t* p = data + (i * channels + ch) * bytesPerSample;
+                float          value;
+                if(isFloat)
+                {
+                    memcpy(&value, p, sizeof(float));
+                }
+                else if(bits == 16)
+                {
+                    value = int16_t(ReadU16(p)) / 32768.0f;
+                }
+                else if(bits == 24)
+                {
+                    int32_t v = int32_t((uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16)
+                                        | (uint32_t(p[2]) << 24));
+                    value = (v >> 8) / 8388608.0f;
+                }
+                else
+                {
+                    value = int32_t(ReadU32(p)) / 2147483648.0f;
+                }
+                channelData[ch][i] = value;
+            }
+        }
+
+        return true;
+    }
+};
+} // namespace bkshepherd
+#endif